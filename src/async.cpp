@@ -0,0 +1,50 @@
+#include "async.hpp"
+#include "offset.hpp"
+#include "parallel.hpp"
+#include "tile.hpp"
+
+namespace planar {
+
+	Executor::Executor(unsigned threads, size_t capacity)
+	: queue_(capacity)
+	{
+		auto count = ThreadCount(threads);
+		workers_.reserve(count);
+		for(unsigned i=0; i < count; ++i) {
+			workers_.emplace_back([this]() {
+				auto task = std::function<void()>{};
+				while(queue_.Pop(task)) {
+					task();
+				}
+			});
+		}
+	}
+
+	Executor::~Executor() {
+		queue_.Close();
+		for(auto &worker : workers_) {
+			worker.join();
+		}
+	}
+
+	Executor& DefaultExecutor() {
+		static Executor executor;
+		return executor;
+	}
+
+	Job<std::vector<Loop>> OffsetAsync(Executor &executor, const std::vector<Loop> &loops, float amt, unsigned threads, std::function<void(float)> on_progress) {
+		return executor.Submit([loops, amt, threads](JobControl &control) {
+			auto engine = OffsetEngine(loops, threads, &control);
+			if(control.cancelled()) {
+				return std::vector<Loop>{};
+			}
+			return engine.Offset(amt, threads, &control);
+		}, std::move(on_progress));
+	}
+
+	Job<std::vector<std::vector<Curve>>> SplitAtIntersectionsAsync(Executor &executor, const std::vector<Curve> &curves, float tol, float tile_size, unsigned threads, std::function<void(float)> on_progress) {
+		return executor.Submit([curves, tol, tile_size, threads](JobControl &control) {
+			return SplitAtIntersections(curves, tol, tile_size, threads, &control);
+		}, std::move(on_progress));
+	}
+}
@@ -0,0 +1,87 @@
+#ifndef async_hpp
+#define async_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "job.hpp"
+#include "queue.hpp"
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace planar {
+
+	// Handle on a submitted job: its result as a future plus the control to
+	// cancel it or read its progress. A job cancelled before it starts
+	// never runs; one cancelled while running stops at its next check.
+	// Either way the future holds an empty result.
+	template<typename T>
+	class Job{
+	public:
+		Job(std::future<T> future, std::shared_ptr<JobControl> control)
+		: future_(std::move(future))
+		, control_(std::move(control))
+		{}
+
+		void Cancel() { control_->Cancel(); }
+		bool cancelled() const { return control_->cancelled(); }
+		float progress() const { return control_->progress(); }
+
+		bool ready() const { return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+		void wait() const { future_.wait(); }
+		template<typename Rep, typename Period>
+		bool wait_for(const std::chrono::duration<Rep, Period> &timeout) const {
+			return future_.wait_for(timeout) == std::future_status::ready;
+		}
+		// Blocks until done; valid once
+		T get() { return future_.get(); }
+
+	private:
+		std::future<T> future_;
+		std::shared_ptr<JobControl> control_;
+	};
+
+	// Fixed pool of threads running submitted jobs in order. Submit blocks
+	// while capacity jobs are waiting. The destructor runs what's queued
+	// (cancel jobs first to skip them) and joins the threads.
+	class Executor{
+	public:
+		Executor(unsigned threads = 0, size_t capacity = 1024);
+		~Executor();
+
+		// f(JobControl&) does the work, checking the control as it goes.
+		// on_progress, if given, is called from the worker as it advances.
+		template<typename F>
+		auto Submit(F f, std::function<void(float)> on_progress = nullptr) -> Job<decltype(f(std::declval<JobControl&>()))> {
+			typedef decltype(f(std::declval<JobControl&>())) Result;
+			auto control = std::make_shared<JobControl>(std::move(on_progress));
+			auto task = std::make_shared<std::packaged_task<Result()>>([f, control]() mutable {
+				return control->cancelled() ? Result() : f(*control);
+			});
+			auto job = Job<Result>(task->get_future(), control);
+			queue_.Push([task]() { (*task)(); });
+			return job;
+		}
+
+		size_t size() const { return workers_.size(); }
+
+	private:
+		BoundedQueue<std::function<void()>> queue_;
+		std::vector<std::thread> workers_;
+	};
+
+	// Shared executor with one thread per core, started on first use
+	Executor& DefaultExecutor();
+
+	// Trimmed offsets (OffsetEngine::Offset) and tiled splitting as
+	// jobs. Inputs are copied into the job. threads is per job, so the
+	// default of 1 lets the executor run one job per core.
+	Job<std::vector<Loop>> OffsetAsync(Executor &executor, const std::vector<Loop> &loops, float amt, unsigned threads = 1, std::function<void(float)> on_progress = nullptr);
+	Job<std::vector<std::vector<Curve>>> SplitAtIntersectionsAsync(Executor &executor, const std::vector<Curve> &curves, float tol, float tile_size = 0.f, unsigned threads = 1, std::function<void(float)> on_progress = nullptr);
+}
+
+#endif
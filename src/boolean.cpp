@@ -0,0 +1,454 @@
+#include "boolean.hpp"
+#include "containment.hpp"
+#include "weld.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace planar {
+
+	// Distance, relative to the shorter curve's length, within which two
+	// curves are taken to overlap
+	const float kOverlapTolerance = 1e-3f;
+
+	struct BooleanEdge{
+		Curve curve;
+		Box2d bounds;
+		uint8_t set;
+	};
+
+	// Point halfway along a curve with the unit normal to the left of its
+	// direction of travel
+	struct CurveProbe{
+		Point2d pt;
+		Vec2d normal;
+		float length;
+	};
+
+	CurveProbe MidpointProbe(const Curve &curve) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				auto dir = segment.pts[1] - segment.pts[0];
+				auto length = dir.norm();
+				return CurveProbe{(segment.pts[0] + segment.pts[1]) * 0.5f, Vec2d(-dir[1], dir[0]) / length, length};
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				auto r = std::abs(circle.radius);
+				auto normal = std::signbit(circle.radius) ? Vec2d(1.f, 0.f) : Vec2d(-1.f, 0.f);
+				return CurveProbe{circle.center + Point2d(r, 0.f), normal, 2.f * float(M_PI) * r};
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				auto sweep = std::abs(SweepAngle(arc));
+				auto pt = ArcPointAtAngle(arc, sweep * 0.5f);
+				// Left of travel points to the center for CCW arcs
+				auto normal = (arc.circle.center - pt) / arc.circle.radius;
+				return CurveProbe{pt, normal, sweep * std::abs(arc.circle.radius)};
+			}
+		}
+		return CurveProbe{Point2d(0.f, 0.f), Vec2d(0.f, 0.f), 0.f};
+	}
+
+	bool OnCurve(const Curve &curve, const Point2d &pt, float tol) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				auto dir = segment.pts[1] - segment.pts[0];
+				auto len2 = (dir <= dir)[0];
+				auto to_pt = pt - segment.pts[0];
+				auto t = (to_pt <= dir)[0] / len2;
+				return t > 0.f && t < 1.f && std::abs((dir ^ to_pt)[0]) <= tol * std::sqrt(len2);
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				return std::abs((pt - circle.center).norm() - std::abs(circle.radius)) <= tol;
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				return std::abs((pt - arc.circle.center).norm() - std::abs(arc.circle.radius)) <= tol &&
+					ArcAngleTo(arc, pt) <= std::abs(SweepAngle(arc));
+			}
+		}
+		return false;
+	}
+
+	// Whether two curves run along each other within tol: collinear
+	// segments, or arcs and circles on the same circle
+	bool Overlapping(const Curve &a, const Curve &b, float tol) {
+		auto type_a = TargetType(a);
+		auto type_b = TargetType(b);
+		if(type_a == Curve::CurveType::LineSegment || type_b == Curve::CurveType::LineSegment) {
+			if(type_a != type_b) {
+				return false;
+			}
+			const auto &segment = *(LineSegment*)Target(a);
+			const auto &other = *(LineSegment*)Target(b);
+			auto dir = segment.pts[1] - segment.pts[0];
+			auto len = dir.norm();
+			for(const auto &pt : other.pts) {
+				if(std::abs((dir ^ (pt - segment.pts[0]))[0]) > tol * len) {
+					return false;
+				}
+			}
+			return true;
+		}
+		const auto &circle = type_a == Curve::CurveType::Circle ? *(Circle*)Target(a) : ((Arc*)Target(a))->circle;
+		const auto &other = type_b == Curve::CurveType::Circle ? *(Circle*)Target(b) : ((Arc*)Target(b))->circle;
+		return (circle.center - other.center).norm() <= tol &&
+			std::abs(std::abs(circle.radius) - std::abs(other.radius)) <= tol;
+	}
+
+	// Sort-and-sweep over x extents, intersecting every pair of curves whose
+	// bounds overlap. Overlapping collinear or co-circular curves have no
+	// isolated intersection points, so their endpoints lying on each other
+	// are used as split points as well. Whether they overlap is judged
+	// relative to the shorter curve, not the scene: a vertex of a fine
+	// polygon lies within the scene's tolerance of its neighbours' edges
+	// without being on them.
+	std::vector<std::vector<Point2d>> SplitPoints(const std::vector<Curve> &curves, const std::vector<Box2d> &bounds, float tol) {
+		auto order = std::vector<uint32_t>(curves.size());
+		for(uint32_t i=0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+			return bounds[i].min[0] < bounds[j].min[0];
+		});
+
+		auto split_pts = std::vector<std::vector<Point2d>>(curves.size());
+		auto active = std::vector<uint32_t>{};
+		for(auto i : order) {
+			const auto &box = bounds[i];
+			for(size_t k=0; k < active.size();) {
+				auto j = active[k];
+				const auto &other_box = bounds[j];
+				if(other_box.max[0] + tol < box.min[0]) {
+					active[k] = active.back();
+					active.pop_back();
+					continue;
+				}
+				++k;
+				if(other_box.max[1] + tol < box.min[1] || box.max[1] + tol < other_box.min[1]) {
+					continue;
+				}
+
+				const auto &curve = curves[i];
+				const auto &other = curves[j];
+				for(const auto &pt : Intersect(curve, other)) {
+					split_pts[i].push_back(pt);
+					split_pts[j].push_back(pt);
+				}
+				auto along = std::min(tol, kOverlapTolerance * std::min(Length(curve), Length(other)));
+				if(!Overlapping(curve, other, along)) {
+					continue;
+				}
+				for(const auto &pt : Endpoints(other)) {
+					if(OnCurve(curve, pt, along)) {
+						split_pts[i].push_back(pt);
+					}
+				}
+				for(const auto &pt : Endpoints(curve)) {
+					if(OnCurve(other, pt, along)) {
+						split_pts[j].push_back(pt);
+					}
+				}
+			}
+			active.push_back(i);
+		}
+		return split_pts;
+	}
+
+	std::vector<std::vector<Curve>> SplitAtIntersections(const std::vector<Curve> &curves, float tol) {
+		auto bounds = std::vector<Box2d>{};
+		bounds.reserve(curves.size());
+		for(const auto &curve : curves) {
+			bounds.push_back(Bounds(curve));
+		}
+		auto split_pts = SplitPoints(curves, bounds, tol);
+		auto fragments = std::vector<std::vector<Curve>>{};
+		fragments.reserve(curves.size());
+		for(size_t i=0; i < curves.size(); ++i) {
+			fragments.push_back(Split(curves[i], split_pts[i]));
+		}
+		return fragments;
+	}
+
+	struct WindingQuery{
+		Point2d pt;
+		int winding[2];
+	};
+
+	// Sweep in y over the monotone pieces of all edges, accumulating the
+	// winding number of each set at every query point from the pieces
+	// crossing its scanline to the right.
+	void ClassifyQueries(const std::vector<BooleanEdge> &edges, std::vector<WindingQuery> &queries) {
+		struct SetPiece{
+			MonotonePiece piece;
+			float min_y;
+			float max_y;
+			uint8_t set;
+		};
+		auto pieces = std::vector<SetPiece>{};
+		pieces.reserve(edges.size());
+		for(const auto &edge : edges) {
+			for(const auto &piece : MonotonePieces(edge.curve)) {
+				auto y0 = piece.endpoints.pts[0][1];
+				auto y1 = piece.endpoints.pts[1][1];
+				if(y0 != y1) {
+					pieces.push_back(SetPiece{piece, std::min(y0, y1), std::max(y0, y1), edge.set});
+				}
+			}
+		}
+		std::sort(pieces.begin(), pieces.end(), [](const SetPiece &a, const SetPiece &b) {
+			return a.min_y < b.min_y;
+		});
+
+		auto order = std::vector<uint32_t>(queries.size());
+		for(uint32_t i=0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+			return queries[i].pt[1] < queries[j].pt[1];
+		});
+
+		auto active = std::vector<uint32_t>{};
+		size_t next_piece = 0;
+		for(auto i : order) {
+			auto &query = queries[i];
+			auto y = query.pt[1];
+			while(next_piece < pieces.size() && pieces[next_piece].min_y <= y) {
+				active.push_back(uint32_t(next_piece++));
+			}
+			query.winding[0] = 0;
+			query.winding[1] = 0;
+			for(size_t k=0; k < active.size();) {
+				const auto &piece = pieces[active[k]];
+				if(piece.max_y <= y) {
+					active[k] = active.back();
+					active.pop_back();
+					continue;
+				}
+				++k;
+				if(CrossingX(piece.piece, y) > query.pt[0]) {
+					query.winding[piece.set] += CrossingDirection(piece.piece);
+				}
+			}
+		}
+	}
+
+	bool InResult(BooleanOp op, bool in_a, bool in_b) {
+		switch(op) {
+			case BooleanOp::Union: return in_a || in_b;
+			case BooleanOp::Intersection: return in_a && in_b;
+			case BooleanOp::Difference: return in_a && !in_b;
+		}
+		return false;
+	}
+
+	// Boundaries shared by several loops produce coincident fragments that
+	// classify identically. Keep one copy of each.
+	std::vector<Curve> RemoveDuplicates(const std::vector<Curve> &fragments, float tol) {
+		struct Key{
+			Point2d start;
+			Point2d end;
+			Point2d mid;
+		};
+		auto keys = std::vector<Key>{};
+		keys.reserve(fragments.size());
+		for(const auto &fragment : fragments) {
+			auto endpoints = Endpoints(fragment);
+			auto mid = MidpointProbe(fragment).pt;
+			keys.push_back(endpoints.empty() ? Key{mid, mid, mid} : Key{endpoints[0], endpoints[1], mid});
+		}
+		auto order = std::vector<uint32_t>(fragments.size());
+		for(uint32_t i=0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+			return keys[i].start[0] < keys[j].start[0];
+		});
+
+		auto near = [tol](const Point2d &a, const Point2d &b) {
+			return std::abs(a[0] - b[0]) <= tol && std::abs(a[1] - b[1]) <= tol;
+		};
+		auto duplicate = std::vector<bool>(fragments.size(), false);
+		for(size_t i=0; i < order.size(); ++i) {
+			if(duplicate[order[i]]) {
+				continue;
+			}
+			const auto &key = keys[order[i]];
+			for(size_t j=i + 1; j < order.size() && keys[order[j]].start[0] <= key.start[0] + tol; ++j) {
+				const auto &other = keys[order[j]];
+				if(near(key.start, other.start) && near(key.end, other.end) && near(key.mid, other.mid)) {
+					duplicate[order[j]] = true;
+				}
+			}
+		}
+
+		auto unique = std::vector<Curve>{};
+		unique.reserve(fragments.size());
+		for(size_t i=0; i < fragments.size(); ++i) {
+			if(!duplicate[i]) {
+				unique.push_back(fragments[i]);
+			}
+		}
+		return unique;
+	}
+
+	std::vector<Loop> StitchLoops(const std::vector<Curve> &fragments, float tol) {
+		// Weld end points so chaining is a lookup by vertex id
+		auto loops = std::vector<Loop>{};
+		auto welder = VertexWelder(tol);
+		auto start_ids = std::vector<uint32_t>(fragments.size());
+		auto end_ids = std::vector<uint32_t>(fragments.size());
+		auto chained = std::vector<uint32_t>{};
+		chained.reserve(fragments.size());
+		for(uint32_t i=0; i < fragments.size(); ++i) {
+			if(TargetType(fragments[i]) == Curve::CurveType::Circle) {
+				loops.push_back(Loop(std::vector<Curve>{fragments[i]}));
+				continue;
+			}
+			auto endpoints = Endpoints(fragments[i]);
+			start_ids[i] = welder.Weld(endpoints[0]);
+			end_ids[i] = welder.Weld(endpoints[1]);
+			// Curves within tol of a single vertex would only close on
+			// their own
+			if(start_ids[i] == end_ids[i]) {
+				auto bounds = Bounds(fragments[i]);
+				if(bounds.max[0] - bounds.min[0] <= 2.f * tol && bounds.max[1] - bounds.min[1] <= 2.f * tol) {
+					continue;
+				}
+			}
+			chained.push_back(i);
+		}
+
+		// Fragments leaving each vertex, in input order
+		auto outgoing_offsets = std::vector<uint32_t>(welder.size() + 1, 0);
+		for(auto i : chained) {
+			++outgoing_offsets[start_ids[i] + 1];
+		}
+		for(size_t v=0; v < welder.size(); ++v) {
+			outgoing_offsets[v + 1] += outgoing_offsets[v];
+		}
+		auto outgoing = std::vector<uint32_t>(chained.size());
+		auto cursor = std::vector<uint32_t>(outgoing_offsets.begin(), outgoing_offsets.end() - 1);
+		for(auto i : chained) {
+			outgoing[cursor[start_ids[i]]++] = i;
+		}
+		// Reuse cursor as the first fragment at each vertex not yet chained
+		std::copy(outgoing_offsets.begin(), outgoing_offsets.end() - 1, cursor.begin());
+
+		auto used = std::vector<bool>(fragments.size(), false);
+		auto take_next = [&](uint32_t v) -> int64_t {
+			for(; cursor[v] < outgoing_offsets[v + 1]; ++cursor[v]) {
+				auto i = outgoing[cursor[v]];
+				if(!used[i]) {
+					return i;
+				}
+			}
+			return -1;
+		};
+
+		for(auto first : chained) {
+			if(used[first]) {
+				continue;
+			}
+			used[first] = true;
+			auto chain = std::vector<Curve>{fragments[first]};
+			auto end = end_ids[first];
+			while(end != start_ids[first]) {
+				auto next = take_next(end);
+				if(next < 0) {
+					break;
+				}
+				used[next] = true;
+				chain.push_back(fragments[next]);
+				end = end_ids[next];
+			}
+			// Chains that never return to their start aren't loops
+			if(end == start_ids[first]) {
+				loops.push_back(Loop(std::move(chain)));
+			}
+		}
+		return loops;
+	}
+
+	std::vector<Loop> Boolean(const std::vector<Loop> &a, const std::vector<Loop> &b, BooleanOp op) {
+		auto edges = std::vector<BooleanEdge>{};
+		auto scale = 1.f;
+		const std::vector<Loop>* sets[2] = {&a, &b};
+		for(uint8_t set=0; set < 2; ++set) {
+			for(const auto &loop : *sets[set]) {
+				for(const auto &curve : loop.curves()) {
+					auto bounds = Bounds(curve);
+					scale = std::max(scale, std::max(
+						std::max(std::abs(bounds.min[0]), std::abs(bounds.min[1])),
+						std::max(std::abs(bounds.max[0]), std::abs(bounds.max[1]))
+					));
+					edges.push_back(BooleanEdge{curve, bounds, set});
+				}
+			}
+		}
+		auto tol = 1e-5f * scale;
+
+		// Split every edge at its intersections with every other edge
+		auto curves = std::vector<Curve>{};
+		curves.reserve(edges.size());
+		for(const auto &edge : edges) {
+			curves.push_back(edge.curve);
+		}
+		auto split_curves = SplitAtIntersections(curves, tol);
+		auto fragments = std::vector<BooleanEdge>{};
+		fragments.reserve(edges.size());
+		for(size_t i=0; i < edges.size(); ++i) {
+			for(const auto &fragment : split_curves[i]) {
+				fragments.push_back(BooleanEdge{fragment, edges[i].bounds, edges[i].set});
+			}
+		}
+
+		// Probe both sides of every fragment
+		auto queries = std::vector<WindingQuery>{};
+		queries.reserve(fragments.size() * 2);
+		for(const auto &fragment : fragments) {
+			auto probe = MidpointProbe(fragment.curve);
+			auto eps = std::min(1e-4f * scale, 0.25f * probe.length);
+			queries.push_back(WindingQuery{probe.pt + probe.normal * eps, {0, 0}});
+			queries.push_back(WindingQuery{probe.pt - probe.normal * eps, {0, 0}});
+		}
+		ClassifyQueries(edges, queries);
+
+		// Keep fragments that separate result from non-result, oriented so
+		// the result is on their left
+		auto kept = std::vector<Curve>{};
+		for(size_t i=0; i < fragments.size(); ++i) {
+			const auto &left = queries[2 * i];
+			const auto &right = queries[2 * i + 1];
+			auto in_left = InResult(op, left.winding[0] != 0, left.winding[1] != 0);
+			auto in_right = InResult(op, right.winding[0] != 0, right.winding[1] != 0);
+			if(in_left == in_right) {
+				continue;
+			}
+			kept.push_back(in_left ? fragments[i].curve : Reverse(fragments[i].curve));
+		}
+
+		return StitchLoops(RemoveDuplicates(kept, tol), tol);
+	}
+
+	std::vector<Loop> Union(const std::vector<Loop> &a, const std::vector<Loop> &b) {
+		return Boolean(a, b, BooleanOp::Union);
+	}
+
+	std::vector<Loop> Intersection(const std::vector<Loop> &a, const std::vector<Loop> &b) {
+		return Boolean(a, b, BooleanOp::Intersection);
+	}
+
+	std::vector<Loop> Difference(const std::vector<Loop> &a, const std::vector<Loop> &b) {
+		return Boolean(a, b, BooleanOp::Difference);
+	}
+
+	std::vector<Loop> Union(const std::vector<Loop> &loops) {
+		return Boolean(loops, std::vector<Loop>{}, BooleanOp::Union);
+	}
+}
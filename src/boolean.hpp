@@ -0,0 +1,47 @@
+#ifndef boolean_hpp
+#define boolean_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <vector>
+
+namespace planar {
+
+	enum class BooleanOp{
+		Union = 0,
+		Intersection,
+		Difference
+	};
+
+	// Boolean combination of two regions. Each region is a set of loops
+	// under the non-zero winding rule, i.e. CCW loops bound filled area and
+	// CW loops bound holes. Curves are split exactly at their intersections
+	// so arcs and circles stay arcs. Result loops follow the same
+	// orientation convention.
+	std::vector<Loop> Boolean(const std::vector<Loop> &a, const std::vector<Loop> &b, BooleanOp op);
+
+	std::vector<Loop> Union(const std::vector<Loop> &a, const std::vector<Loop> &b);
+	std::vector<Loop> Intersection(const std::vector<Loop> &a, const std::vector<Loop> &b);
+	std::vector<Loop> Difference(const std::vector<Loop> &a, const std::vector<Loop> &b);
+
+	// Merge overlapping loops of a single set into the boundary of their union
+	std::vector<Loop> Union(const std::vector<Loop> &loops);
+
+	// Points where each curve meets the others, with bounds[i] the bounds of
+	// curves[i]. These are what SplitAtIntersections cuts at.
+	std::vector<std::vector<Point2d>> SplitPoints(const std::vector<Curve> &curves, const std::vector<Box2d> &bounds, float tol);
+
+	// Split each curve at its intersections with all the others, found by a
+	// sort-and-sweep over x extents. Returns the pieces of each input curve
+	// in order along it.
+	std::vector<std::vector<Curve>> SplitAtIntersections(const std::vector<Curve> &curves, float tol);
+
+	// Chain oriented curves into closed loops by matching each end point to
+	// the start point of an unused curve within tol. End points are welded
+	// (see weld.hpp), so this is linear in the number of curves. Chains
+	// that don't close, and curves within tol of a single point, are
+	// dropped.
+	std::vector<Loop> StitchLoops(const std::vector<Curve> &curves, float tol);
+}
+
+#endif
@@ -0,0 +1,182 @@
+#include "cache.hpp"
+#include <cstring>
+#include <utility>
+
+namespace planar {
+
+	// Finalizer of MurmurHash3, applied after folding in each value
+	uint64_t Mix(uint64_t h) {
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	uint64_t FloatBits(float v) {
+		if(v == 0.f) {
+			return 0;
+		}
+		uint32_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		return bits;
+	}
+
+	uint64_t Combine(uint64_t h, uint64_t v) {
+		return Mix(h ^ (v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)));
+	}
+
+	uint64_t Combine(uint64_t h, const Point2d &pt) {
+		return Combine(Combine(h, FloatBits(pt[0])), FloatBits(pt[1]));
+	}
+
+	uint64_t ContentHash(const Loop &loop) {
+		auto h = Combine(0, uint64_t(loop.curves().size()));
+		for(const auto &curve : loop.curves()) {
+			auto type = TargetType(curve);
+			h = Combine(h, uint64_t(type));
+			switch(type) {
+				case Curve::CurveType::LineSegment: {
+					const auto &segment = *(LineSegment*)Target(curve);
+					h = Combine(Combine(h, segment.pts[0]), segment.pts[1]);
+					break;
+				}
+				case Curve::CurveType::Circle: {
+					const auto &circle = *(Circle*)Target(curve);
+					h = Combine(Combine(h, circle.center), FloatBits(circle.radius));
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					const auto &arc = *(Arc*)Target(curve);
+					h = Combine(Combine(h, arc.circle.center), FloatBits(arc.circle.radius));
+					h = Combine(Combine(h, arc.endpoints.pts[0]), arc.endpoints.pts[1]);
+					break;
+				}
+			}
+		}
+		return h;
+	}
+
+	uint64_t ContentHash(const std::vector<Loop> &loops) {
+		auto h = Combine(1, uint64_t(loops.size()));
+		for(const auto &loop : loops) {
+			h = Combine(h, ContentHash(loop));
+		}
+		return h;
+	}
+
+	size_t MemoryFootprint(const std::vector<Loop> &loops) {
+		// Each curve's model is a separate allocation holding a vtable
+		// pointer and the primitive, plus allocator overhead
+		const size_t kModelBytes = sizeof(void*) + sizeof(Arc) + 16;
+		auto bytes = sizeof(loops) + loops.capacity() * sizeof(Loop);
+		for(const auto &loop : loops) {
+			bytes += loop.curves().capacity() * sizeof(Curve) + loop.curves().size() * kModelBytes;
+		}
+		return bytes;
+	}
+
+	size_t LoopCache::KeyHash::operator()(const CacheKey &key) const {
+		return size_t(Combine(Combine(key.hash, FloatBits(key.amt)), key.op));
+	}
+
+	bool LoopCache::KeyEqual::operator()(const CacheKey &a, const CacheKey &b) const {
+		return a.hash == b.hash && FloatBits(a.amt) == FloatBits(b.amt) && a.op == b.op;
+	}
+
+	LoopCache::LoopCache(size_t max_bytes)
+	: max_bytes_(max_bytes)
+	{}
+
+	LoopCache::Value LoopCache::Find(const CacheKey &key) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = index_.find(key);
+		if(it == index_.end()) {
+			++misses_;
+			return Value{};
+		}
+		++hits_;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->value;
+	}
+
+	void LoopCache::Insert(const CacheKey &key, Value value) {
+		if(!value) {
+			return;
+		}
+		auto bytes = MemoryFootprint(*value);
+		std::lock_guard<std::mutex> lock(mutex_);
+		if(bytes > max_bytes_) {
+			return;
+		}
+		auto it = index_.find(key);
+		if(it != index_.end()) {
+			bytes_ -= it->second->bytes;
+			entries_.erase(it->second);
+			index_.erase(it);
+		}
+		EvictTo(max_bytes_ - bytes);
+		entries_.push_front(Entry{key, std::move(value), bytes});
+		index_.emplace(key, entries_.begin());
+		bytes_ += bytes;
+	}
+
+	void LoopCache::EvictTo(size_t max_bytes) {
+		while(bytes_ > max_bytes && !entries_.empty()) {
+			const auto &last = entries_.back();
+			bytes_ -= last.bytes;
+			index_.erase(last.key);
+			entries_.pop_back();
+			++evictions_;
+		}
+	}
+
+	void LoopCache::clear() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		entries_.clear();
+		index_.clear();
+		bytes_ = 0;
+	}
+
+	uint64_t LoopCache::hits() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return hits_;
+	}
+
+	uint64_t LoopCache::misses() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return misses_;
+	}
+
+	uint64_t LoopCache::evictions() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return evictions_;
+	}
+
+	size_t LoopCache::bytes() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return bytes_;
+	}
+
+	size_t LoopCache::size() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return entries_.size();
+	}
+
+	Loop Offset(LoopCache &cache, const Loop &loop, float amt) {
+		auto key = CacheKey{ContentHash(loop), amt, kCacheLoopOffset};
+		auto value = cache.FindOrCompute(key, [&]() {
+			return std::vector<Loop>{loop.Offset(amt)};
+		});
+		return value->front();
+	}
+
+	std::vector<Loop> Boolean(LoopCache &cache, const std::vector<Loop> &a, const std::vector<Loop> &b, BooleanOp op) {
+		auto key = CacheKey{Combine(ContentHash(a), ContentHash(b)), 0.f, kCacheBoolean + uint32_t(op)};
+		auto value = cache.FindOrCompute(key, [&]() {
+			return planar::Boolean(a, b, op);
+		});
+		return *value;
+	}
+}
@@ -0,0 +1,107 @@
+#ifndef cache_hpp
+#define cache_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "boolean.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace planar {
+
+	// Hash of a loop's curve kinds and coordinates, stable across runs and
+	// hosts. -0 and 0 hash alike; any other change to a value changes it.
+	uint64_t ContentHash(const Loop &loop);
+	uint64_t ContentHash(const std::vector<Loop> &loops);
+
+	// Approximate heap and inline bytes held by loops
+	size_t MemoryFootprint(const std::vector<Loop> &loops);
+
+	// What a cached result was computed from: the content hash of the
+	// input, a distance (0 where there is none) and which operation
+	struct CacheKey{
+		uint64_t hash;
+		float amt;
+		uint32_t op;
+	};
+
+	// Operation tags used by the helpers below; callers caching their own
+	// results can use anything from kCacheUserOp up
+	enum CacheOp : uint32_t{
+		kCacheLoopOffset = 0,
+		kCacheBoolean = 1,
+		kCacheUserOp = 256
+	};
+
+	// Thread-safe LRU cache of loop results, bounded by approximate memory
+	// use. Entries are told apart only by their 64-bit key hash. Values are
+	// shared immutably, so lookups copy out of the cache without holding
+	// the lock.
+	class LoopCache{
+	public:
+		typedef std::shared_ptr<const std::vector<Loop>> Value;
+
+		LoopCache(size_t max_bytes);
+
+		// The cached value, or null on a miss
+		Value Find(const CacheKey &key);
+		// Values larger than the whole cache aren't kept
+		void Insert(const CacheKey &key, Value value);
+
+		// Cached value, computing and inserting it on a miss. Concurrent
+		// misses on one key may each compute it.
+		template<typename F>
+		Value FindOrCompute(const CacheKey &key, F compute) {
+			auto value = Find(key);
+			if(!value) {
+				value = std::make_shared<const std::vector<Loop>>(compute());
+				Insert(key, value);
+			}
+			return value;
+		}
+
+		void clear();
+
+		uint64_t hits() const;
+		uint64_t misses() const;
+		uint64_t evictions() const;
+		size_t bytes() const;
+		size_t size() const;
+		size_t max_bytes() const { return max_bytes_; }
+
+	private:
+		struct Entry{
+			CacheKey key;
+			Value value;
+			size_t bytes;
+		};
+		struct KeyHash{
+			size_t operator()(const CacheKey &key) const;
+		};
+		struct KeyEqual{
+			bool operator()(const CacheKey &a, const CacheKey &b) const;
+		};
+
+		void EvictTo(size_t max_bytes);
+
+		size_t max_bytes_;
+		size_t bytes_ = 0;
+		uint64_t hits_ = 0;
+		uint64_t misses_ = 0;
+		uint64_t evictions_ = 0;
+		// Most recently used first
+		std::list<Entry> entries_;
+		std::unordered_map<CacheKey, std::list<Entry>::iterator, KeyHash, KeyEqual> index_;
+		mutable std::mutex mutex_;
+	};
+
+	// Loop::Offset and Boolean through a cache
+	Loop Offset(LoopCache &cache, const Loop &loop, float amt);
+	std::vector<Loop> Boolean(LoopCache &cache, const std::vector<Loop> &a, const std::vector<Loop> &b, BooleanOp op);
+}
+
+#endif
@@ -0,0 +1,892 @@
+#include "clearance.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace planar {
+
+	// Fragments are halved at most kMaxSplits times over
+	const int kMaxSplits = 12;
+	// Nearest point queries shrinking one ball
+	const int kShrinkSteps = 32;
+	// Fraction of a ball's radius its obstacles may be inside it by
+	const double kShrinkSlack = 1e-3;
+	const uint32_t kNoSite = ~uint32_t(0);
+	// Sites whose fragments are built between cancellation checks
+	const size_t kBuildBlock = 64;
+
+	// Offsets are intersected in double so the two offsets meeting at a
+	// trim agree on where they meet
+	struct DoubleVec{
+		double x;
+		double y;
+	};
+
+	inline DoubleVec ToDouble(const Point2d &pt) {
+		return DoubleVec{pt[0], pt[1]};
+	}
+
+	inline Point2d ToPoint2d(const DoubleVec &v) {
+		return Point2d(float(v.x), float(v.y));
+	}
+
+	inline DoubleVec operator+(const DoubleVec &a, const DoubleVec &b) {
+		return DoubleVec{a.x + b.x, a.y + b.y};
+	}
+
+	inline DoubleVec operator-(const DoubleVec &a, const DoubleVec &b) {
+		return DoubleVec{a.x - b.x, a.y - b.y};
+	}
+
+	inline DoubleVec operator*(const DoubleVec &a, double s) {
+		return DoubleVec{a.x * s, a.y * s};
+	}
+
+	inline double Dot(const DoubleVec &a, const DoubleVec &b) {
+		return a.x * b.x + a.y * b.y;
+	}
+
+	inline double Cross(const DoubleVec &a, const DoubleVec &b) {
+		return a.x * b.y - a.y * b.x;
+	}
+
+	inline double Norm(const DoubleVec &a) {
+		return std::sqrt(Dot(a, a));
+	}
+
+	// Segments are offset from their ends in double: differences and
+	// normals rounded to float would move offset ends off their corners
+	inline DoubleVec SegmentAxis(const ClearanceSite &site) {
+		return ToDouble(site.end) - ToDouble(site.origin);
+	}
+
+	inline DoubleVec SegmentNormal(const ClearanceSite &site) {
+		auto axis = SegmentAxis(site);
+		auto normal = DoubleVec{axis.y, -axis.x} * (1. / Norm(axis));
+		return Dot(normal, ToDouble(site.normal)) < 0. ? normal * -1. : normal;
+	}
+
+	inline double SiteRadius(const ClearanceSite &site, double d) {
+		return double(site.radius) + site.grows * d;
+	}
+
+	// Direction from a circular site's center at parameter t
+	inline DoubleVec SiteDirection(const ClearanceSite &site, double t) {
+		auto c = std::cos(site.turn * t);
+		auto s = std::sin(site.turn * t);
+		// Corner axes are float normals, normalized again like segment
+		// normals; arcs keep theirs scaled so their offsets stay on their
+		// ends
+		auto axis = ToDouble(site.axis);
+		if(site.curve == kCornerSite) {
+			axis = axis * (1. / Norm(axis));
+		}
+		return DoubleVec{axis.x * c - axis.y * s, axis.x * s + axis.y * c};
+	}
+
+	// Point at parameter t on the offset of site at distance d
+	DoubleVec SitePoint(const ClearanceSite &site, double d, double t) {
+		if(site.turn == 0) {
+			return ToDouble(site.origin) + SegmentAxis(site) * t + SegmentNormal(site) * d;
+		}
+		return ToDouble(site.origin) + SiteDirection(site, t) * SiteRadius(site, d);
+	}
+
+	// Parameter of the direction from a circular site's center to pt, in
+	// [0, 2pi)
+	double SiteAngle(const ClearanceSite &site, const DoubleVec &pt) {
+		auto axis = ToDouble(site.axis);
+		auto dir = pt - ToDouble(site.origin);
+		auto angle = std::atan2(Cross(axis, dir), Dot(axis, dir)) * site.turn;
+		return angle < 0. ? angle + 2. * M_PI : angle;
+	}
+
+	// Length of the offset at distance d over [begin, end]
+	double SiteLength(const ClearanceSite &site, double d, double begin, double end) {
+		if(site.turn == 0) {
+			return Norm(SegmentAxis(site)) * (end - begin);
+		}
+		return std::max(SiteRadius(site, d), 0.) * (end - begin);
+	}
+
+	inline bool InSpan(const ClearanceSite &site, double t, double begin, double end) {
+		return site.closed ? true : t >= begin && t <= end;
+	}
+
+	Box2d SiteBounds(const ClearanceSite &site, double d, double begin, double end) {
+		auto p0 = SitePoint(site, d, begin);
+		auto p1 = SitePoint(site, d, end);
+		auto min = DoubleVec{std::min(p0.x, p1.x), std::min(p0.y, p1.y)};
+		auto max = DoubleVec{std::max(p0.x, p1.x), std::max(p0.y, p1.y)};
+		if(site.turn != 0) {
+			// Extremes along the axes the offset sweeps past
+			auto radius = std::max(SiteRadius(site, d), 0.);
+			auto center = ToDouble(site.origin);
+			const DoubleVec dirs[4] = {{1., 0.}, {0., 1.}, {-1., 0.}, {0., -1.}};
+			for(const auto &dir : dirs) {
+				if(InSpan(site, SiteAngle(site, center + dir), begin, end)) {
+					auto pt = center + dir * radius;
+					min = DoubleVec{std::min(min.x, pt.x), std::min(min.y, pt.y)};
+					max = DoubleVec{std::max(max.x, pt.x), std::max(max.y, pt.y)};
+				}
+			}
+		}
+		return Box2d{ToPoint2d(min), ToPoint2d(max)};
+	}
+
+	float BoxGap(const Box2d &a, const Box2d &b) {
+		auto dx = std::max(std::max(a.min[0] - b.max[0], b.min[0] - a.max[0]), 0.f);
+		auto dy = std::max(std::max(a.min[1] - b.max[1], b.min[1] - a.max[1]), 0.f);
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	inline void BoxCorners(const Box2d &box, DoubleVec corners[4]) {
+		corners[0] = DoubleVec{box.min[0], box.min[1]};
+		corners[1] = DoubleVec{box.max[0], box.min[1]};
+		corners[2] = DoubleVec{box.max[0], box.max[1]};
+		corners[3] = DoubleVec{box.min[0], box.max[1]};
+	}
+
+	double SegmentDistance(const DoubleVec &pt, const DoubleVec &p0, const DoubleVec &p1) {
+		auto dir = p1 - p0;
+		auto len2 = Dot(dir, dir);
+		auto t = len2 > 0. ? std::min(std::max(Dot(pt - p0, dir) / len2, 0.), 1.) : 0.;
+		return Norm(pt - (p0 + dir * t));
+	}
+
+	// Clip the segment to the box's slabs
+	bool SegmentHitsBox(const DoubleVec &p0, const DoubleVec &p1, const Box2d &box) {
+		const double from[2] = {p0.x, p0.y};
+		const double dir[2] = {p1.x - p0.x, p1.y - p0.y};
+		auto t0 = 0.;
+		auto t1 = 1.;
+		for(int i=0; i < 2; ++i) {
+			if(dir[i] == 0.) {
+				if(from[i] < box.min[i] || from[i] > box.max[i]) {
+					return false;
+				}
+				continue;
+			}
+			auto ta = (box.min[i] - from[i]) / dir[i];
+			auto tb = (box.max[i] - from[i]) / dir[i];
+			t0 = std::max(t0, std::min(ta, tb));
+			t1 = std::min(t1, std::max(ta, tb));
+			if(t0 > t1) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	double SegmentBoxDistance(const DoubleVec &p0, const DoubleVec &p1, const Box2d &box) {
+		if(SegmentHitsBox(p0, p1, box)) {
+			return 0.;
+		}
+		auto dist = double(std::min(BoxDistance(box, ToPoint2d(p0)), BoxDistance(box, ToPoint2d(p1))));
+		DoubleVec corners[4];
+		BoxCorners(box, corners);
+		for(const auto &corner : corners) {
+			dist = std::min(dist, SegmentDistance(corner, p0, p1));
+		}
+		return dist;
+	}
+
+	// Largest dot product of v with the directions of a circular site
+	// over [begin, end]
+	double MaxAlong(const ClearanceSite &site, double begin, double end, const DoubleVec &v) {
+		auto len = Norm(v);
+		if(len <= 0.) {
+			return 0.;
+		}
+		if(InSpan(site, SiteAngle(site, ToDouble(site.origin) + v), begin, end)) {
+			return len;
+		}
+		return std::max(Dot(v, SiteDirection(site, begin)), Dot(v, SiteDirection(site, end)));
+	}
+
+	// Whether box reaches into the open half-planes on the site's side of
+	// its tangents over [begin, end], which hold every ball touching the
+	// site there from that side. The half-planes leave a convex set
+	// uncovered, so testing the corners is enough.
+	bool Faces(const ClearanceSite &site, double begin, double end, const Box2d &box, double tol) {
+		DoubleVec corners[4];
+		BoxCorners(box, corners);
+		auto origin = ToDouble(site.origin);
+		for(const auto &corner : corners) {
+			if(site.turn == 0) {
+				if(Dot(corner - origin, ToDouble(site.normal)) > -tol) {
+					return true;
+				}
+			}
+			else if(MaxAlong(site, begin, end, (corner - origin) * site.grows) - site.grows * double(site.radius) > -tol) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Real roots of a t^2 + b t + c with a > 0
+	int SolveQuadratic(double a, double b, double c, double roots[2]) {
+		auto disc = b * b - 4. * a * c;
+		if(a <= 0. || disc < 0.) {
+			return 0;
+		}
+		auto root = std::sqrt(disc);
+		// Avoid cancelling b against the root
+		auto q = -0.5 * (b + (b >= 0. ? root : -root));
+		if(q == 0.) {
+			roots[0] = 0.;
+			return 1;
+		}
+		roots[0] = q / a;
+		roots[1] = c / q;
+		return 2;
+	}
+
+	inline void AddCut(const ClearanceSite &site, double t, double begin, double end, std::vector<double> &cuts) {
+		if(t > begin && t < end) {
+			cuts.push_back(t);
+		}
+		else if(site.closed && t + 2. * M_PI > begin && t + 2. * M_PI < end) {
+			cuts.push_back(t + 2. * M_PI);
+		}
+	}
+
+	// Parameters in (begin, end) where the offset of site at distance d
+	// crosses the line through pt along dir
+	void LineCrossings(const ClearanceSite &site, double d, double begin, double end, const DoubleVec &pt, const DoubleVec &dir, std::vector<double> &cuts) {
+		if(site.turn == 0) {
+			auto axis = SegmentAxis(site);
+			auto den = Cross(axis, dir);
+			if(den != 0.) {
+				AddCut(site, Cross(pt - SitePoint(site, d, 0.), dir) / den, begin, end, cuts);
+			}
+			return;
+		}
+		auto radius = SiteRadius(site, d);
+		auto w = pt - ToDouble(site.origin);
+		double roots[2];
+		auto count = SolveQuadratic(Dot(dir, dir), 2. * Dot(w, dir), Dot(w, w) - radius * radius, roots);
+		for(int i=0; i < count; ++i) {
+			AddCut(site, SiteAngle(site, pt + dir * roots[i]), begin, end, cuts);
+		}
+	}
+
+	// Parameters in (begin, end) where the offset of site at distance d
+	// crosses the circle
+	void CircleCrossings(const ClearanceSite &site, double d, double begin, double end, const DoubleVec &center, double radius, std::vector<double> &cuts) {
+		if(site.turn == 0) {
+			auto axis = SegmentAxis(site);
+			auto w = SitePoint(site, d, 0.) - center;
+			double roots[2];
+			auto count = SolveQuadratic(Dot(axis, axis), 2. * Dot(w, axis), Dot(w, w) - radius * radius, roots);
+			for(int i=0; i < count; ++i) {
+				AddCut(site, roots[i], begin, end, cuts);
+			}
+			return;
+		}
+		auto origin = ToDouble(site.origin);
+		auto site_radius = SiteRadius(site, d);
+		auto between = center - origin;
+		auto dist = Norm(between);
+		if(dist <= 0.) {
+			return;
+		}
+		auto along = (site_radius * site_radius - radius * radius + dist * dist) / (2. * dist);
+		auto h2 = site_radius * site_radius - along * along;
+		if(h2 < 0.) {
+			return;
+		}
+		auto base = origin + between * (along / dist);
+		auto across = DoubleVec{-between.y, between.x} * (std::sqrt(h2) / dist);
+		AddCut(site, SiteAngle(site, base + across), begin, end, cuts);
+		AddCut(site, SiteAngle(site, base - across), begin, end, cuts);
+	}
+
+	// Where the offset of site at distance d crosses the boundary of the
+	// points within d of curve: offsets of the curve both ways and circles
+	// around its ends. Whole lines and circles are used, which only adds
+	// cuts.
+	void Crossings(const ClearanceSite &site, double d, double begin, double end, const Curve &curve, std::vector<double> &cuts) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				auto p0 = ToDouble(segment.pts[0]);
+				auto p1 = ToDouble(segment.pts[1]);
+				auto dir = p1 - p0;
+				auto len = Norm(dir);
+				if(len > 0.) {
+					auto normal = DoubleVec{dir.y, -dir.x} * (d / len);
+					LineCrossings(site, d, begin, end, p0 + normal, dir, cuts);
+					LineCrossings(site, d, begin, end, p0 - normal, dir, cuts);
+				}
+				CircleCrossings(site, d, begin, end, p0, d, cuts);
+				CircleCrossings(site, d, begin, end, p1, d, cuts);
+				break;
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				auto radius = std::abs(double(circle.radius));
+				CircleCrossings(site, d, begin, end, ToDouble(circle.center), radius + d, cuts);
+				CircleCrossings(site, d, begin, end, ToDouble(circle.center), std::abs(radius - d), cuts);
+				break;
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				auto radius = std::abs(double(arc.circle.radius));
+				CircleCrossings(site, d, begin, end, ToDouble(arc.circle.center), radius + d, cuts);
+				CircleCrossings(site, d, begin, end, ToDouble(arc.circle.center), std::abs(radius - d), cuts);
+				CircleCrossings(site, d, begin, end, ToDouble(arc.endpoints.pts[0]), d, cuts);
+				CircleCrossings(site, d, begin, end, ToDouble(arc.endpoints.pts[1]), d, cuts);
+				break;
+			}
+		}
+	}
+
+	// Distance from pt to curve, in double like the offsets
+	double CurveDistance(const Curve &curve, const DoubleVec &pt) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				return SegmentDistance(pt, ToDouble(segment.pts[0]), ToDouble(segment.pts[1]));
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				return std::abs(Norm(pt - ToDouble(circle.center)) - std::abs(double(circle.radius)));
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				auto center = ToDouble(arc.circle.center);
+				auto p0 = ToDouble(arc.endpoints.pts[0]);
+				auto p1 = ToDouble(arc.endpoints.pts[1]);
+				auto turn = std::signbit(arc.circle.radius) ? -1. : 1.;
+				auto sweep = double(std::abs(SweepAngle(arc)));
+				auto from = p0 - center;
+				auto dir = pt - center;
+				auto angle = std::atan2(Cross(from, dir), Dot(from, dir)) * turn;
+				if(angle < 0.) {
+					angle += 2. * M_PI;
+				}
+				if(angle <= sweep) {
+					return std::abs(Norm(dir) - std::abs(double(arc.circle.radius)));
+				}
+				return std::min(Norm(pt - p0), Norm(pt - p1));
+			}
+		}
+		return std::numeric_limits<double>::infinity();
+	}
+
+	typedef std::vector<std::pair<double, double>> Intervals;
+
+	// Parts of kept outside covered, both sorted and disjoint
+	void Subtract(const Intervals &kept, const Intervals &covered, Intervals &result) {
+		result.clear();
+		size_t j = 0;
+		for(const auto &interval : kept) {
+			while(j < covered.size() && covered[j].second <= interval.first) {
+				++j;
+			}
+			auto from = interval.first;
+			for(auto k=j; k < covered.size() && covered[k].first < interval.second; ++k) {
+				if(covered[k].first > from) {
+					result.push_back(std::make_pair(from, covered[k].first));
+				}
+				from = std::max(from, covered[k].second);
+			}
+			if(from < interval.second) {
+				result.push_back(std::make_pair(from, interval.second));
+			}
+		}
+	}
+
+	ClearanceIndex::ClearanceIndex(const std::vector<Loop> &loops, unsigned threads, JobControl *control)
+	: index_(loops)
+	{
+		auto scale = 1.f;
+		auto box = Box2d{Point2d(0.f, 0.f), Point2d(0.f, 0.f)};
+		for(const auto &loop : loops) {
+			for(const auto &curve : loop.curves()) {
+				auto bounds = Bounds(curve);
+				box = curves_.empty() ? bounds : Box2d{
+					Point2d(std::min(box.min[0], bounds.min[0]), std::min(box.min[1], bounds.min[1])),
+					Point2d(std::max(box.max[0], bounds.max[0]), std::max(box.max[1], bounds.max[1]))
+				};
+				scale = std::max(scale, std::max(
+					std::max(std::abs(bounds.min[0]), std::abs(bounds.min[1])),
+					std::max(std::abs(bounds.max[0]), std::abs(bounds.max[1]))
+				));
+				curves_.push_back(curve);
+				bounds_.push_back(bounds);
+			}
+		}
+		tol_ = 1e-5f * scale;
+		extent_ = std::max((box.max - box.min).norm(), tol_);
+		BuildSide(loops, 1, threads, control, sides_[0]);
+		BuildSide(loops, -1, threads, control, sides_[1]);
+		if(control && control->cancelled()) {
+			sides_[0].fragments.clear();
+			sides_[1].fragments.clear();
+		}
+	}
+
+	void ClearanceIndex::BuildSide(const std::vector<Loop> &loops, int sign, unsigned threads, JobControl *control, Side &side) {
+		auto id = uint32_t(0);
+		auto loop_sites = std::vector<uint32_t>{};
+		auto crossings = std::vector<std::pair<uint32_t, uint32_t>>{};
+		for(const auto &loop : loops) {
+			const auto &curves = loop.curves();
+			loop_sites.assign(curves.size(), kNoSite);
+			auto first_crossing = crossings.size();
+			auto base = id;
+			for(size_t i=0; i < curves.size(); ++i, ++id) {
+				const auto &curve = curves[i];
+				auto before = side.sites.size();
+				auto prev = base + uint32_t((i + curves.size() - 1) % curves.size());
+				auto next = base + uint32_t((i + 1) % curves.size());
+				switch(TargetType(curve)) {
+					case Curve::CurveType::LineSegment: {
+						const auto &segment = *(LineSegment*)Target(curve);
+						if((segment.pts[1] - segment.pts[0]).norm() <= 0.f) {
+							break;
+						}
+						auto t = Tangents(segment)[0];
+						auto normal = Vec2d(t[1], -t[0]) * float(sign);
+						side.sites.push_back(ClearanceSite{
+							segment.pts[0], segment.pts[1], Vec2d(0.f, 0.f), normal, 0.f, 1.f, 0, 0, false, id, {prev, next}, {false, false}
+						});
+						break;
+					}
+					case Curve::CurveType::Circle: {
+						const auto &circle = *(Circle*)Target(curve);
+						auto turn = int8_t(std::signbit(circle.radius) ? -1 : 1);
+						side.sites.push_back(ClearanceSite{
+							circle.center, circle.center, Vec2d(1.f, 0.f), Vec2d(0.f, 0.f), std::abs(circle.radius),
+							float(2. * M_PI), turn, int8_t(turn * sign), true, id, {kNoCurve, kNoCurve}, {false, false}
+						});
+						break;
+					}
+					case Curve::CurveType::Arc: {
+						const auto &arc = *(Arc*)Target(curve);
+						auto radius = std::abs(arc.circle.radius);
+						auto turn = int8_t(std::signbit(arc.circle.radius) ? -1 : 1);
+						side.sites.push_back(ClearanceSite{
+							arc.circle.center, arc.circle.center, (arc.endpoints.pts[0] - arc.circle.center) / radius, Vec2d(0.f, 0.f), radius,
+							std::abs(SweepAngle(arc)), turn, int8_t(turn * sign), false, id, {prev, next}, {false, false}
+						});
+						break;
+					}
+				}
+
+				// The corner after this curve, if it turns away from this
+				// side at all: however slight the turn, the offsets part by
+				// d times its angle
+				if(side.sites.size() > before) {
+					loop_sites[i] = uint32_t(before);
+				}
+				if(Endpoints(curve).empty()) {
+					continue;
+				}
+				auto t0 = Tangents(curve)[1];
+				auto t1 = Tangents(curves[(i + 1) % curves.size()])[0];
+				auto cross = (t0 ^ t1)[0];
+				auto dot = (t0 <= t1)[0];
+				if(cross == 0.f && dot >= 0.f) {
+					continue;
+				}
+				auto turn = int8_t(cross >= 0.f ? 1 : -1);
+				if(turn != sign) {
+					crossings.push_back(std::make_pair(uint32_t(i), uint32_t((i + 1) % curves.size())));
+					continue;
+				}
+				auto normal = Vec2d(t0[1], -t0[0]) * float(sign);
+				auto sweep = std::atan2(std::abs(double(cross)), double(dot));
+				side.sites.push_back(ClearanceSite{
+					Endpoints(curve)[1], Endpoints(curve)[1], normal, Vec2d(0.f, 0.f), 0.f, float(sweep), turn, 1, false, kCornerSite, {id, next}, {false, false}
+				});
+			}
+			for(auto k=first_crossing; k < crossings.size(); ++k) {
+				crossings[k] = std::make_pair(loop_sites[crossings[k].first], loop_sites[crossings[k].second]);
+			}
+		}
+		side.crossing.assign(side.sites.size(), kNoSite);
+		for(const auto &crossing : crossings) {
+			if(crossing.first != kNoSite && crossing.second != kNoSite) {
+				side.crossing[crossing.first] = crossing.second;
+				side.sites[crossing.first].crosses[1] = true;
+				side.sites[crossing.second].crosses[0] = true;
+			}
+		}
+
+		// Sites are independent, so their fragments are built in parallel,
+		// a block of sites at a time
+		if(control && control->cancelled()) {
+			return;
+		}
+		auto fragments = std::vector<std::vector<Fragment>>(side.sites.size());
+		auto blocks = (side.sites.size() + kBuildBlock - 1) / kBuildBlock;
+		if(control) {
+			control->AddWork(blocks);
+		}
+		ParallelFor(blocks, threads, [&](size_t begin, size_t end) {
+			for(auto block=begin; block < end; ++block) {
+				if(control && control->cancelled()) {
+					return;
+				}
+				auto last = std::min(side.sites.size(), (block + 1) * kBuildBlock);
+				for(auto i=block * kBuildBlock; i < last; ++i) {
+					BuildFragments(side.sites[i], uint32_t(i), fragments[i]);
+				}
+				if(control) {
+					control->Advance();
+				}
+			}
+		}, 1);
+		if(control && control->cancelled()) {
+			return;
+		}
+		for(const auto &site_fragments : fragments) {
+			side.fragments.insert(side.fragments.end(), site_fragments.begin(), site_fragments.end());
+		}
+		std::stable_sort(side.fragments.begin(), side.fragments.end(), [](const Fragment &a, const Fragment &b) {
+			return a.clearance > b.clearance;
+		});
+	}
+
+	ClearanceIndex::Sample ClearanceIndex::Shrink(const ClearanceSite &site, double t) const {
+		const auto infinity = std::numeric_limits<double>::infinity();
+		auto sample = Sample{t, infinity, Point2d(0.f, 0.f), false};
+		// Where the offsets cross at a corner no ball fits at all
+		if((site.crosses[0] && t <= 0.) || (site.crosses[1] && t >= site.length)) {
+			sample.radius = 0.;
+			return sample;
+		}
+		// Offsets of a shrinking circle meet at its center
+		auto limit = site.grows < 0 ? double(site.radius) : infinity;
+		auto base = SitePoint(site, 0., t);
+		auto normal = SitePoint(site, 1., t) - base;
+		normal = normal * (1. / Norm(normal));
+		auto radius = std::min(2. * double(extent_), limit);
+		for(int step=0; step < kShrinkSteps; ++step) {
+			// Points inside by less than kShrinkSlack count as on the ball.
+			// That only loosens the bound, and keeps the query from visiting
+			// every curve where many are nearly equidistant, as around the
+			// center of a circle.
+			auto center = ToPoint2d(base + normal * radius);
+			auto closest = index_.ClosestPoint(center, float(radius - 1e-2 * tol_ - kShrinkSlack * radius));
+			auto offset = ToDouble(closest) - base;
+			auto height = Dot(offset, normal);
+			if((closest[0] == center[0] && closest[1] == center[1]) || height <= 0.) {
+				break;
+			}
+			// The ball touching the site at t and passing through closest
+			auto shrunk = Dot(offset, offset) / (2. * height);
+			sample.obstacle = closest;
+			sample.blocked = true;
+			if(shrunk >= radius) {
+				break;
+			}
+			radius = shrunk;
+		}
+		if(sample.blocked || limit < infinity) {
+			sample.radius = radius;
+		}
+		return sample;
+	}
+
+	// Radius of the ball touching the site at parameter t and passing
+	// through obstacle, which bounds the clearance there. Infinite if the
+	// obstacle isn't on the site's side.
+	double ObstacleRadius(const ClearanceSite &site, const DoubleVec &obstacle, double t) {
+		auto base = SitePoint(site, 0., t);
+		auto normal = SitePoint(site, 1., t) - base;
+		auto offset = obstacle - base;
+		auto height = Dot(offset, normal) / Norm(normal);
+		if(height <= 0.) {
+			return std::numeric_limits<double>::infinity();
+		}
+		return Dot(offset, offset) / (2. * height);
+	}
+
+	// Largest ObstacleRadius over [begin, end]. Along a segment it is
+	// convex, so largest at an end. Along a circular site it is monotone
+	// in how far the direction points toward the obstacle, so largest at
+	// an end or where the direction points straight at or away from it.
+	double ObstacleBound(const ClearanceSite &site, const DoubleVec &obstacle, double begin, double end) {
+		auto bound = std::max(ObstacleRadius(site, obstacle, begin), ObstacleRadius(site, obstacle, end));
+		if(site.turn == 0) {
+			return bound;
+		}
+		auto origin = ToDouble(site.origin);
+		auto toward = obstacle - origin;
+		if(Norm(toward) <= 0.) {
+			return bound;
+		}
+		for(auto sign : {1., -1.}) {
+			auto t = SiteAngle(site, origin + toward * sign);
+			if(InSpan(site, t, begin, end)) {
+				bound = std::max(bound, ObstacleRadius(site, obstacle, t));
+			}
+		}
+		return bound;
+	}
+
+	void ClearanceIndex::BuildFragments(const ClearanceSite &site, uint32_t index, std::vector<Fragment> &fragments) const {
+		struct Pending{
+			Sample first;
+			Sample last;
+			int splits;
+		};
+		const auto infinity = std::numeric_limits<double>::infinity();
+		auto limit = site.grows < 0 ? double(site.radius) : infinity;
+		auto pending = std::vector<Pending>{Pending{Shrink(site, 0.), Shrink(site, site.length), 0}};
+		while(!pending.empty()) {
+			auto span = pending.back();
+			pending.pop_back();
+
+			// Every obstacle bounds the whole fragment; the samples'
+			// radii are what the clearance actually reaches there
+			auto mid = Shrink(site, 0.5 * (span.first.t + span.last.t));
+			const Sample* samples[3] = {&span.first, &mid, &span.last};
+			auto clearance = limit;
+			auto reached = 0.;
+			for(auto sample : samples) {
+				reached = std::max(reached, sample->radius);
+				if(sample->blocked) {
+					clearance = std::min(clearance, ObstacleBound(site, ToDouble(sample->obstacle), span.first.t, span.last.t));
+				}
+			}
+
+			if(clearance > 1.25 * reached + tol_ && span.splits < kMaxSplits && SiteLength(site, reached, span.first.t, span.last.t) > tol_) {
+				pending.push_back(Pending{mid, span.last, span.splits + 1});
+				pending.push_back(Pending{span.first, mid, span.splits + 1});
+				continue;
+			}
+			// Padded for the obstacles and balls being rounded to float
+			auto padded = clearance < infinity ? float(clearance * (1. + 1e-5) + tol_) : std::numeric_limits<float>::infinity();
+			fragments.push_back(Fragment{index, span.first.t, span.last.t, padded});
+		}
+	}
+
+	void ClearanceIndex::Neighbours(const ClearanceSite &site, double begin, double end, float reach, std::vector<uint32_t> &ids) const {
+		// A curve covering part of the offset at reach is within reach of
+		// it, on the site's side
+		auto radius = SiteRadius(site, reach);
+		auto p0 = SitePoint(site, reach, begin);
+		auto p1 = SitePoint(site, reach, end);
+		auto piece = SiteBounds(site, reach, begin, end);
+		auto tol = double(tol_);
+		index_.Overlapping([&](const Box2d &box) {
+			if(!Faces(site, begin, end, box, tol)) {
+				return false;
+			}
+			auto dist = 0.;
+			if(site.turn == 0) {
+				dist = SegmentBoxDistance(p0, p1, box);
+			}
+			else if(radius <= 0.) {
+				dist = BoxDistance(box, site.origin);
+			}
+			else {
+				// Distance to the circle bounds distance to the arc
+				auto center = ToDouble(site.origin);
+				DoubleVec corners[4];
+				BoxCorners(box, corners);
+				auto farthest = 0.;
+				for(const auto &corner : corners) {
+					farthest = std::max(farthest, Norm(corner - center));
+				}
+				dist = std::max(double(BoxGap(box, piece)), std::max(double(BoxDistance(box, site.origin)) - radius, radius - farthest));
+			}
+			return dist <= reach + tol;
+		}, ids);
+		ids.erase(std::remove(ids.begin(), ids.end(), site.curve), ids.end());
+	}
+
+	void ClearanceIndex::TrimSpan(const ClearanceSite &site, uint32_t index, double begin, double end, double d, const std::vector<uint32_t> &ids, double min_length, std::vector<Span> &spans) const {
+		if(site.turn != 0 && SiteRadius(site, d) <= 0.) {
+			return;
+		}
+		auto piece = SiteBounds(site, d, begin, end);
+		auto kept = Intervals{std::make_pair(begin, end)};
+		auto covered = Intervals{};
+		auto remaining = Intervals{};
+		auto cuts = std::vector<double>{};
+		auto dists = std::vector<double>{};
+		auto inside = std::vector<char>{};
+		for(size_t i=0; i < ids.size(); ++i) {
+			if(BoxGap(bounds_[ids[i]], piece) >= d + tol_) {
+				continue;
+			}
+			// Curves meeting the site at a corner turning away from the side
+			// touch its offset next to it, and meet it only to within their
+			// float geometry. Across a corner turning toward the side they
+			// cut into it, however shallowly, and others can only touch it
+			// on the medial axis, where rounding is all there is.
+			auto touches = (ids[i] == site.adjacent[0] && !site.crosses[0]) || (ids[i] == site.adjacent[1] && !site.crosses[1]);
+			auto covered_dist = touches ? d - tol_ : d - 1e-6 * tol_;
+			const auto &curve = curves_[ids[i]];
+			cuts.clear();
+			cuts.push_back(begin);
+			Crossings(site, d, begin, end, curve, cuts);
+			cuts.push_back(end);
+			std::sort(cuts.begin(), cuts.end());
+
+			// Between cuts the offset is all within d of the curve or not
+			cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+			dists.clear();
+			for(size_t j=0; j + 1 < cuts.size(); ++j) {
+				dists.push_back(CurveDistance(curve, SitePoint(site, d, 0.5 * (cuts[j] + cuts[j + 1]))));
+			}
+			inside.assign(dists.size(), 0);
+			for(size_t j=0; j < dists.size(); ++j) {
+				inside[j] = dists[j] < covered_dist;
+			}
+			// From a corner where the offsets cross, the pieces up to the
+			// crossing are covered however shallow it is
+			if(site.crosses[0] && ids[i] == site.adjacent[0] && begin <= 0.) {
+				for(size_t j=0; j < dists.size() && dists[j] < d; ++j) {
+					inside[j] = 1;
+				}
+			}
+			if(site.crosses[1] && ids[i] == site.adjacent[1] && end >= site.length) {
+				for(auto j=dists.size(); j > 0 && dists[j - 1] < d; --j) {
+					inside[j - 1] = 1;
+				}
+			}
+			covered.clear();
+			for(size_t j=0; j < inside.size(); ++j) {
+				if(!inside[j]) {
+					continue;
+				}
+				if(!covered.empty() && covered.back().second == cuts[j]) {
+					covered.back().second = cuts[j + 1];
+				}
+				else {
+					covered.push_back(std::make_pair(cuts[j], cuts[j + 1]));
+				}
+			}
+			if(covered.empty()) {
+				continue;
+			}
+			Subtract(kept, covered, remaining);
+			std::swap(kept, remaining);
+			if(kept.empty()) {
+				return;
+			}
+		}
+		for(const auto &interval : kept) {
+			if(SiteLength(site, d, interval.first, interval.second) > min_length) {
+				spans.push_back(Span{index, interval.first, interval.second});
+			}
+		}
+	}
+
+	size_t ClearanceIndex::Reach(float amt) const {
+		const auto &fragments = SideOf(amt).fragments;
+		auto d = std::abs(amt);
+		return size_t(std::partition_point(fragments.begin(), fragments.end(), [d](const Fragment &fragment) {
+			return fragment.clearance >= d;
+		}) - fragments.begin());
+	}
+
+	void ClearanceIndex::Trim(float amt, size_t begin, size_t end, std::vector<Span> &spans) const {
+		const auto &side = SideOf(amt);
+		auto d = std::abs(amt);
+		auto ids = std::vector<uint32_t>{};
+		for(auto i=begin; i < end; ++i) {
+			// Only curves within reach of the offset can trim it
+			const auto &fragment = side.fragments[i];
+			const auto &site = side.sites[fragment.site];
+			Neighbours(site, fragment.begin, fragment.end, d, ids);
+			TrimSpan(site, fragment.site, fragment.begin, fragment.end, d, ids, 0.5 * tol_, spans);
+		}
+	}
+
+	std::vector<Curve> ClearanceIndex::Curves(float amt, std::vector<Span> spans) const {
+		const auto &side = SideOf(amt);
+		auto d = double(std::abs(amt));
+		std::sort(spans.begin(), spans.end(), [](const Span &a, const Span &b) {
+			return a.site < b.site || (a.site == b.site && a.begin < b.begin);
+		});
+
+		// Pieces shorter than tol are kept as chords, for the welding to
+		// collapse: skipping them would let the gaps of a run of them add
+		// up past tol
+		auto tol2 = tol_ * tol_;
+		auto short_piece = [tol2](const Point2d &p0, const Point2d &p1) {
+			auto e = p1 - p0;
+			return (e <= e)[0] <= tol2;
+		};
+		auto empty_piece = [](const Point2d &p0, const Point2d &p1) {
+			return p0[0] == p1[0] && p0[1] == p1[1];
+		};
+		auto curves = std::vector<Curve>{};
+		auto merged = Intervals{};
+		for(size_t i=0; i < spans.size();) {
+			// Spans on a site meet where fragments were split
+			const auto &site = side.sites[spans[i].site];
+			merged.clear();
+			auto j = i;
+			for(; j < spans.size() && spans[j].site == spans[i].site; ++j) {
+				if(!merged.empty() && spans[j].begin <= merged.back().second) {
+					merged.back().second = std::max(merged.back().second, spans[j].end);
+				}
+				else {
+					merged.push_back(std::make_pair(spans[j].begin, spans[j].end));
+				}
+			}
+
+			// Where the corner after the site turns toward the side, the
+			// offsets of its curves cross. Too shallow a crossing for the
+			// trims to resolve (by less than tol, within sqrt(tol d) of the
+			// corner) leaves one or both running on to the corner, so the
+			// ends are joined.
+			auto next = side.crossing[spans[i].site];
+			if(next != kNoSite) {
+				auto found = std::lower_bound(spans.begin(), spans.end(), next, [](const Span &span, uint32_t index) {
+					return span.site < index;
+				});
+				if(found != spans.end() && found->site == next) {
+					const auto &next_site = side.sites[next];
+					auto q0 = SitePoint(site, d, merged.back().second);
+					auto q1 = SitePoint(next_site, d, found->begin);
+					auto reaches = SiteLength(site, d, merged.back().second, site.length) <= tol_ || SiteLength(next_site, d, 0., found->begin) <= tol_;
+					auto p0 = ToPoint2d(q0);
+					auto p1 = ToPoint2d(q1);
+					if(reaches && Norm(q1 - q0) <= 2. * std::sqrt(tol_ * d) + tol_ && !empty_piece(p0, p1)) {
+						curves.push_back(LineSegment{p0, p1});
+					}
+				}
+			}
+			i = j;
+
+			auto center = site.origin;
+			auto radius = float(site.turn * SiteRadius(site, d));
+			if(site.closed && merged.front().first <= 0. && merged.back().second >= site.length) {
+				if(merged.size() == 1) {
+					curves.push_back(Circle{center, radius});
+					continue;
+				}
+				// Join across parameter 0
+				merged.back().second = site.length + merged.front().second;
+				merged.erase(merged.begin());
+			}
+			for(const auto &interval : merged) {
+				auto p0 = ToPoint2d(SitePoint(site, d, interval.first));
+				auto p1 = ToPoint2d(SitePoint(site, d, interval.second));
+				if(empty_piece(p0, p1)) {
+					continue;
+				}
+				if(site.turn == 0 || short_piece(p0, p1)) {
+					curves.push_back(LineSegment{p0, p1});
+				}
+				else {
+					curves.push_back(Arc{Circle{center, radius}, LineSegment{p0, p1}});
+				}
+			}
+		}
+		return curves;
+	}
+}
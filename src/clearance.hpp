@@ -0,0 +1,142 @@
+#ifndef clearance_hpp
+#define clearance_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "distance.hpp"
+#include "job.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// A curve, or a corner, seen from one side: its offsets toward that
+	// side are segments or arcs. Corners are radius 0 circles around
+	// themselves, swept between the normals of the curves meeting there.
+	struct ClearanceSite{
+		// Segment start, or circle center
+		Point2d origin;
+		// Segment end
+		Point2d end;
+		// Circular sites: direction at parameter 0, scaled to the start
+		// point on arcs
+		Vec2d axis;
+		// Segments: unit normal toward the side
+		Vec2d normal;
+		float radius;
+		// Parameters run over [0, length]: 1 on segments, the angle swept
+		// on circular sites
+		float length;
+		// Circular sites: +1 sweeping CCW, -1 CW. 0 for segments.
+		int8_t turn;
+		// Circular sites: +1 if the radius grows toward the side
+		int8_t grows;
+		bool closed;
+		// Curve index counting through the loops, or kCornerSite
+		uint32_t curve;
+		// Curves meeting the site at its start and end, or kNoCurve
+		uint32_t adjacent[2];
+		// Whether the corners at the start and end turn toward the side,
+		// so that the offsets meeting there cross
+		bool crosses[2];
+	};
+
+	const uint32_t kCornerSite = ~uint32_t(0);
+	const uint32_t kNoCurve = ~uint32_t(0);
+
+	// How far the offsets of a set of loops reach before they vanish,
+	// indexed once so that offsets at any distance can be extracted
+	// without offsetting everything. This stands in for a medial axis: it
+	// is not a Voronoi diagram, only what extraction needs from one.
+	//
+	// The sites on each side are the curves and the corners turning away
+	// from it, whose offsets are arcs around the corner. A point's
+	// clearance is the radius of the largest ball touching the site there
+	// with no curve inside, i.e. its distance to the medial axis; its
+	// offset survives up to that distance. Each site is cut into
+	// fragments, each storing an upper bound on its clearance.
+	//
+	// Bounds come from shrinking balls: a ball touching the site is shrunk
+	// onto the nearest curve point inside it until none is left, in a few
+	// nearest point queries. Any curve point bounds the clearance along a
+	// whole fragment, so the obstacles met at a fragment's ends and middle
+	// bound it, and fragments are halved while that bound is well above
+	// what the balls reached. Building costs O(n log n) for n sites.
+	//
+	// The offset at distance d is then the fragments whose bound reaches
+	// d, each offset exactly and trimmed where a curve within reach of it
+	// is closer than d. Fragments are sorted by clearance, so an
+	// extraction only visits fragments that contribute to its output, and
+	// the curves within reach of them. Where a loop splits or vanishes the
+	// trims meet up accordingly.
+	class ClearanceIndex{
+	public:
+		// Parameter range of a site whose offset is kept
+		struct Span{
+			uint32_t site;
+			double begin;
+			double end;
+		};
+
+		// Sites are built across threads in blocks, checking control between
+		// them. A cancelled build leaves no fragments, so offsets are empty.
+		ClearanceIndex(const std::vector<Loop> &loops, unsigned threads = 1, JobControl *control = nullptr);
+
+		// Fragments on amt's side whose clearance reaches |amt|. They are
+		// the first ones, so an extraction visits [0, Reach(amt)).
+		size_t Reach(float amt) const;
+		// Kept spans of fragments [begin, end) on amt's side, appended
+		void Trim(float amt, size_t begin, size_t end, std::vector<Span> &spans) const;
+		// Offset curves along spans, joining spans that meet on a site
+		std::vector<Curve> Curves(float amt, std::vector<Span> spans) const;
+
+		// Distance the offsets are accurate to, relative to the loops' size
+		float tolerance() const { return tol_; }
+
+	private:
+		struct Fragment{
+			uint32_t site;
+			double begin;
+			double end;
+			// Upper bound on the clearance, infinite where the offset
+			// never closes
+			float clearance;
+		};
+
+		// Ball touching a site at parameter t, shrunk until no curve is
+		// inside. Its radius is infinite if nothing was ever inside, and
+		// the obstacle it was last shrunk onto bounds the clearance.
+		struct Sample{
+			double t;
+			double radius;
+			Point2d obstacle;
+			bool blocked;
+		};
+
+		struct Side{
+			std::vector<ClearanceSite> sites;
+			// Per site, the next curve's site where the corner between them
+			// turns toward the side, so that their offsets cross there
+			std::vector<uint32_t> crossing;
+			// Sorted by decreasing clearance
+			std::vector<Fragment> fragments;
+		};
+
+		void BuildSide(const std::vector<Loop> &loops, int sign, unsigned threads, JobControl *control, Side &side);
+		void BuildFragments(const ClearanceSite &site, uint32_t index, std::vector<Fragment> &fragments) const;
+		Sample Shrink(const ClearanceSite &site, double t) const;
+		void Neighbours(const ClearanceSite &site, double begin, double end, float reach, std::vector<uint32_t> &ids) const;
+		void TrimSpan(const ClearanceSite &site, uint32_t index, double begin, double end, double d, const std::vector<uint32_t> &ids, double min_length, std::vector<Span> &spans) const;
+		const Side& SideOf(float amt) const { return amt > 0.f ? sides_[0] : sides_[1]; }
+
+		std::vector<Curve> curves_;
+		std::vector<Box2d> bounds_;
+		DistanceIndex index_;
+		// Right (positive offsets) and left
+		Side sides_[2];
+		float extent_;
+		float tol_;
+	};
+}
+
+#endif
@@ -0,0 +1,317 @@
+#include "clip.hpp"
+#include "containment.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace planar {
+
+	Loop RectangleLoop(const Box2d &rect) {
+		auto p0 = rect.min;
+		auto p1 = Point2d(rect.max[0], rect.min[1]);
+		auto p2 = rect.max;
+		auto p3 = Point2d(rect.min[0], rect.max[1]);
+		return Loop(std::vector<Curve>{
+			LineSegment{p0, p1}, LineSegment{p1, p2}, LineSegment{p2, p3}, LineSegment{p3, p0}
+		});
+	}
+
+	// Cohen-Sutherland outcode of a point against the rectangle
+	enum Outcode : uint8_t{
+		kInside = 0,
+		kLeft = 1,
+		kRight = 2,
+		kBelow = 4,
+		kAbove = 8
+	};
+
+	uint8_t ComputeOutcode(const Box2d &rect, const Point2d &pt) {
+		return uint8_t((pt[0] < rect.min[0] ? kLeft : 0) | (pt[0] > rect.max[0] ? kRight : 0) |
+			(pt[1] < rect.min[1] ? kBelow : 0) | (pt[1] > rect.max[1] ? kAbove : 0));
+	}
+
+	bool BoxInside(const Box2d &box, const Box2d &rect) {
+		return box.min[0] >= rect.min[0] && box.max[0] <= rect.max[0] &&
+			box.min[1] >= rect.min[1] && box.max[1] <= rect.max[1];
+	}
+
+	bool BoxDisjoint(const Box2d &box, const Box2d &rect) {
+		return box.max[0] < rect.min[0] || box.min[0] > rect.max[0] ||
+			box.max[1] < rect.min[1] || box.min[1] > rect.max[1];
+	}
+
+	bool PointInside(const Box2d &rect, const Point2d &pt, float tol) {
+		return pt[0] >= rect.min[0] - tol && pt[0] <= rect.max[0] + tol &&
+			pt[1] >= rect.min[1] - tol && pt[1] <= rect.max[1] + tol;
+	}
+
+	// Sequence of a loop's pieces in order; outside pieces only mark gaps
+	struct ClipPiece{
+		bool inside;
+		Curve curve;
+	};
+
+	void PushPiece(std::vector<ClipPiece> &pieces, bool inside, const Curve &curve) {
+		// Consecutive gaps are one gap
+		if(!inside && !pieces.empty() && !pieces.back().inside) {
+			return;
+		}
+		pieces.push_back(ClipPiece{inside, curve});
+	}
+
+	// Liang-Barsky: the parameter interval of the segment inside the
+	// rectangle, one slab at a time
+	void ClipSegment(const LineSegment &segment, const Box2d &rect, std::vector<ClipPiece> &pieces) {
+		auto code0 = ComputeOutcode(rect, segment.pts[0]);
+		auto code1 = ComputeOutcode(rect, segment.pts[1]);
+		if((code0 | code1) == kInside) {
+			PushPiece(pieces, true, segment);
+			return;
+		}
+		if(code0 & code1) {
+			PushPiece(pieces, false, segment);
+			return;
+		}
+		auto d = segment.pts[1] - segment.pts[0];
+		auto t0 = 0.f;
+		auto t1 = 1.f;
+		auto clip = [&](float p, float q) {
+			if(p == 0.f) {
+				return q >= 0.f;
+			}
+			auto t = q / p;
+			if(p < 0.f) {
+				t0 = std::max(t0, t);
+			}
+			else {
+				t1 = std::min(t1, t);
+			}
+			return t0 <= t1;
+		};
+		if(!clip(-d[0], segment.pts[0][0] - rect.min[0]) || !clip(d[0], rect.max[0] - segment.pts[0][0]) ||
+			!clip(-d[1], segment.pts[0][1] - rect.min[1]) || !clip(d[1], rect.max[1] - segment.pts[0][1]) ||
+			t1 - t0 <= 1e-6f)
+		{
+			PushPiece(pieces, false, segment);
+			return;
+		}
+		auto p0 = t0 > 0.f ? segment.pts[0] + d * t0 : segment.pts[0];
+		auto p1 = t1 < 1.f ? segment.pts[0] + d * t1 : segment.pts[1];
+		if(t0 > 0.f) {
+			PushPiece(pieces, false, LineSegment{segment.pts[0], p0});
+		}
+		PushPiece(pieces, true, LineSegment{p0, p1});
+		if(t1 < 1.f) {
+			PushPiece(pieces, false, LineSegment{p1, segment.pts[1]});
+		}
+	}
+
+	// Where the circle crosses the rectangle's edges
+	std::vector<Point2d> CircleEdgeCrossings(const Circle &circle, const Box2d &rect, float tol) {
+		auto pts = std::vector<Point2d>{};
+		auto r = std::abs(circle.radius);
+		const auto &c = circle.center;
+		for(int axis=0; axis < 2; ++axis) {
+			auto other = 1 - axis;
+			for(auto v : {rect.min[axis], rect.max[axis]}) {
+				auto d = v - c[axis];
+				auto h2 = r * r - d * d;
+				if(h2 < 0.f) {
+					continue;
+				}
+				auto h = std::sqrt(h2);
+				for(auto s : {c[other] - h, c[other] + h}) {
+					if(s >= rect.min[other] - tol && s <= rect.max[other] + tol) {
+						pts.push_back(axis == 0 ? Point2d(v, s) : Point2d(s, v));
+					}
+				}
+			}
+		}
+		return pts;
+	}
+
+	void ClipCurve(const Curve &curve, const Box2d &rect, float tol, std::vector<ClipPiece> &pieces) {
+		auto type = TargetType(curve);
+		if(type == Curve::CurveType::LineSegment) {
+			ClipSegment(*(LineSegment*)Target(curve), rect, pieces);
+			return;
+		}
+		auto bounds = Bounds(curve);
+		if(BoxInside(bounds, rect) || BoxDisjoint(bounds, rect)) {
+			PushPiece(pieces, BoxInside(bounds, rect), curve);
+			return;
+		}
+		const auto &circle = type == Curve::CurveType::Arc ? ((Arc*)Target(curve))->circle : *(Circle*)Target(curve);
+		for(const auto &fragment : Split(curve, CircleEdgeCrossings(circle, rect, tol))) {
+			PushPiece(pieces, PointInside(rect, Midpoint(fragment), tol), fragment);
+		}
+	}
+
+	// Position of a boundary point going CCW around the rectangle from its
+	// min corner
+	float PerimeterPosition(const Box2d &rect, const Point2d &pt) {
+		auto w = rect.max[0] - rect.min[0];
+		auto h = rect.max[1] - rect.min[1];
+		auto dists = std::array<float, 4>{{
+			std::abs(pt[1] - rect.min[1]), std::abs(pt[0] - rect.max[0]),
+			std::abs(pt[1] - rect.max[1]), std::abs(pt[0] - rect.min[0])
+		}};
+		auto edge = std::min_element(dists.begin(), dists.end()) - dists.begin();
+		switch(edge) {
+			case 0: return std::min(std::max(pt[0] - rect.min[0], 0.f), w);
+			case 1: return w + std::min(std::max(pt[1] - rect.min[1], 0.f), h);
+			case 2: return w + h + std::min(std::max(rect.max[0] - pt[0], 0.f), w);
+			default: return 2.f * w + h + std::min(std::max(rect.max[1] - pt[1], 0.f), h);
+		}
+	}
+
+	// Boundary lines CCW from one perimeter position to another, turning
+	// at each corner passed
+	void WalkBoundary(const Box2d &rect, const Point2d &from, float s0, const Point2d &to, float s1, std::vector<Curve> &curves) {
+		auto w = rect.max[0] - rect.min[0];
+		auto h = rect.max[1] - rect.min[1];
+		auto perimeter = 2.f * (w + h);
+		if(s1 < s0) {
+			s1 += perimeter;
+		}
+		const Point2d corners[4] = {Point2d(rect.max[0], rect.min[1]), rect.max, Point2d(rect.min[0], rect.max[1]), rect.min};
+		const float corner_s[4] = {w, w + h, 2.f * w + h, perimeter};
+		auto pt = from;
+		for(int lap=0; lap < 2; ++lap) {
+			for(int i=0; i < 4; ++i) {
+				auto s = corner_s[i] + float(lap) * perimeter;
+				if(s > s0 && s < s1) {
+					if((corners[i] - pt).norm() > 0.f) {
+						curves.push_back(LineSegment{pt, corners[i]});
+					}
+					pt = corners[i];
+				}
+			}
+		}
+		if((to - pt).norm() > 0.f) {
+			curves.push_back(LineSegment{pt, to});
+		}
+	}
+
+	std::vector<Loop> Clip(const std::vector<Loop> &loops, const Box2d &rect) {
+		auto scale = std::max(std::max(std::abs(rect.min[0]), std::abs(rect.min[1])), std::max(std::abs(rect.max[0]), std::abs(rect.max[1])));
+		auto tol = 1e-6f * std::max(scale, 1.f);
+		auto result = std::vector<Loop>{};
+
+		// Runs of inside pieces from entering the rectangle to leaving it
+		struct Chain{
+			std::vector<Curve> curves;
+			Point2d entry;
+			Point2d exit;
+			float entry_s;
+			float exit_s;
+		};
+		auto chains = std::vector<Chain>{};
+		auto pieces = std::vector<ClipPiece>{};
+		// Loops outside the rectangle that may still surround it
+		auto around = std::vector<Loop>{};
+		for(const auto &loop : loops) {
+			auto loop_box = Box2d{Point2d(INFINITY, INFINITY), Point2d(-INFINITY, -INFINITY)};
+			for(const auto &curve : loop.curves()) {
+				auto box = Bounds(curve);
+				loop_box.min = Point2d(std::min(loop_box.min[0], box.min[0]), std::min(loop_box.min[1], box.min[1]));
+				loop_box.max = Point2d(std::max(loop_box.max[0], box.max[0]), std::max(loop_box.max[1], box.max[1]));
+			}
+			if(BoxDisjoint(loop_box, rect)) {
+				continue;
+			}
+			if(BoxInside(loop_box, rect)) {
+				result.push_back(loop);
+				continue;
+			}
+
+			pieces.clear();
+			for(const auto &curve : loop.curves()) {
+				ClipCurve(curve, rect, tol, pieces);
+			}
+			auto n = pieces.size();
+			auto first = n;
+			for(size_t i=0; i < n; ++i) {
+				if(pieces[i].inside && !pieces[(i + n - 1) % n].inside) {
+					first = i;
+					break;
+				}
+			}
+			if(first == n) {
+				// Never leaves the rectangle, or never enters it
+				if(n > 0 && pieces[0].inside) {
+					auto curves = std::vector<Curve>{};
+					for(auto &piece : pieces) {
+						curves.push_back(std::move(piece.curve));
+					}
+					result.push_back(Loop(std::move(curves)));
+				}
+				else {
+					around.push_back(loop);
+				}
+				continue;
+			}
+			for(size_t k=0; k < n; ++k) {
+				auto &piece = pieces[(first + k) % n];
+				if(!piece.inside) {
+					continue;
+				}
+				if(!pieces[(first + k + n - 1) % n].inside) {
+					chains.push_back(Chain{{}, Endpoints(piece.curve)[0], Point2d(0.f, 0.f), 0.f, 0.f});
+				}
+				chains.back().curves.push_back(std::move(piece.curve));
+			}
+		}
+
+		if(chains.empty()) {
+			// Nothing crosses the boundary, so the loops outside it wind the
+			// same way around every point of the rectangle
+			auto center = (rect.min + rect.max) * 0.5f;
+			if(WindingNumber(around, center) != 0) {
+				result.push_back(RectangleLoop(rect));
+			}
+			return result;
+		}
+
+		auto entries = std::vector<std::pair<float, uint32_t>>{};
+		entries.reserve(chains.size());
+		for(uint32_t i=0; i < chains.size(); ++i) {
+			auto &chain = chains[i];
+			chain.exit = Endpoints(chain.curves.back())[1];
+			chain.entry_s = PerimeterPosition(rect, chain.entry);
+			chain.exit_s = PerimeterPosition(rect, chain.exit);
+			entries.emplace_back(chain.entry_s, i);
+		}
+		std::sort(entries.begin(), entries.end());
+
+		// Leave each chain along the boundary CCW to the next entry, which
+		// keeps the rectangle's inside on the left as the loops' is
+		auto used = std::vector<bool>(chains.size(), false);
+		for(uint32_t start=0; start < chains.size(); ++start) {
+			if(used[start]) {
+				continue;
+			}
+			auto curves = std::vector<Curve>{};
+			auto current = start;
+			while(!used[current]) {
+				used[current] = true;
+				auto &chain = chains[current];
+				curves.insert(curves.end(), chain.curves.begin(), chain.curves.end());
+				auto next = std::lower_bound(entries.begin(), entries.end(), std::make_pair(chain.exit_s, uint32_t(0)));
+				if(next == entries.end()) {
+					next = entries.begin();
+				}
+				const auto &target = chains[next->second];
+				WalkBoundary(rect, chain.exit, chain.exit_s, target.entry, target.entry_s, curves);
+				current = next->second;
+			}
+			result.push_back(Loop(std::move(curves)));
+		}
+		return result;
+	}
+
+	std::vector<Loop> Clip(const Loop &loop, const Box2d &rect) {
+		return Clip(std::vector<Loop>{loop}, rect);
+	}
+}
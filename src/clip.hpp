@@ -0,0 +1,24 @@
+#ifndef clip_hpp
+#define clip_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <vector>
+
+namespace planar {
+
+	// Part of a region inside an axis-aligned rectangle. Loops follow the
+	// Boolean convention: CCW loops bound filled area, CW loops holes, and
+	// loops don't cross. Curves whose bounds are inside or outside the
+	// rectangle are kept or dropped whole; the rest are cut analytically
+	// at the rectangle's edges. Pieces left inside are joined by walking the
+	// rectangle's boundary, so a loop cut into several parts gives several
+	// loops.
+	std::vector<Loop> Clip(const std::vector<Loop> &loops, const Box2d &rect);
+	std::vector<Loop> Clip(const Loop &loop, const Box2d &rect);
+
+	// The rectangle as a CCW loop
+	Loop RectangleLoop(const Box2d &rect);
+}
+
+#endif
@@ -0,0 +1,310 @@
+#include "containment.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace planar {
+
+	std::vector<MonotonePiece> MonotonePieces(const LineSegment &segment) {
+		return {MonotonePiece{segment, Point2d(0.f, 0.f), 0.f, 0.f}};
+	}
+
+	std::vector<MonotonePiece> MonotonePieces(const Circle &circle) {
+		auto r = std::abs(circle.radius);
+		auto bottom = circle.center - Point2d(0.f, r);
+		auto top = circle.center + Point2d(0.f, r);
+		// CCW circles go up the right half, CW circles go up the left half
+		auto up_side = std::signbit(circle.radius) ? -1.f : 1.f;
+		return {
+			MonotonePiece{LineSegment{bottom, top}, circle.center, r, up_side},
+			MonotonePiece{LineSegment{top, bottom}, circle.center, r, -up_side}
+		};
+	}
+
+	std::vector<MonotonePiece> MonotonePieces(const Arc &arc) {
+		const auto pi = float(M_PI);
+		const auto eps = 1e-6f;
+		auto r = std::abs(arc.circle.radius);
+		auto sweep = SweepAngle(arc);
+		auto dir = std::signbit(sweep) ? -1.f : 1.f;
+		auto remaining = std::abs(sweep);
+
+		auto d0 = arc.endpoints.pts[0] - arc.circle.center;
+		auto angle = std::atan2(d0[1], d0[0]);
+
+		// The arc changes y direction at pi/2 + k*pi. Find the first such
+		// break strictly ahead of the start in the direction of travel.
+		auto k = (angle - pi * 0.5f) / pi;
+		auto next_break = dir > 0.f ?
+			pi * 0.5f + pi * (std::floor(k) + 1.f) :
+			pi * 0.5f + pi * (std::ceil(k) - 1.f);
+		if(std::abs(next_break - angle) <= eps) {
+			next_break += dir * pi;
+		}
+
+		auto pieces = std::vector<MonotonePiece>{};
+		auto start = arc.endpoints.pts[0];
+		while(true) {
+			auto dist = (next_break - angle) * dir;
+			auto last = dist >= remaining - eps;
+			auto span = last ? remaining : dist;
+			auto mid = angle + dir * span * 0.5f;
+			auto side = std::cos(mid) >= 0.f ? 1.f : -1.f;
+			auto end = last ?
+				arc.endpoints.pts[1] :
+				arc.circle.center + Point2d(0.f, std::sin(next_break) > 0.f ? r : -r);
+			pieces.push_back(MonotonePiece{LineSegment{start, end}, arc.circle.center, r, side});
+			if(last) {
+				break;
+			}
+			start = end;
+			angle = next_break;
+			remaining -= dist;
+			next_break += dir * pi;
+		}
+		return pieces;
+	}
+
+	std::vector<MonotonePiece> MonotonePieces(const Curve &curve) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: return MonotonePieces(*(LineSegment*)Target(curve));
+			case Curve::CurveType::Circle: return MonotonePieces(*(Circle*)Target(curve));
+			case Curve::CurveType::Arc: return MonotonePieces(*(Arc*)Target(curve));
+		}
+		return {};
+	}
+
+	float CrossingX(const MonotonePiece &piece, float y) {
+		const auto &p0 = piece.endpoints.pts[0];
+		const auto &p1 = piece.endpoints.pts[1];
+		if(piece.radius == 0.f) {
+			return p0[0] + (y - p0[1]) * (p1[0] - p0[0]) / (p1[1] - p0[1]);
+		}
+		auto dy = y - piece.center[1];
+		auto h2 = piece.radius * piece.radius - dy * dy;
+		return piece.center[0] + piece.side * std::sqrt(std::max(h2, 0.f));
+	}
+
+	Box2d Bounds(const MonotonePiece &piece) {
+		auto box = Bounds(piece.endpoints);
+		// An arc piece bulges out to its circle's side where it passes the
+		// center's height
+		if(piece.radius != 0.f && box.min[1] < piece.center[1] && piece.center[1] < box.max[1]) {
+			auto x = piece.center[0] + piece.side * piece.radius;
+			box.min = Point2d(std::min(box.min[0], x), box.min[1]);
+			box.max = Point2d(std::max(box.max[0], x), box.max[1]);
+		}
+		return box;
+	}
+
+	int WindingNumber(const Loop &loop, const Point2d &pt) {
+		auto winding = 0;
+		for(const auto &curve : loop.curves()) {
+			for(const auto &piece : MonotonePieces(curve)) {
+				if(Crosses(piece, pt[1]) && CrossingX(piece, pt[1]) > pt[0]) {
+					winding += CrossingDirection(piece);
+				}
+			}
+		}
+		return winding;
+	}
+
+	int WindingNumber(const std::vector<Loop> &loops, const Point2d &pt) {
+		auto winding = 0;
+		for(const auto &loop : loops) {
+			winding += WindingNumber(loop, pt);
+		}
+		return winding;
+	}
+
+	bool Contains(const Loop &loop, const Point2d &pt) {
+		return WindingNumber(loop, pt) != 0;
+	}
+
+	bool Contains(const std::vector<Loop> &loops, const Point2d &pt) {
+		return WindingNumber(loops, pt) != 0;
+	}
+
+	WindingIndex::WindingIndex(const Loop &loop)
+	{
+		Build(std::vector<Loop>{loop});
+	}
+
+	WindingIndex::WindingIndex(const std::vector<Loop> &loops)
+	{
+		Build(loops);
+	}
+
+	float WindingIndex::SlabMin(uint32_t row) const {
+		return bounds_.min[1] + float(row) * cell_height_;
+	}
+
+	uint32_t WindingIndex::Row(float y) const {
+		auto row = int((y - bounds_.min[1]) * cell_height_inv_);
+		row = std::min(std::max(row, 0), int(rows_) - 1);
+		// Snap to the slab whose SlabMin bounds hold y, so pieces, junctions
+		// and queries agree on rows exactly
+		while(row > 0 && y < SlabMin(uint32_t(row))) {
+			--row;
+		}
+		while(row + 1 < int(rows_) && y >= SlabMin(uint32_t(row + 1))) {
+			++row;
+		}
+		return uint32_t(row);
+	}
+
+	uint32_t WindingIndex::Col(float x) const {
+		auto col = int((x - bounds_.min[0]) * cell_width_inv_);
+		return uint32_t(std::min(std::max(col, 0), int(cols_) - 1));
+	}
+
+	void WindingIndex::Build(const std::vector<Loop> &loops) {
+		// Pieces in order around each loop, horizontal ones included: they
+		// never cross a scanline but link their neighbours
+		pieces_.clear();
+		next_.clear();
+		for(const auto &loop : loops) {
+			auto first = uint32_t(pieces_.size());
+			for(const auto &curve : loop.curves()) {
+				for(const auto &piece : MonotonePieces(curve)) {
+					pieces_.push_back(piece);
+					next_.push_back(uint32_t(pieces_.size()));
+				}
+			}
+			if(pieces_.size() > first) {
+				next_.back() = first;
+			}
+		}
+		// Curves meet up to rounding. Each piece starts exactly where the
+		// one before it ends, so the junctions below cancel exactly.
+		prev_.assign(pieces_.size(), 0);
+		for(uint32_t i=0; i < pieces_.size(); ++i) {
+			prev_[next_[i]] = i;
+			pieces_[next_[i]].endpoints.pts[0] = pieces_[i].endpoints.pts[1];
+		}
+
+		auto piece_bounds = std::vector<Box2d>{};
+		piece_bounds.reserve(pieces_.size());
+		bounds_ = Box2d{Point2d(0.f, 0.f), Point2d(0.f, 0.f)};
+		for(const auto &piece : pieces_) {
+			auto box = Bounds(piece);
+			if(piece_bounds.empty()) {
+				bounds_ = box;
+			}
+			bounds_.min = Point2d(std::min(bounds_.min[0], box.min[0]), std::min(bounds_.min[1], box.min[1]));
+			bounds_.max = Point2d(std::max(bounds_.max[0], box.max[0]), std::max(bounds_.max[1], box.max[1]));
+			piece_bounds.push_back(box);
+		}
+
+		// About one piece per cell along each axis keeps the per-cell lists
+		// short for typical loops
+		auto size = uint32_t(std::ceil(std::sqrt(float(pieces_.size()))));
+		rows_ = std::min(std::max(size * 2, 1u), 1024u);
+		cols_ = rows_;
+		auto width = std::max(bounds_.max[0] - bounds_.min[0], 1e-6f);
+		auto height = std::max(bounds_.max[1] - bounds_.min[1], 1e-6f);
+		cell_width_inv_ = float(cols_) / width;
+		cell_height_inv_ = float(rows_) / height;
+		cell_height_ = height / float(rows_);
+
+		// Two passes over the pieces: count list sizes, then fill them.
+		// Pieces crossing the bottom of a row are summed at the column they
+		// start in, for the reference windings.
+		piece_cols_.resize(pieces_.size());
+		cell_winding_.assign(rows_ * cols_, 0);
+		cell_offsets_.assign(rows_ * cols_ + 1, 0);
+		auto right_of = std::vector<int>(rows_ * (cols_ + 1), 0);
+		for(int pass=0; pass < 2; ++pass) {
+			auto cell_fill = std::vector<uint32_t>(cell_offsets_.begin(), cell_offsets_.end() - 1);
+			for(uint32_t i=0; i < pieces_.size(); ++i) {
+				const auto &box = piece_bounds[i];
+				auto row0 = Row(box.min[1]);
+				auto row1 = Row(box.max[1]);
+				auto col0 = Col(box.min[0]);
+				auto col1 = Col(box.max[0]);
+				piece_cols_[i] = col0;
+				for(auto row=row0; row <= row1; ++row) {
+					if(pass == 0 && Crosses(pieces_[i], SlabMin(row))) {
+						right_of[row * (cols_ + 1) + col0] += CrossingDirection(pieces_[i]);
+					}
+					for(auto col=col0; col <= col1; ++col) {
+						auto cell = row * cols_ + col;
+						if(pass == 0) {
+							++cell_offsets_[cell + 1];
+						}
+						else {
+							cell_pieces_[cell_fill[cell]++] = i;
+						}
+					}
+				}
+			}
+			if(pass == 0) {
+				for(size_t cell=0; cell < rows_ * cols_; ++cell) {
+					cell_offsets_[cell + 1] += cell_offsets_[cell];
+				}
+				cell_pieces_.resize(cell_offsets_.back());
+			}
+		}
+
+		// A piece starting in column c is wholly right of every cell in
+		// columns < c
+		for(uint32_t row=0; row < rows_; ++row) {
+			auto winding = 0;
+			for(int col=int(cols_) - 1; col >= 0; --col) {
+				winding += right_of[row * (cols_ + 1) + col + 1];
+				cell_winding_[row * cols_ + col] = winding;
+			}
+		}
+	}
+
+	int WindingIndex::WindingNumber(const Point2d &pt) const {
+		if(pieces_.empty() ||
+			pt[0] < bounds_.min[0] || pt[0] > bounds_.max[0] ||
+			pt[1] < bounds_.min[1] || pt[1] > bounds_.max[1]
+		) {
+			return 0;
+		}
+
+		auto row = Row(pt[1]);
+		auto col = Col(pt[0]);
+		auto cell = row * cols_ + col;
+		auto slab_min = SlabMin(row);
+		auto winding = cell_winding_[cell];
+		// Right of the cell, the winding changes up the row only where a
+		// piece there joins one reaching into the cell: its start or end
+		// counts once the scanline passes the joint
+		auto passed = [&](float y) {
+			return int(y <= pt[1]) - int(y <= slab_min);
+		};
+		for(auto i=cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+			auto id = cell_pieces_[i];
+			const auto &piece = pieces_[id];
+			if(Crosses(piece, pt[1]) && CrossingX(piece, pt[1]) > pt[0]) {
+				winding += CrossingDirection(piece);
+			}
+			if(piece_cols_[next_[id]] > col) {
+				winding += passed(pieces_[next_[id]].endpoints.pts[0][1]);
+			}
+			if(piece_cols_[prev_[id]] > col) {
+				winding -= passed(pieces_[prev_[id]].endpoints.pts[1][1]);
+			}
+		}
+		return winding;
+	}
+
+	void WindingNumbers(const WindingIndex &index, const float *x, const float *y, size_t count, int *winding, unsigned threads) {
+		ParallelFor(count, threads, [&](size_t begin, size_t end) {
+			for(auto i=begin; i < end; ++i) {
+				winding[i] = index.WindingNumber(Point2d(x[i], y[i]));
+			}
+		});
+	}
+
+	void Contains(const WindingIndex &index, const float *x, const float *y, size_t count, uint8_t *inside, unsigned threads) {
+		ParallelFor(count, threads, [&](size_t begin, size_t end) {
+			for(auto i=begin; i < end; ++i) {
+				inside[i] = index.WindingNumber(Point2d(x[i], y[i])) != 0 ? 1 : 0;
+			}
+		});
+	}
+}
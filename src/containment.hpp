@@ -0,0 +1,101 @@
+#ifndef containment_hpp
+#define containment_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// A piece of a curve that is monotone in y, so it crosses any horizontal
+	// line at most once. Arcs and circles are split at their topmost and
+	// bottommost points; line segments are a single piece.
+	struct MonotonePiece{
+		LineSegment endpoints;
+		Point2d center;
+		// Zero for straight pieces, otherwise the (unsigned) circle radius
+		float radius;
+		// +1 if an arc piece lies on the right half of its circle, -1 for the left
+		float side;
+	};
+
+	std::vector<MonotonePiece> MonotonePieces(const LineSegment &segment);
+	std::vector<MonotonePiece> MonotonePieces(const Circle &circle);
+	std::vector<MonotonePiece> MonotonePieces(const Arc &arc);
+	std::vector<MonotonePiece> MonotonePieces(const Curve &curve);
+
+	// True if the horizontal line at y crosses the piece. The range is half
+	// open, [min y, max y), so a vertex shared by two pieces counts once.
+	inline bool Crosses(const MonotonePiece &piece, float y) {
+		auto y0 = piece.endpoints.pts[0][1];
+		auto y1 = piece.endpoints.pts[1][1];
+		return y0 < y1 ? (y0 <= y && y < y1) : (y1 <= y && y < y0);
+	}
+
+	// +1 for pieces running up, -1 for pieces running down
+	inline int CrossingDirection(const MonotonePiece &piece) {
+		return piece.endpoints.pts[0][1] < piece.endpoints.pts[1][1] ? 1 : -1;
+	}
+
+	// x coordinate where the horizontal line at y crosses the piece
+	float CrossingX(const MonotonePiece &piece, float y);
+
+	Box2d Bounds(const MonotonePiece &piece);
+
+	// Number of times the loop winds CCW around pt. CW turns count negative.
+	int WindingNumber(const Loop &loop, const Point2d &pt);
+	int WindingNumber(const std::vector<Loop> &loops, const Point2d &pt);
+
+	// Non-zero winding rule containment
+	bool Contains(const Loop &loop, const Point2d &pt);
+	bool Contains(const std::vector<Loop> &loops, const Point2d &pt);
+
+	// Uniform grid over the monotone pieces of one or more loops for
+	// repeated winding number queries. Every piece is stored in the cells
+	// its bounds overlap. Each cell keeps a reference winding: that of the
+	// pieces starting right of it, at the bottom of its row. Up the row it
+	// changes only where such a piece joins one in the cell, so a query
+	// only tests the pieces of its own cell.
+	class WindingIndex{
+	public:
+		WindingIndex(const Loop &loop);
+		WindingIndex(const std::vector<Loop> &loops);
+
+		int WindingNumber(const Point2d &pt) const;
+		bool Contains(const Point2d &pt) const { return WindingNumber(pt) != 0; }
+
+	private:
+		void Build(const std::vector<Loop> &loops);
+		float SlabMin(uint32_t row) const;
+		uint32_t Row(float y) const;
+		uint32_t Col(float x) const;
+
+		// In order around each loop, with the next and previous pieces
+		std::vector<MonotonePiece> pieces_;
+		std::vector<uint32_t> next_;
+		std::vector<uint32_t> prev_;
+		// Column each piece's bounds start in
+		std::vector<uint32_t> piece_cols_;
+		Box2d bounds_;
+		uint32_t rows_;
+		uint32_t cols_;
+		float cell_width_inv_;
+		float cell_height_inv_;
+		float cell_height_;
+		// Winding, at the bottom of each cell's row, of the pieces starting
+		// in columns right of the cell
+		std::vector<int> cell_winding_;
+		// Pieces overlapping each cell, CSR layout
+		std::vector<uint32_t> cell_offsets_;
+		std::vector<uint32_t> cell_pieces_;
+	};
+
+	// Batched queries over structure-of-arrays point coordinates. Work is
+	// split into contiguous chunks across threads; threads = 0 uses the
+	// hardware concurrency.
+	void WindingNumbers(const WindingIndex &index, const float *x, const float *y, size_t count, int *winding, unsigned threads = 0);
+	void Contains(const WindingIndex &index, const float *x, const float *y, size_t count, uint8_t *inside, unsigned threads = 0);
+}
+
+#endif
@@ -0,0 +1,313 @@
+#include "distance.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace planar {
+
+	Point2d ClosestPoint(const LineSegment &segment, const Point2d &pt) {
+		auto dir = segment.pts[1] - segment.pts[0];
+		auto len2 = (dir <= dir)[0];
+		if(len2 <= 0.f) {
+			return segment.pts[0];
+		}
+		auto t = ((pt - segment.pts[0]) <= dir)[0] / len2;
+		return segment.pts[0] + dir * std::min(std::max(t, 0.f), 1.f);
+	}
+
+	Point2d ClosestPoint(const Circle &circle, const Point2d &pt) {
+		auto dir = pt - circle.center;
+		auto len = dir.norm();
+		if(len <= 0.f) {
+			return circle.center + Point2d(std::abs(circle.radius), 0.f);
+		}
+		return circle.center + dir * (std::abs(circle.radius) / len);
+	}
+
+	Point2d ClosestPoint(const Arc &arc, const Point2d &pt) {
+		if(ArcAngleTo(arc, pt) <= std::abs(SweepAngle(arc))) {
+			return ClosestPoint(arc.circle, pt);
+		}
+		auto d0 = (arc.endpoints.pts[0] - pt).norm();
+		auto d1 = (arc.endpoints.pts[1] - pt).norm();
+		return d0 <= d1 ? arc.endpoints.pts[0] : arc.endpoints.pts[1];
+	}
+
+	Point2d ClosestPoint(const Curve &curve, const Point2d &pt) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: return ClosestPoint(*(LineSegment*)Target(curve), pt);
+			case Curve::CurveType::Circle: return ClosestPoint(*(Circle*)Target(curve), pt);
+			case Curve::CurveType::Arc: return ClosestPoint(*(Arc*)Target(curve), pt);
+		}
+		return pt;
+	}
+
+	float BoxDistance(const Box2d &box, const Point2d &pt) {
+		auto dx = std::max(std::max(box.min[0] - pt[0], pt[0] - box.max[0]), 0.f);
+		auto dy = std::max(std::max(box.min[1] - pt[1], pt[1] - box.max[1]), 0.f);
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	Point2d ClosestPoint(const Loop &loop, const Point2d &pt) {
+		auto best = pt;
+		auto best_dist = std::numeric_limits<float>::infinity();
+		for(const auto &curve : loop.curves()) {
+			if(BoxDistance(Bounds(curve), pt) >= best_dist) {
+				continue;
+			}
+			auto closest = ClosestPoint(curve, pt);
+			auto dist = (closest - pt).norm();
+			if(dist < best_dist) {
+				best = closest;
+				best_dist = dist;
+			}
+		}
+		return best;
+	}
+
+	float SignedDistance(const LineSegment &segment, const Point2d &pt) {
+		auto dist = (ClosestPoint(segment, pt) - pt).norm();
+		auto side = ((segment.pts[1] - segment.pts[0]) ^ (pt - segment.pts[0]))[0];
+		return side > 0.f ? -dist : dist;
+	}
+
+	float SignedDistance(const Circle &circle, const Point2d &pt) {
+		auto dist = (pt - circle.center).norm() - std::abs(circle.radius);
+		return std::signbit(circle.radius) ? -dist : dist;
+	}
+
+	float SignedDistance(const Arc &arc, const Point2d &pt) {
+		if(ArcAngleTo(arc, pt) <= std::abs(SweepAngle(arc))) {
+			return SignedDistance(arc.circle, pt);
+		}
+		// Beyond the arc's ends the side is taken from the end's tangent
+		auto tangents = Tangents(arc);
+		auto d0 = (arc.endpoints.pts[0] - pt).norm();
+		auto d1 = (arc.endpoints.pts[1] - pt).norm();
+		auto end = d0 <= d1 ? 0 : 1;
+		auto side = (tangents[end] ^ (pt - arc.endpoints.pts[end]))[0];
+		auto dist = std::min(d0, d1);
+		return side > 0.f ? -dist : dist;
+	}
+
+	void SignedDistances(const LineSegment &segment, const float *x, const float *y, size_t count, float *distance) {
+		auto x0 = segment.pts[0][0];
+		auto y0 = segment.pts[0][1];
+		auto dx = segment.pts[1][0] - x0;
+		auto dy = segment.pts[1][1] - y0;
+		auto len2 = dx * dx + dy * dy;
+		auto len2_inv = len2 > 0.f ? 1.f / len2 : 0.f;
+		for(size_t i=0; i < count; ++i) {
+			auto px = x[i] - x0;
+			auto py = y[i] - y0;
+			auto t = std::min(std::max((px * dx + py * dy) * len2_inv, 0.f), 1.f);
+			auto ex = px - dx * t;
+			auto ey = py - dy * t;
+			auto dist = std::sqrt(ex * ex + ey * ey);
+			distance[i] = (dx * py - dy * px) > 0.f ? -dist : dist;
+		}
+	}
+
+	void SignedDistances(const Circle &circle, const float *x, const float *y, size_t count, float *distance) {
+		auto cx = circle.center[0];
+		auto cy = circle.center[1];
+		auto r = std::abs(circle.radius);
+		auto sign = std::signbit(circle.radius) ? -1.f : 1.f;
+		for(size_t i=0; i < count; ++i) {
+			auto px = x[i] - cx;
+			auto py = y[i] - cy;
+			distance[i] = sign * (std::sqrt(px * px + py * py) - r);
+		}
+	}
+
+	void SignedDistances(const Arc &arc, const float *x, const float *y, size_t count, float *distance) {
+		for(size_t i=0; i < count; ++i) {
+			distance[i] = SignedDistance(arc, Point2d(x[i], y[i]));
+		}
+	}
+
+	DistanceIndex::DistanceIndex(const Loop &loop)
+	: winding_(loop)
+	{
+		Build(std::vector<Loop>{loop});
+	}
+
+	DistanceIndex::DistanceIndex(const std::vector<Loop> &loops)
+	: winding_(loops)
+	{
+		Build(loops);
+	}
+
+	void DistanceIndex::Build(const std::vector<Loop> &loops) {
+		auto curves = std::vector<Curve>{};
+		for(const auto &loop : loops) {
+			curves.insert(curves.end(), loop.curves().begin(), loop.curves().end());
+		}
+		auto centers = std::vector<Point2d>{};
+		auto bounds = std::vector<Box2d>{};
+		centers.reserve(curves.size());
+		bounds.reserve(curves.size());
+		for(const auto &curve : curves) {
+			bounds.push_back(Bounds(curve));
+			centers.push_back((bounds.back().min + bounds.back().max) * 0.5f);
+		}
+		bounds_ = bounds;
+
+		auto order = std::vector<uint32_t>(curves.size());
+		for(uint32_t i=0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		if(!curves.empty()) {
+			BuildNode(0, uint32_t(curves.size()), order, centers);
+		}
+
+		// Store curves in leaf order so leaves are contiguous ranges
+		curves_.reserve(curves.size());
+		ids_ = order;
+		for(size_t i=0; i < order.size(); ++i) {
+			curves_.push_back(curves[order[i]]);
+			bounds_[i] = bounds[order[i]];
+		}
+	}
+
+	uint32_t DistanceIndex::BuildNode(uint32_t begin, uint32_t end, std::vector<uint32_t> &order, const std::vector<Point2d> &centers) {
+		const uint32_t leaf_size = 4;
+		auto box = bounds_[order[begin]];
+		for(auto i=begin + 1; i < end; ++i) {
+			const auto &other = bounds_[order[i]];
+			box.min = Point2d(std::min(box.min[0], other.min[0]), std::min(box.min[1], other.min[1]));
+			box.max = Point2d(std::max(box.max[0], other.max[0]), std::max(box.max[1], other.max[1]));
+		}
+
+		auto node = uint32_t(nodes_.size());
+		nodes_.push_back(Node{box, begin, end, true});
+		if(end - begin <= leaf_size) {
+			return node;
+		}
+
+		// Median split along the longer axis
+		auto axis = (box.max[0] - box.min[0]) >= (box.max[1] - box.min[1]) ? 0 : 1;
+		auto mid = begin + (end - begin) / 2;
+		std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](uint32_t i, uint32_t j) {
+			return centers[i][axis] < centers[j][axis];
+		});
+		auto left = BuildNode(begin, mid, order, centers);
+		auto right = BuildNode(mid, end, order, centers);
+		nodes_[node] = Node{box, left, right, false};
+		return node;
+	}
+
+	bool DistanceIndex::Nearest(const Point2d &pt, float upper_bound, Point2d &closest, float &dist) const {
+		auto found = false;
+		dist = upper_bound;
+		if(nodes_.empty()) {
+			return found;
+		}
+
+		uint32_t stack[64];
+		auto top = 0;
+		stack[top++] = 0;
+		while(top > 0) {
+			const auto &node = nodes_[stack[--top]];
+			if(BoxDistance(node.bounds, pt) >= dist) {
+				continue;
+			}
+			if(node.leaf) {
+				for(auto i=node.begin; i < node.end; ++i) {
+					if(BoxDistance(bounds_[i], pt) >= dist) {
+						continue;
+					}
+					auto candidate = planar::ClosestPoint(curves_[i], pt);
+					auto candidate_dist = (candidate - pt).norm();
+					if(candidate_dist < dist) {
+						closest = candidate;
+						dist = candidate_dist;
+						found = true;
+					}
+				}
+				continue;
+			}
+			// Visit the nearer child first so it tightens the bound
+			auto near = node.begin;
+			auto far = node.end;
+			if(BoxDistance(nodes_[far].bounds, pt) < BoxDistance(nodes_[near].bounds, pt)) {
+				std::swap(near, far);
+			}
+			stack[top++] = far;
+			stack[top++] = near;
+		}
+		return found;
+	}
+
+	Point2d DistanceIndex::ClosestPoint(const Point2d &pt, float upper_bound) const {
+		auto closest = pt;
+		auto dist = upper_bound;
+		Nearest(pt, upper_bound, closest, dist);
+		return closest;
+	}
+
+	float DistanceIndex::Distance(const Point2d &pt, float upper_bound) const {
+		auto closest = pt;
+		auto dist = upper_bound;
+		Nearest(pt, upper_bound, closest, dist);
+		return dist;
+	}
+
+	float DistanceIndex::SignedDistance(const Point2d &pt, float upper_bound) const {
+		auto dist = Distance(pt, upper_bound);
+		return winding_.Contains(pt) ? -dist : dist;
+	}
+
+	void DistanceIndex::Overlapping(const std::function<bool(const Box2d&)> &overlaps, std::vector<uint32_t> &ids) const {
+		ids.clear();
+		if(nodes_.empty()) {
+			return;
+		}
+
+		uint32_t stack[64];
+		auto top = 0;
+		stack[top++] = 0;
+		while(top > 0) {
+			const auto &node = nodes_[stack[--top]];
+			if(!overlaps(node.bounds)) {
+				continue;
+			}
+			if(node.leaf) {
+				for(auto i=node.begin; i < node.end; ++i) {
+					if(overlaps(bounds_[i])) {
+						ids.push_back(ids_[i]);
+					}
+				}
+				continue;
+			}
+			stack[top++] = node.end;
+			stack[top++] = node.begin;
+		}
+	}
+
+	void SignedDistances(const DistanceIndex &index, const float *x, const float *y, size_t count, float *distance, unsigned threads) {
+		ParallelFor(count, threads, [&](size_t begin, size_t end) {
+			for(auto i=begin; i < end; ++i) {
+				distance[i] = index.SignedDistance(Point2d(x[i], y[i]));
+			}
+		});
+	}
+
+	void DistanceField(const DistanceIndex &index, const Box2d &box, uint32_t width, uint32_t height, float *field, unsigned threads) {
+		auto dx = (box.max[0] - box.min[0]) / float(width);
+		auto dy = (box.max[1] - box.min[1]) / float(height);
+		// Rows are the unit of work; a row is a few hundred queries
+		ParallelFor(height, threads, [&](size_t begin, size_t end) {
+			for(auto row=begin; row < end; ++row) {
+				auto y = box.min[1] + dy * (float(row) + 0.5f);
+				auto bound = std::numeric_limits<float>::infinity();
+				for(uint32_t col=0; col < width; ++col) {
+					auto pt = Point2d(box.min[0] + dx * (float(col) + 0.5f), y);
+					field[row * width + col] = index.SignedDistance(pt, bound);
+					// |d(p + dx) - d(p)| <= dx, padded so the bound is never hit exactly
+					bound = std::abs(field[row * width + col]) + dx * 1.01f;
+				}
+			}
+		}, 8);
+	}
+}
@@ -0,0 +1,89 @@
+#ifndef distance_hpp
+#define distance_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "containment.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace planar {
+
+	Point2d ClosestPoint(const LineSegment &segment, const Point2d &pt);
+	Point2d ClosestPoint(const Circle &circle, const Point2d &pt);
+	Point2d ClosestPoint(const Arc &arc, const Point2d &pt);
+	Point2d ClosestPoint(const Curve &curve, const Point2d &pt);
+	Point2d ClosestPoint(const Loop &loop, const Point2d &pt);
+
+	// Distance signed by side, matching the offset convention: positive to
+	// the right of a curve's direction of travel, which is outside a
+	// positive radius circle or a CCW loop. Offsetting by amt passes through
+	// the points at signed distance amt.
+	float SignedDistance(const LineSegment &segment, const Point2d &pt);
+	float SignedDistance(const Circle &circle, const Point2d &pt);
+	float SignedDistance(const Arc &arc, const Point2d &pt);
+
+	// Batched signed distances over structure-of-arrays point coordinates
+	void SignedDistances(const LineSegment &segment, const float *x, const float *y, size_t count, float *distance);
+	void SignedDistances(const Circle &circle, const float *x, const float *y, size_t count, float *distance);
+	void SignedDistances(const Arc &arc, const float *x, const float *y, size_t count, float *distance);
+
+	// Distance from pt to box, 0 inside it
+	float BoxDistance(const Box2d &box, const Point2d &pt);
+
+	// Bounding volume hierarchy over the curves of one or more loops for
+	// nearest point queries by branch and bound. The sign of the distance
+	// comes from a WindingIndex over the same loops: negative inside,
+	// positive outside.
+	class DistanceIndex{
+	public:
+		DistanceIndex(const Loop &loop);
+		DistanceIndex(const std::vector<Loop> &loops);
+
+		// Closest point on any curve. Subtrees further away than
+		// upper_bound are skipped; pass a known bound (e.g. the distance at
+		// a nearby point plus the spacing) to speed up coherent queries. If
+		// nothing is closer than the bound, the bound is returned as the
+		// distance.
+		Point2d ClosestPoint(const Point2d &pt, float upper_bound = std::numeric_limits<float>::infinity()) const;
+		float Distance(const Point2d &pt, float upper_bound = std::numeric_limits<float>::infinity()) const;
+		float SignedDistance(const Point2d &pt, float upper_bound = std::numeric_limits<float>::infinity()) const;
+		// Curves whose bounds pass overlaps, as indices counting through
+		// the loops' curves in order. Subtrees whose bounds fail are
+		// skipped, so overlaps must pass any box containing one that does.
+		void Overlapping(const std::function<bool(const Box2d&)> &overlaps, std::vector<uint32_t> &ids) const;
+
+	private:
+		struct Node{
+			Box2d bounds;
+			// Children for inner nodes, curve range for leaves
+			uint32_t begin;
+			uint32_t end;
+			bool leaf;
+		};
+
+		void Build(const std::vector<Loop> &loops);
+		bool Nearest(const Point2d &pt, float upper_bound, Point2d &closest, float &dist) const;
+		uint32_t BuildNode(uint32_t begin, uint32_t end, std::vector<uint32_t> &order, const std::vector<Point2d> &centers);
+
+		std::vector<Curve> curves_;
+		std::vector<Box2d> bounds_;
+		// Input index of each curve in leaf order
+		std::vector<uint32_t> ids_;
+		std::vector<Node> nodes_;
+		WindingIndex winding_;
+	};
+
+	// Batched signed distance queries, split across threads
+	void SignedDistances(const DistanceIndex &index, const float *x, const float *y, size_t count, float *distance, unsigned threads = 0);
+
+	// Sample the signed distance on a width x height grid of cell centers
+	// covering box into a row-major buffer. Each sample is bounded by its
+	// row neighbour's distance plus the cell spacing, which prunes most of
+	// the hierarchy.
+	void DistanceField(const DistanceIndex &index, const Box2d &box, uint32_t width, uint32_t height, float *field, unsigned threads = 0);
+}
+
+#endif
@@ -0,0 +1,281 @@
+#include "fit.hpp"
+#include "distance.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace planar {
+
+	// Fitted arcs are kept to half a turn so their endpoints never meet
+	const float kMaxFitSweep = float(M_PI);
+
+	Vec2d Direction(const Point2d &from, const Point2d &to) {
+		auto d = to - from;
+		return d / d.norm();
+	}
+
+	float TurnAngle(const Vec2d &t0, const Vec2d &t1) {
+		return std::abs(std::atan2((t0 ^ t1)[0], (t0 <= t1)[0]));
+	}
+
+	// Tangent at a of the circle through a, b and c, pointing towards b. By
+	// the tangent-chord angle it mirrors the chord to c about the chord to b.
+	Vec2d StartTangent(const Point2d &a, const Point2d &b, const Point2d &c) {
+		auto ab = Direction(a, b);
+		auto ac = Direction(a, c);
+		return ab * (2.f * (ab <= ac)[0]) - ac;
+	}
+
+	// Tangent at pt of the circle through prev, pt and next, in the
+	// direction of travel
+	Vec2d MidTangent(const Point2d &prev, const Point2d &pt, const Point2d &next) {
+		auto a = prev - pt;
+		auto c = next - pt;
+		auto d = 2.f * (a ^ c)[0];
+		auto a2 = (a <= a)[0];
+		auto c2 = (c <= c)[0];
+		auto chord = Direction(prev, next);
+		if(std::abs(d) <= 1e-6f * (a2 + c2)) {
+			return chord;
+		}
+		auto to_center = Vec2d((c[1] * a2 - a[1] * c2) / d, (a[0] * c2 - c[0] * a2) / d);
+		auto t = Vec2d(to_center[1], -to_center[0]);
+		t = t / t.norm();
+		return (t <= chord)[0] >= 0.f ? t : t * -1.f;
+	}
+
+	// The arc leaving p along tangent that ends at q, or a line when the
+	// arc is too flat to matter
+	bool TangentArc(const Point2d &p, const Vec2d &tangent, const Point2d &q, float tolerance, std::vector<Curve> &fitted) {
+		auto d = q - p;
+		auto normal = Vec2d(-tangent[1], tangent[0]);
+		auto off_tangent = (normal <= d)[0];
+		auto chord2 = (d <= d)[0];
+		if(chord2 == 0.f) {
+			return true;
+		}
+		// Center lies radius along the normal, so a negative radius is on
+		// the right and runs CW. Flat arcs have sagitta chord^2 / 8r.
+		auto radius = chord2 / (2.f * off_tangent);
+		if(off_tangent == 0.f || std::abs(radius) * tolerance > chord2 * 1e3f) {
+			if((d <= tangent)[0] <= 0.f) {
+				return false;
+			}
+			fitted.push_back(LineSegment{p, q});
+			return true;
+		}
+		auto arc = Arc{Circle{p + normal * radius, radius}, LineSegment{p, q}};
+		if(std::abs(SweepAngle(arc)) > kMaxFitSweep) {
+			return false;
+		}
+		fitted.push_back(arc);
+		return true;
+	}
+
+	// Pair of arcs from p0 along t0 to p1 along t1 meeting tangentially,
+	// with equal tangent lengths to the joint. Collapses to one arc if both
+	// lie on the same circle.
+	bool Biarc(const Point2d &p0, const Vec2d &t0, const Point2d &p1, const Vec2d &t1, float tolerance, std::vector<Curve> &fitted) {
+		auto v = p1 - p0;
+		auto t = t0 + t1;
+		auto vt = (v <= t)[0];
+		auto vv = (v <= v)[0];
+		auto denom = 2.f * (1.f - (t0 <= t1)[0]);
+		auto d = 0.f;
+		if(denom <= 1e-6f) {
+			auto vt0 = (v <= t0)[0];
+			if(vt0 <= 0.f) {
+				return false;
+			}
+			d = vv / (4.f * vt0);
+		}
+		else {
+			d = (std::sqrt(vt * vt + denom * vv) - vt) / denom;
+		}
+		if(!(d > 0.f)) {
+			return false;
+		}
+		auto q0 = p0 + t0 * d;
+		auto q1 = p1 - t1 * d;
+		auto joint = (q0 + q1) * 0.5f;
+		auto joint_tangent = q1 - q0;
+		auto joint_len = joint_tangent.norm();
+		joint_tangent = joint_len > 0.f ? joint_tangent / joint_len : t0;
+
+		auto start = fitted.size();
+		if(!TangentArc(p0, t0, joint, tolerance, fitted) || !TangentArc(joint, joint_tangent, p1, tolerance, fitted)) {
+			return false;
+		}
+		if(fitted.size() - start == 2 &&
+			TargetType(fitted[start]) == Curve::CurveType::Arc &&
+			TargetType(fitted[start + 1]) == Curve::CurveType::Arc)
+		{
+			auto arc0 = *(Arc*)Target(fitted[start]);
+			auto arc1 = *(Arc*)Target(fitted[start + 1]);
+			auto merged = Arc{arc0.circle, LineSegment{p0, p1}};
+			if(std::abs(arc0.circle.radius - arc1.circle.radius) <= tolerance &&
+				(arc0.circle.center - arc1.circle.center).norm() <= tolerance &&
+				std::abs(SweepAngle(merged)) <= kMaxFitSweep)
+			{
+				fitted.erase(fitted.begin() + start, fitted.end());
+				fitted.push_back(merged);
+			}
+		}
+		return true;
+	}
+
+	float PolylineDistance(const std::vector<Point2d> &pts, size_t i, size_t j, const Point2d &pt) {
+		auto dist = INFINITY;
+		for(auto k=i; k < j; ++k) {
+			dist = std::min(dist, std::abs(SignedDistance(LineSegment{pts[k], pts[k + 1]}, pt)));
+		}
+		return dist;
+	}
+
+	// Biarc over pts[i..j] if it stays within tolerance of the polyline:
+	// every vertex and segment midpoint is near it and it doesn't bulge
+	// away from the polyline between them
+	bool FitSpan(const std::vector<Point2d> &pts, const std::vector<Vec2d> &tangents, size_t i, size_t j, float tolerance, std::vector<Curve> &fitted) {
+		fitted.clear();
+		if(!Biarc(pts[i], tangents[i], pts[j], tangents[j], tolerance, fitted)) {
+			return false;
+		}
+		auto near = [&](const Point2d &pt) {
+			for(const auto &curve : fitted) {
+				if((ClosestPoint(curve, pt) - pt).norm() <= tolerance) {
+					return true;
+				}
+			}
+			return false;
+		};
+		for(auto k=i + 1; k <= j; ++k) {
+			if((k < j && !near(pts[k])) || !near((pts[k - 1] + pts[k]) * 0.5f)) {
+				return false;
+			}
+		}
+		for(const auto &curve : fitted) {
+			if(PolylineDistance(pts, i, j, Midpoint(curve)) > tolerance) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Fit the polyline pts with known tangents at its vertices
+	void FitRun(const std::vector<Point2d> &pts, const std::vector<Vec2d> &tangents, float tolerance, std::vector<Curve> &result) {
+		auto fitted = std::vector<Curve>{};
+		auto i = size_t(0);
+		auto last = pts.size() - 1;
+		while(i < last) {
+			if(!FitSpan(pts, tangents, i, i + 1, tolerance, fitted)) {
+				result.push_back(LineSegment{pts[i], pts[i + 1]});
+				++i;
+				continue;
+			}
+			// Gallop to bracket the furthest end that fits, then bisect
+			auto good = i + 1;
+			auto bad = last + 1;
+			for(auto step=size_t(1); good + step <= last; step *= 2) {
+				if(!FitSpan(pts, tangents, i, good + step, tolerance, fitted)) {
+					bad = good + step;
+					break;
+				}
+				good += step;
+			}
+			while(bad - good > 1) {
+				auto mid = good + (bad - good) / 2;
+				if(FitSpan(pts, tangents, i, mid, tolerance, fitted)) {
+					good = mid;
+				}
+				else {
+					bad = mid;
+				}
+			}
+			FitSpan(pts, tangents, i, good, tolerance, fitted);
+			result.insert(result.end(), fitted.begin(), fitted.end());
+			i = good;
+		}
+	}
+
+	size_t FitArcs(Loop &loop, float tolerance, float corner_angle) {
+		const auto &curves = loop.curves();
+		auto n = curves.size();
+		if(n < 3) {
+			return 0;
+		}
+		auto is_line = [&](size_t i) {
+			return TargetType(curves[i % n]) == Curve::CurveType::LineSegment;
+		};
+		auto smooth = [&](size_t prev, size_t next) {
+			return TurnAngle(Tangents(curves[prev])[1], Tangents(curves[next])[0]) <= corner_angle;
+		};
+		// A run starts wherever the joint into a line is sharp or comes from
+		// something else
+		auto starts_run = [&](size_t i) {
+			auto prev = (i + n - 1) % n;
+			return is_line(i) && (!is_line(prev) || !smooth(prev, i));
+		};
+
+		auto first = n;
+		for(size_t i=0; i < n && first == n; ++i) {
+			if(starts_run(i) || !is_line(i)) {
+				first = i;
+			}
+		}
+		// A smooth closed polyline becomes a single run
+		auto closed_run = first == n;
+		if(closed_run) {
+			first = 0;
+		}
+
+		auto result = std::vector<Curve>{};
+		auto pts = std::vector<Point2d>{};
+		auto tangents = std::vector<Vec2d>{};
+		for(size_t k=0; k < n; ) {
+			auto i = (first + k) % n;
+			if(!is_line(i)) {
+				result.push_back(curves[i]);
+				++k;
+				continue;
+			}
+			// Collect the run's vertices up to the next break
+			pts.clear();
+			pts.push_back(Endpoints(curves[i])[0]);
+			do {
+				pts.push_back(Endpoints(curves[(first + k) % n])[1]);
+				++k;
+			} while(k < n && is_line(first + k) && !starts_run((first + k) % n));
+			auto m = pts.size() - 1;
+			if(m < 2) {
+				result.push_back(curves[i]);
+				continue;
+			}
+
+			tangents.resize(pts.size());
+			for(size_t v=1; v < m; ++v) {
+				tangents[v] = MidTangent(pts[v - 1], pts[v], pts[v + 1]);
+			}
+			// Ends take the tangent of a smoothly joining neighbour, or
+			// otherwise of the circle through the nearest three vertices
+			auto prev = (i + n - 1) % n;
+			auto next = (first + k) % n;
+			if(closed_run) {
+				tangents[0] = MidTangent(pts[m - 1], pts[0], pts[1]);
+				tangents[m] = tangents[0];
+			}
+			else {
+				tangents[0] = !is_line(prev) && smooth(prev, i) ?
+					Tangents(curves[prev])[1] : StartTangent(pts[0], pts[1], pts[2]);
+				tangents[m] = !is_line(next) && smooth((next + n - 1) % n, next) ?
+					Tangents(curves[next])[0] : StartTangent(pts[m], pts[m - 1], pts[m - 2]) * -1.f;
+			}
+			FitRun(pts, tangents, tolerance, result);
+		}
+
+		auto removed = n > result.size() ? n - result.size() : 0;
+		if(removed > 0) {
+			loop = Loop(std::move(result));
+		}
+		return removed;
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef fit_hpp
+#define fit_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+
+namespace planar {
+
+	// Replace runs of LineSegments in the loop with as few Arcs (and lines,
+	// where the polyline is straight) as keep every original vertex and
+	// segment midpoint within tolerance. Each arc starts on the end tangent
+	// of the one before, so the fitted curves are tangent continuous along a
+	// run. Runs break at joints turning more than corner_angle radians,
+	// which stay sharp, and at curves that aren't LineSegments. Returns the
+	// number of curves removed.
+	size_t FitArcs(Loop &loop, float tolerance, float corner_angle=0.5f);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#include "flatten.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace planar {
+
+	uint32_t SegmentCount(float radius, float sweep, float tolerance) {
+		if(!(tolerance > 0.f)) {
+			return kMaxArcSegments;
+		}
+		auto r = std::abs(double(radius));
+		auto angle = std::abs(double(sweep));
+		if(r <= tolerance) {
+			return 1;
+		}
+		// In double so tiny tolerance / r doesn't round the step to 0
+		auto step = 2. * std::acos(1. - tolerance / r);
+		// Slack for tolerances rounded to float landing just under a whole
+		// count
+		auto count = std::ceil(angle / step - 1e-4);
+		if(!(count < double(kMaxArcSegments))) {
+			return kMaxArcSegments;
+		}
+		return std::max(uint32_t(count), 1u);
+	}
+
+	// Emit count points starting at the arc point start - center, rotating
+	// by step each time. The rotation runs in double: in float its rounding
+	// compounds over thousands of steps past any useful tolerance.
+	void AppendRotated(const Point2d &center, const Vec2d &start, double step, uint32_t count, std::vector<float> &xy) {
+		auto c = std::cos(step);
+		auto s = std::sin(step);
+		auto x = double(start[0]);
+		auto y = double(start[1]);
+		for(uint32_t i=0; i < count; ++i) {
+			xy.push_back(float(center[0] + x));
+			xy.push_back(float(center[1] + y));
+			auto next_x = x * c - y * s;
+			y = x * s + y * c;
+			x = next_x;
+		}
+	}
+
+	void Flatten(const LineSegment &segment, float, std::vector<float> &xy) {
+		xy.push_back(segment.pts[0][0]);
+		xy.push_back(segment.pts[0][1]);
+	}
+
+	void Flatten(const Circle &circle, float tolerance, std::vector<float> &xy) {
+		auto sweep = std::signbit(circle.radius) ? -2. * M_PI : 2. * M_PI;
+		auto count = std::max(SegmentCount(circle.radius, float(sweep), tolerance), 3u);
+		auto start = Vec2d(std::abs(circle.radius), 0.f);
+		AppendRotated(circle.center, start, sweep / double(count), count, xy);
+	}
+
+	void Flatten(const Arc &arc, float tolerance, std::vector<float> &xy) {
+		auto sweep = SweepAngle(arc);
+		auto count = SegmentCount(arc.circle.radius, sweep, tolerance);
+		auto start = arc.endpoints.pts[0] - arc.circle.center;
+		AppendRotated(arc.circle.center, start, double(sweep) / double(count), count, xy);
+	}
+
+	void Flatten(const Curve &curve, float tolerance, std::vector<float> &xy) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: Flatten(*(LineSegment*)Target(curve), tolerance, xy); break;
+			case Curve::CurveType::Circle: Flatten(*(Circle*)Target(curve), tolerance, xy); break;
+			case Curve::CurveType::Arc: Flatten(*(Arc*)Target(curve), tolerance, xy); break;
+		}
+	}
+
+	void Flatten(const Loop &loop, float tolerance, VertexBuffer &buffer) {
+		for(const auto &curve : loop.curves()) {
+			Flatten(curve, tolerance, buffer.xy);
+		}
+		buffer.offsets.push_back(uint32_t(buffer.vertex_count()));
+	}
+
+	void Flatten(const std::vector<Loop> &loops, float tolerance, VertexBuffer &buffer) {
+		for(const auto &loop : loops) {
+			Flatten(loop, tolerance, buffer);
+		}
+	}
+}
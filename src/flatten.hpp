@@ -0,0 +1,50 @@
+#ifndef flatten_hpp
+#define flatten_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// Polylines of any number of loops in one contiguous buffer of
+	// interleaved x, y floats. Loop i owns vertices [offsets[i],
+	// offsets[i + 1]); loops are closed implicitly, so the first vertex
+	// isn't repeated at the end.
+	struct VertexBuffer{
+		std::vector<float> xy;
+		std::vector<uint32_t> offsets{0};
+
+		size_t vertex_count() const { return xy.size() / 2; }
+		size_t loop_count() const { return offsets.size() - 1; }
+		// Keeps the allocations for reuse
+		void clear() {
+			xy.clear();
+			offsets.assign(1, 0);
+		}
+	};
+
+	// Most chords used for one arc or circle
+	const uint32_t kMaxArcSegments = 1u << 16;
+
+	// Fewest chords that keep an arc of this radius and sweep within
+	// tolerance of the true curve (the sagitta r * (1 - cos(step / 2))),
+	// capped at kMaxArcSegments. Tolerances that aren't positive get the
+	// cap.
+	uint32_t SegmentCount(float radius, float sweep, float tolerance);
+
+	// Append the flattened curve's vertices, excluding its end point, which
+	// is the start of the next curve in a loop. Points along arcs are
+	// generated by repeated rotation rather than trig per vertex.
+	void Flatten(const LineSegment &segment, float tolerance, std::vector<float> &xy);
+	void Flatten(const Circle &circle, float tolerance, std::vector<float> &xy);
+	void Flatten(const Arc &arc, float tolerance, std::vector<float> &xy);
+	void Flatten(const Curve &curve, float tolerance, std::vector<float> &xy);
+
+	// Append each loop as one polyline no further than tolerance from it
+	void Flatten(const Loop &loop, float tolerance, VertexBuffer &buffer);
+	void Flatten(const std::vector<Loop> &loops, float tolerance, VertexBuffer &buffer);
+}
+
+#endif
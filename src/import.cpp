@@ -0,0 +1,407 @@
+#include "import.hpp"
+#include "io.hpp"
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace planar {
+
+	MappedFile::MappedFile(const std::string &path) {
+		auto fd = open(path.c_str(), O_RDONLY);
+		if(fd < 0) {
+			return;
+		}
+		struct stat info;
+		if(fstat(fd, &info) == 0) {
+			size_ = size_t(info.st_size);
+			if(size_ == 0) {
+				valid_ = true;
+			}
+			else {
+				auto mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(mapped != MAP_FAILED) {
+					data_ = static_cast<const char*>(mapped);
+					valid_ = true;
+				}
+				else {
+					size_ = 0;
+				}
+			}
+		}
+		// The mapping stays valid after the descriptor is closed
+		close(fd);
+	}
+
+	MappedFile::~MappedFile() {
+		if(data_) {
+			munmap(const_cast<char*>(data_), size_);
+		}
+	}
+
+	bool IsSpace(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	// Curves of the subpath being built, dropping zero length pieces
+	struct PathBuilder{
+		std::vector<Curve> curves;
+		Point2d start = Point2d(0.f, 0.f);
+		Point2d current = Point2d(0.f, 0.f);
+
+		void MoveTo(const Point2d &pt) {
+			curves.clear();
+			start = pt;
+			current = pt;
+		}
+
+		void LineTo(const Point2d &pt) {
+			if(pt[0] != current[0] || pt[1] != current[1]) {
+				curves.push_back(LineSegment{current, pt});
+			}
+			current = pt;
+		}
+
+		void ArcTo(const Point2d &center, float radius, const Point2d &pt) {
+			if(pt[0] != current[0] || pt[1] != current[1]) {
+				curves.push_back(Arc{Circle{center, radius}, LineSegment{current, pt}});
+			}
+			current = pt;
+		}
+
+		// Subpaths that end where they started are loops even without Z
+		void Finish(bool close, std::vector<Loop> &loops) {
+			auto at_start = current[0] == start[0] && current[1] == start[1];
+			if(close && !at_start) {
+				LineTo(start);
+				at_start = true;
+			}
+			if(at_start && !curves.empty()) {
+				loops.push_back(Loop(std::move(curves)));
+			}
+			curves.clear();
+			current = start;
+		}
+	};
+
+	// Arc from p0 to p1 with center at distance h to the left of the chord
+	Point2d ChordCenter(const Point2d &p0, const Point2d &p1, float h) {
+		auto chord = p1 - p0;
+		auto len = chord.norm();
+		auto left = Vec2d(-chord[1] / len, chord[0] / len);
+		return (p0 + p1) * 0.5f + left * h;
+	}
+
+	bool SvgArcTo(PathBuilder &path, float rx, float ry, bool large_arc, bool sweep, const Point2d &pt) {
+		rx = std::abs(rx);
+		ry = std::abs(ry);
+		if(rx == 0.f || ry == 0.f) {
+			path.LineTo(pt);
+			return true;
+		}
+		if(std::abs(rx - ry) > 1e-4f * std::max(rx, ry)) {
+			return false;
+		}
+		auto half = (pt - path.current).norm() * 0.5f;
+		if(half == 0.f) {
+			return true;
+		}
+		// Radii too small to reach are scaled up, as the SVG spec asks
+		auto r = std::max(std::max(rx, ry), half);
+		auto h = std::sqrt(std::max(r * r - half * half, 0.f));
+		auto center = ChordCenter(path.current, pt, large_arc != sweep ? h : -h);
+		path.ArcTo(center, sweep ? r : -r, pt);
+		return true;
+	}
+
+	const char* SkipSvgSpace(const char *it, const char *end) {
+		while(it != end && (IsSpace(*it) || *it == ',')) {
+			++it;
+		}
+		return it;
+	}
+
+	bool ParseSvgNumbers(const char *&it, const char *end, float *values, int count) {
+		for(int i=0; i < count; ++i) {
+			it = SkipSvgSpace(it, end);
+			if(!ParseFloat(it, end, values[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Arc flags are single characters and may run into the next number
+	bool ParseSvgFlag(const char *&it, const char *end, bool &flag) {
+		it = SkipSvgSpace(it, end);
+		if(it == end || (*it != '0' && *it != '1')) {
+			return false;
+		}
+		flag = *it++ == '1';
+		return true;
+	}
+
+	bool ImportSvgPath(const char *begin, const char *end, std::vector<Loop> &loops) {
+		auto path = PathBuilder{};
+		auto command = '\0';
+		auto it = SkipSvgSpace(begin, end);
+		float v[7];
+		while(it != end) {
+			auto c = *it;
+			if((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+				command = c;
+				++it;
+			}
+			else if(command == '\0') {
+				return false;
+			}
+			auto relative = command >= 'a';
+			auto origin = relative ? path.current : Point2d(0.f, 0.f);
+			switch(command) {
+				case 'M': case 'm':
+					if(!ParseSvgNumbers(it, end, v, 2)) {
+						return false;
+					}
+					path.Finish(false, loops);
+					path.MoveTo(origin + Vec2d(v[0], v[1]));
+					// Further coordinate pairs are implicit line-tos
+					command = relative ? 'l' : 'L';
+					break;
+				case 'L': case 'l':
+					if(!ParseSvgNumbers(it, end, v, 2)) {
+						return false;
+					}
+					path.LineTo(origin + Vec2d(v[0], v[1]));
+					break;
+				case 'H': case 'h':
+					if(!ParseSvgNumbers(it, end, v, 1)) {
+						return false;
+					}
+					path.LineTo(Point2d(relative ? path.current[0] + v[0] : v[0], path.current[1]));
+					break;
+				case 'V': case 'v':
+					if(!ParseSvgNumbers(it, end, v, 1)) {
+						return false;
+					}
+					path.LineTo(Point2d(path.current[0], relative ? path.current[1] + v[0] : v[0]));
+					break;
+				case 'A': case 'a': {
+					auto large_arc = false;
+					auto sweep = false;
+					if(!ParseSvgNumbers(it, end, v, 3) ||
+						!ParseSvgFlag(it, end, large_arc) ||
+						!ParseSvgFlag(it, end, sweep) ||
+						!ParseSvgNumbers(it, end, v + 3, 2) ||
+						!SvgArcTo(path, v[0], v[1], large_arc, sweep, origin + Vec2d(v[3], v[4])))
+					{
+						return false;
+					}
+					break;
+				}
+				case 'Z': case 'z':
+					path.Finish(true, loops);
+					// Z takes no arguments, so it can't repeat implicitly
+					command = '\0';
+					break;
+				default:
+					return false;
+			}
+			it = SkipSvgSpace(it, end);
+		}
+		path.Finish(false, loops);
+		return true;
+	}
+
+	bool ImportSvgPath(const std::string &path, std::vector<Loop> &loops) {
+		return ImportSvgPath(path.data(), path.data() + path.size(), loops);
+	}
+
+	// DXF is a sequence of (group code, value) line pairs
+	struct DxfReader{
+		const char *it;
+		const char *end;
+		int code;
+		const char *value;
+		const char *value_end;
+		bool truncated;
+
+		bool ReadLine(const char *&line, const char *&line_end) {
+			if(it == end) {
+				return false;
+			}
+			auto next = static_cast<const char*>(std::memchr(it, '\n', size_t(end - it)));
+			line_end = next ? next : end;
+			line = it;
+			it = next ? next + 1 : end;
+			while(line != line_end && IsSpace(*line)) {
+				++line;
+			}
+			while(line_end != line && IsSpace(*(line_end - 1))) {
+				--line_end;
+			}
+			return true;
+		}
+
+		bool Next() {
+			const char *line = nullptr;
+			const char *line_end = nullptr;
+			if(!ReadLine(line, line_end)) {
+				return false;
+			}
+			if(!ReadLine(value, value_end)) {
+				truncated = line != line_end;
+				return false;
+			}
+			code = 0;
+			for(; line != line_end && *line >= '0' && *line <= '9'; ++line) {
+				code = code * 10 + (*line - '0');
+			}
+			return true;
+		}
+
+		bool Is(const char *name) const {
+			auto len = std::strlen(name);
+			return size_t(value_end - value) == len && std::memcmp(value, name, len) == 0;
+		}
+
+		float Float() const {
+			auto p = value;
+			auto f = 0.f;
+			return ParseFloat(p, value_end, f) ? f : 0.f;
+		}
+
+		int Int() const {
+			return int(Float());
+		}
+	};
+
+	struct DxfVertex{
+		Point2d pt;
+		float bulge;
+	};
+
+	// Bulge is tan(angle / 4) of the arc from p0 to p1, positive for CCW
+	Curve BulgeCurve(const Point2d &p0, const Point2d &p1, float bulge) {
+		if(bulge == 0.f) {
+			return LineSegment{p0, p1};
+		}
+		auto chord = (p1 - p0).norm();
+		auto h = chord * 0.25f * (1.f / bulge - bulge);
+		auto r = chord * (1.f + bulge * bulge) / (4.f * std::abs(bulge));
+		return Arc{Circle{ChordCenter(p0, p1, h), bulge > 0.f ? r : -r}, LineSegment{p0, p1}};
+	}
+
+	void FinishPolyline(std::vector<DxfVertex> &vertices, bool closed, bool flipped, std::vector<Loop> &loops) {
+		if(flipped) {
+			for(auto &vertex : vertices) {
+				vertex.pt = Point2d(-vertex.pt[0], vertex.pt[1]);
+				vertex.bulge = -vertex.bulge;
+			}
+		}
+		auto n = vertices.size();
+		if(n > 1 && vertices[0].pt[0] == vertices[n - 1].pt[0] && vertices[0].pt[1] == vertices[n - 1].pt[1]) {
+			closed = true;
+			--n;
+		}
+		if(!closed || n < 2) {
+			return;
+		}
+		auto curves = std::vector<Curve>{};
+		curves.reserve(n);
+		for(size_t i=0; i < n; ++i) {
+			const auto &p0 = vertices[i].pt;
+			const auto &p1 = vertices[i + 1 < n ? i + 1 : 0].pt;
+			if(p0[0] != p1[0] || p0[1] != p1[1]) {
+				curves.push_back(BulgeCurve(p0, p1, vertices[i].bulge));
+			}
+		}
+		if(!curves.empty()) {
+			loops.push_back(Loop(std::move(curves)));
+		}
+	}
+
+	bool ImportDxf(const char *begin, const char *end, std::vector<Loop> &loops) {
+		enum class Entity{None, Polyline, Circle};
+
+		auto reader = DxfReader{begin, end, 0, nullptr, nullptr, false};
+		auto entity = Entity::None;
+		auto vertices = std::vector<DxfVertex>{};
+		auto closed = false;
+		auto flipped = false;
+		auto x = 0.f;
+		auto radius = 0.f;
+		auto center = Point2d(0.f, 0.f);
+
+		auto finish = [&]() {
+			if(entity == Entity::Polyline) {
+				FinishPolyline(vertices, closed, flipped, loops);
+			}
+			else if(entity == Entity::Circle && radius > 0.f) {
+				auto c = flipped ? Point2d(-center[0], center[1]) : center;
+				loops.push_back(Loop(std::vector<Curve>{Circle{c, radius}}));
+			}
+			entity = Entity::None;
+		};
+
+		while(reader.Next()) {
+			if(reader.code == 0) {
+				finish();
+				if(reader.Is("LWPOLYLINE")) {
+					entity = Entity::Polyline;
+					vertices.clear();
+					closed = false;
+				}
+				else if(reader.Is("CIRCLE")) {
+					entity = Entity::Circle;
+					radius = 0.f;
+					center = Point2d(0.f, 0.f);
+				}
+				flipped = false;
+				continue;
+			}
+			if(entity == Entity::None) {
+				continue;
+			}
+			switch(reader.code) {
+				case 10:
+					x = reader.Float();
+					if(entity == Entity::Polyline) {
+						vertices.push_back(DxfVertex{Point2d(x, 0.f), 0.f});
+					}
+					break;
+				case 20:
+					if(entity == Entity::Polyline && !vertices.empty()) {
+						vertices.back().pt = Point2d(x, reader.Float());
+					}
+					else if(entity == Entity::Circle) {
+						center = Point2d(x, reader.Float());
+					}
+					break;
+				case 40:
+					if(entity == Entity::Circle) {
+						radius = reader.Float();
+					}
+					break;
+				case 42:
+					if(entity == Entity::Polyline && !vertices.empty()) {
+						vertices.back().bulge = reader.Float();
+					}
+					break;
+				case 70:
+					if(entity == Entity::Polyline) {
+						closed = (reader.Int() & 1) != 0;
+					}
+					break;
+				case 230:
+					flipped = reader.Float() < 0.f;
+					break;
+			}
+		}
+		finish();
+		// A trailing code without its value means the file was cut short
+		return !reader.truncated;
+	}
+}
@@ -0,0 +1,46 @@
+#ifndef import_hpp
+#define import_hpp
+
+#include "loop.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace planar {
+
+	// Read-only view of a whole file. The file is memory mapped, so
+	// importers can parse it in place without reading it into a string.
+	class MappedFile{
+	public:
+		MappedFile(const std::string &path);
+		~MappedFile();
+		MappedFile(const MappedFile &) = delete;
+		MappedFile& operator=(const MappedFile &) = delete;
+
+		bool valid() const { return valid_; }
+		const char* data() const { return data_; }
+		const char* end() const { return data_ + size_; }
+		size_t size() const { return size_; }
+
+	private:
+		bool valid_ = false;
+		const char *data_ = nullptr;
+		size_t size_ = 0;
+	};
+
+	// Append each closed subpath of SVG path data (the "d" attribute) to
+	// loops. Lines map to LineSegments and circular elliptical arcs to Arcs,
+	// taking y as up, so sweep-flag 1 gives a positive (CCW) radius. Open
+	// subpaths are skipped. Returns false on malformed data or curves planar
+	// can't represent exactly (Beziers, non-circular arcs); loops parsed
+	// before the error are kept.
+	bool ImportSvgPath(const char *begin, const char *end, std::vector<Loop> &loops);
+	bool ImportSvgPath(const std::string &path, std::vector<Loop> &loops);
+
+	// Append closed LWPOLYLINE and CIRCLE entities of an ASCII DXF file to
+	// loops. Polyline bulges become Arcs with a signed radius. Entities with
+	// a flipped extrusion direction are mirrored into world x.
+	bool ImportDxf(const char *begin, const char *end, std::vector<Loop> &loops);
+}
+
+#endif
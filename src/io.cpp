@@ -0,0 +1,207 @@
+#include "io.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace planar {
+
+	const char* SkipSpace(const char *it, const char *end) {
+		while(it != end && (*it == ' ' || *it == '\t' || *it == '\r' || *it == ',')) {
+			++it;
+		}
+		return it;
+	}
+
+	bool IsDelimiter(char c) {
+		return c == ' ' || c == '\t' || c == ',' || c == '\r' || c == '\n';
+	}
+
+	bool IsDigit(char c) {
+		return c >= '0' && c <= '9';
+	}
+
+	// Powers of ten that are exact in a double
+	const double kExactPowers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	bool ParseFloat(const char *&it, const char *end, float &value) {
+		auto p = it;
+		auto negative = false;
+		if(p != end && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			++p;
+		}
+
+		// Up to 19 significant digits fit in the mantissa, which is far more
+		// than a float needs; the rest only shift the exponent
+		auto mantissa = uint64_t(0);
+		auto digits = 0;
+		auto exponent = 0;
+		auto any_digits = false;
+		for(; p != end && IsDigit(*p); ++p) {
+			any_digits = true;
+			if(digits < 19) {
+				mantissa = mantissa * 10 + uint64_t(*p - '0');
+				digits += mantissa > 0 ? 1 : 0;
+			}
+			else {
+				++exponent;
+			}
+		}
+		if(p != end && *p == '.') {
+			++p;
+			for(; p != end && IsDigit(*p); ++p) {
+				any_digits = true;
+				if(digits < 19) {
+					mantissa = mantissa * 10 + uint64_t(*p - '0');
+					digits += mantissa > 0 ? 1 : 0;
+					--exponent;
+				}
+			}
+		}
+		if(!any_digits) {
+			return false;
+		}
+		if(p != end && (*p == 'e' || *p == 'E')) {
+			auto q = p + 1;
+			auto exp_negative = false;
+			if(q != end && (*q == '-' || *q == '+')) {
+				exp_negative = *q == '-';
+				++q;
+			}
+			if(q != end && IsDigit(*q)) {
+				auto exp = 0;
+				for(; q != end && IsDigit(*q); ++q) {
+					exp = std::min(exp * 10 + (*q - '0'), 10000);
+				}
+				exponent += exp_negative ? -exp : exp;
+				p = q;
+			}
+		}
+
+		// Scaling by an exact power of ten rounds once in the double, which
+		// is then rounded to float
+		auto result = double(mantissa);
+		if(mantissa != 0) {
+			while(exponent > 22) {
+				result *= 1e22;
+				exponent -= 22;
+			}
+			while(exponent < -22) {
+				result /= 1e22;
+				exponent += 22;
+			}
+			result = exponent >= 0 ? result * kExactPowers[exponent] : result / kExactPowers[-exponent];
+		}
+		value = float(negative ? -result : result);
+		it = p;
+		return true;
+	}
+
+	bool ParseFloats(const char *&it, const char *end, float *values, int count) {
+		for(int i=0; i < count; ++i) {
+			it = SkipSpace(it, end);
+			if(!ParseFloat(it, end, values[i]) || (it != end && !IsDelimiter(*it))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ParseLoop(const char *begin, const char *end, Loop &loop) {
+		auto it = SkipSpace(begin, end);
+		if(it == end || *it == '#' || *it == '\n') {
+			return false;
+		}
+
+		auto curves = std::vector<Curve>{};
+		float v[7];
+		while(true) {
+			it = SkipSpace(it, end);
+			if(it == end || *it == '\n') {
+				break;
+			}
+			auto kind = *it++;
+			switch(kind) {
+				case 'L':
+					if(!ParseFloats(it, end, v, 4)) {
+						return false;
+					}
+					curves.push_back(LineSegment{Point2d(v[0], v[1]), Point2d(v[2], v[3])});
+					break;
+				case 'C':
+					if(!ParseFloats(it, end, v, 3)) {
+						return false;
+					}
+					curves.push_back(Circle{Point2d(v[0], v[1]), v[2]});
+					break;
+				case 'A':
+					if(!ParseFloats(it, end, v, 7)) {
+						return false;
+					}
+					curves.push_back(Arc{Circle{Point2d(v[0], v[1]), v[2]}, LineSegment{Point2d(v[3], v[4]), Point2d(v[5], v[6])}});
+					break;
+				default:
+					return false;
+			}
+		}
+		if(curves.empty()) {
+			return false;
+		}
+		loop = Loop(std::move(curves));
+		return true;
+	}
+
+	bool ParseLoop(const std::string &line, Loop &loop) {
+		return ParseLoop(line.data(), line.data() + line.size(), loop);
+	}
+
+	void AppendFloats(const float *values, int count, std::string &out) {
+		char buffer[32];
+		for(int i=0; i < count; ++i) {
+			auto len = std::snprintf(buffer, sizeof(buffer), " %.9g", values[i]);
+			out.append(buffer, size_t(len));
+		}
+	}
+
+	void WriteLoop(const Loop &loop, std::string &out) {
+		auto first = true;
+		for(const auto &curve : loop.curves()) {
+			if(!first) {
+				out.push_back(' ');
+			}
+			first = false;
+			switch(TargetType(curve)) {
+				case Curve::CurveType::LineSegment: {
+					const auto &segment = *(LineSegment*)Target(curve);
+					float v[4] = {segment.pts[0][0], segment.pts[0][1], segment.pts[1][0], segment.pts[1][1]};
+					out.push_back('L');
+					AppendFloats(v, 4, out);
+					break;
+				}
+				case Curve::CurveType::Circle: {
+					const auto &circle = *(Circle*)Target(curve);
+					float v[3] = {circle.center[0], circle.center[1], circle.radius};
+					out.push_back('C');
+					AppendFloats(v, 3, out);
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					const auto &arc = *(Arc*)Target(curve);
+					float v[7] = {
+						arc.circle.center[0], arc.circle.center[1], arc.circle.radius,
+						arc.endpoints.pts[0][0], arc.endpoints.pts[0][1], arc.endpoints.pts[1][0], arc.endpoints.pts[1][1]
+					};
+					out.push_back('A');
+					AppendFloats(v, 7, out);
+					break;
+				}
+			}
+		}
+		out.push_back('\n');
+	}
+}
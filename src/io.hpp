@@ -0,0 +1,31 @@
+#ifndef io_hpp
+#define io_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <string>
+
+namespace planar {
+
+	// Plain text loop format, one loop per line as a sequence of curves:
+	//   L x0 y0 x1 y1          LineSegment
+	//   C cx cy r              Circle
+	//   A cx cy r x0 y0 x1 y1  Arc with signed radius r
+	// Blank lines and lines starting with '#' hold no loop.
+
+	// Parse one line into loop. Returns false if the line holds no loop or
+	// is malformed, in which case loop is left unchanged.
+	bool ParseLoop(const char *begin, const char *end, Loop &loop);
+	bool ParseLoop(const std::string &line, Loop &loop);
+
+	// Append the loop as one line, including the trailing newline
+	void WriteLoop(const Loop &loop, std::string &out);
+
+	// Parse a decimal float such as "-1.5e-3" in place, without copying or
+	// needing a terminator. On success it is advanced past the number.
+	// Leading whitespace is not skipped. inf/nan and hex floats aren't
+	// accepted.
+	bool ParseFloat(const char *&it, const char *end, float &value);
+}
+
+#endif
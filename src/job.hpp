@@ -0,0 +1,48 @@
+#ifndef job_hpp
+#define job_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace planar {
+
+	// Shared between a running job and whoever waits on it. Long passes
+	// check cancelled() between chunks of work and stop early, returning
+	// an empty result; they count the chunks they plan with AddWork and the
+	// ones done with Advance. Progress is the done fraction of the work
+	// known so far, so it can step back when a later stage adds work.
+	class JobControl{
+	public:
+		// on_progress is called from worker threads after each Advance
+		JobControl(std::function<void(float)> on_progress = nullptr)
+		: on_progress_(std::move(on_progress))
+		{}
+
+		void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+		bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+		void AddWork(uint64_t units) { total_.fetch_add(units, std::memory_order_relaxed); }
+		void Advance(uint64_t units = 1) {
+			done_.fetch_add(units, std::memory_order_relaxed);
+			if(on_progress_) {
+				on_progress_(progress());
+			}
+		}
+
+		float progress() const {
+			auto total = total_.load(std::memory_order_relaxed);
+			auto done = done_.load(std::memory_order_relaxed);
+			return total > 0 ? float(double(done) / double(total)) : 0.f;
+		}
+
+	private:
+		std::atomic<bool> cancelled_{false};
+		std::atomic<uint64_t> total_{0};
+		std::atomic<uint64_t> done_{0};
+		std::function<void(float)> on_progress_;
+	};
+}
+
+#endif
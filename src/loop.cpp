@@ -1,6 +1,10 @@
 #include "loop.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <typeinfo>
 #include <tuple>
+#include <utility>
 #include "range/v3/view/zip.hpp"
 #include "range/v3/algorithm/sort.hpp"
 #include "range/v3/range_traits.hpp"
@@ -11,6 +15,343 @@ Loop::Loop(const std::vector<Curve> &curves)
 : curves_(curves)
 {}
 
+Loop::Loop(std::vector<Curve> &&curves)
+: curves_(std::move(curves))
+{}
+
+Loop::Loop(const Loop &loop)
+: curves_(loop.curves_)
+, lengths_(std::atomic_load(&loop.lengths_))
+, metrics_(std::atomic_load(&loop.metrics_))
+{}
+
+// The source is left empty, with nothing cached about its old curves
+Loop::Loop(Loop &&loop) noexcept
+: curves_(std::move(loop.curves_))
+, lengths_(std::atomic_exchange(&loop.lengths_, std::shared_ptr<const std::vector<float>>()))
+, metrics_(std::atomic_exchange(&loop.metrics_, std::shared_ptr<const LoopMetrics>()))
+{
+	loop.curves_.clear();
+}
+
+Loop& Loop::operator=(const Loop &loop) {
+	curves_ = loop.curves_;
+	std::atomic_store(&lengths_, std::atomic_load(&loop.lengths_));
+	std::atomic_store(&metrics_, std::atomic_load(&loop.metrics_));
+	return *this;
+}
+
+Loop& Loop::operator=(Loop &&loop) noexcept {
+	if(&loop != this) {
+		curves_ = std::move(loop.curves_);
+		loop.curves_.clear();
+		std::atomic_store(&lengths_, std::atomic_exchange(&loop.lengths_, std::shared_ptr<const std::vector<float>>()));
+		std::atomic_store(&metrics_, std::atomic_exchange(&loop.metrics_, std::shared_ptr<const LoopMetrics>()));
+	}
+	return *this;
+}
+
+float Length(const Curve &curve) {
+	switch(TargetType(curve)) {
+		case Curve::CurveType::LineSegment: {
+			const auto &segment = *(LineSegment*)Target(curve);
+			return (segment.pts[1] - segment.pts[0]).norm();
+		}
+		case Curve::CurveType::Circle: {
+			const auto &circle = *(Circle*)Target(curve);
+			return 2.f * float(M_PI) * std::abs(circle.radius);
+		}
+		case Curve::CurveType::Arc: {
+			const auto &arc = *(Arc*)Target(curve);
+			return std::abs(SweepAngle(arc) * arc.circle.radius);
+		}
+	}
+	return 0.f;
+}
+
+// Point and unit tangent at distance t from the start of a curve. Circles
+// start from their rightmost point.
+void CurvePointAt(const Curve &curve, float t, Point2d &pt, Vec2d &tangent) {
+	switch(TargetType(curve)) {
+		case Curve::CurveType::LineSegment: {
+			const auto &segment = *(LineSegment*)Target(curve);
+			auto dir = segment.pts[1] - segment.pts[0];
+			auto len = dir.norm();
+			if(len > 0.f) {
+				dir = dir / len;
+			}
+			pt = segment.pts[0] + dir * std::min(t, len);
+			tangent = dir;
+			break;
+		}
+		case Curve::CurveType::Circle: {
+			const auto &circle = *(Circle*)Target(curve);
+			auto r = circle.radius;
+			auto theta = t / r;
+			auto c = std::cos(theta);
+			auto s = std::sin(theta);
+			pt = circle.center + Point2d(c, s) * std::abs(r);
+			tangent = std::signbit(r) ? Vec2d(s, -c) : Vec2d(-s, c);
+			break;
+		}
+		case Curve::CurveType::Arc: {
+			const auto &arc = *(Arc*)Target(curve);
+			auto r = arc.circle.radius;
+			pt = ArcPointAtAngle(arc, std::min(t / std::abs(r), std::abs(SweepAngle(arc))));
+			auto d = (pt - arc.circle.center) / r;
+			tangent = Vec2d(-d[1], d[0]);
+			break;
+		}
+	}
+}
+
+// Value in a cache slot, building it on first use. Racing threads may
+// each build one, but only the first is stored, so a returned reference
+// lives as long as the loop.
+template<typename T, typename F>
+const T& LoadOrBuild(std::shared_ptr<const T> &slot, F build) {
+	auto value = std::atomic_load(&slot);
+	if(!value) {
+		auto expected = std::shared_ptr<const T>{};
+		value = std::make_shared<const T>(build());
+		if(!std::atomic_compare_exchange_strong(&slot, &expected, value)) {
+			value = expected;
+		}
+	}
+	return *value;
+}
+
+const std::vector<float>& Loop::CumulativeLengths() const {
+	return LoadOrBuild(lengths_, [this]() {
+		auto table = std::vector<float>{};
+		table.reserve(curves_.size() + 1);
+		table.push_back(0.f);
+		auto total = 0.;
+		for(const auto &curve : curves_) {
+			total += planar::Length(curve);
+			table.push_back(float(total));
+		}
+		return table;
+	});
+}
+
+// Segments are reduced in blocks of structure-of-arrays coordinates with
+// one accumulator per lane, which the compiler turns into vector code
+const size_t kMetricLanes = 8;
+const size_t kMetricBlock = 64;
+
+struct SegmentSums{
+	float area[kMetricLanes];
+	float perimeter[kMetricLanes];
+	float min_x[kMetricLanes];
+	float min_y[kMetricLanes];
+	float max_x[kMetricLanes];
+	float max_y[kMetricLanes];
+};
+
+inline float MinLane(float a, float b) { return b < a ? b : a; }
+inline float MaxLane(float a, float b) { return b > a ? b : a; }
+
+// Coordinates are relative to an origin on the loop, which keeps the
+// shoelace products small
+void AccumulateSegments(const float *x0, const float *y0, const float *x1, const float *y1, size_t count, SegmentSums &sums) {
+	for(size_t i=0; i < count; i += kMetricLanes) {
+		for(size_t l=0; l < kMetricLanes; ++l) {
+			sums.area[l] += x0[i + l] * y1[i + l] - y0[i + l] * x1[i + l];
+			sums.min_x[l] = MinLane(sums.min_x[l], MinLane(x0[i + l], x1[i + l]));
+			sums.min_y[l] = MinLane(sums.min_y[l], MinLane(y0[i + l], y1[i + l]));
+			sums.max_x[l] = MaxLane(sums.max_x[l], MaxLane(x0[i + l], x1[i + l]));
+			sums.max_y[l] = MaxLane(sums.max_y[l], MaxLane(y0[i + l], y1[i + l]));
+		}
+	}
+	// sqrt may set errno, which keeps it out of the loop above
+	for(size_t i=0; i < count; i += kMetricLanes) {
+		for(size_t l=0; l < kMetricLanes; ++l) {
+			auto dx = x1[i + l] - x0[i + l];
+			auto dy = y1[i + l] - y0[i + l];
+			sums.perimeter[l] += std::sqrt(dx * dx + dy * dy);
+		}
+	}
+}
+
+LoopMetrics ComputeMetrics(const std::vector<Curve> &curves) {
+	auto metrics = LoopMetrics{0.f, 0.f, Box2d{Point2d(0.f, 0.f), Point2d(0.f, 0.f)}, 0};
+	if(curves.empty()) {
+		return metrics;
+	}
+
+	auto origin = Point2d(0.f, 0.f);
+	switch(TargetType(curves[0])) {
+		case Curve::CurveType::LineSegment: origin = (*(LineSegment*)Target(curves[0])).pts[0]; break;
+		case Curve::CurveType::Circle: origin = (*(Circle*)Target(curves[0])).center; break;
+		case Curve::CurveType::Arc: origin = (*(Arc*)Target(curves[0])).endpoints.pts[0]; break;
+	}
+	auto ox = origin[0];
+	auto oy = origin[1];
+
+	auto inf = std::numeric_limits<float>::infinity();
+	SegmentSums sums;
+	for(size_t l=0; l < kMetricLanes; ++l) {
+		sums.area[l] = 0.f;
+		sums.perimeter[l] = 0.f;
+		sums.min_x[l] = inf;
+		sums.min_y[l] = inf;
+		sums.max_x[l] = -inf;
+		sums.max_y[l] = -inf;
+	}
+	float x0[kMetricBlock], y0[kMetricBlock], x1[kMetricBlock], y1[kMetricBlock];
+	size_t pending = 0;
+	auto flush = [&]() {
+		// Pad to whole lanes with empty segments at the origin
+		while(pending % kMetricLanes != 0) {
+			x0[pending] = y0[pending] = x1[pending] = y1[pending] = 0.f;
+			++pending;
+		}
+		AccumulateSegments(x0, y0, x1, y1, pending, sums);
+		pending = 0;
+	};
+
+	// Arcs and circles are few next to segments and are summed directly
+	auto area = 0.f;
+	auto perimeter = 0.f;
+	auto box = Box2d{Point2d(0.f, 0.f), Point2d(0.f, 0.f)};
+	auto add_box = [&](const Box2d &b) {
+		box.min = Point2d(std::min(box.min[0], b.min[0] - ox), std::min(box.min[1], b.min[1] - oy));
+		box.max = Point2d(std::max(box.max[0], b.max[0] - ox), std::max(box.max[1], b.max[1] - oy));
+	};
+	for(const auto &curve : curves) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				x0[pending] = segment.pts[0][0] - ox;
+				y0[pending] = segment.pts[0][1] - oy;
+				x1[pending] = segment.pts[1][0] - ox;
+				y1[pending] = segment.pts[1][1] - oy;
+				if(++pending == kMetricBlock) {
+					flush();
+				}
+				break;
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				auto r = circle.radius;
+				// Areas are summed doubled, like the shoelace terms
+				area += 2.f * float(M_PI) * r * std::abs(r);
+				perimeter += 2.f * float(M_PI) * std::abs(r);
+				add_box(Bounds(circle));
+				break;
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				auto sweep = SweepAngle(arc);
+				auto r = arc.circle.radius;
+				auto p0 = arc.endpoints.pts[0] - origin;
+				auto p1 = arc.endpoints.pts[1] - origin;
+				// Chord, plus the circular segment between it and the arc
+				area += (p0 ^ p1)[0] + r * r * (sweep - std::sin(sweep));
+				perimeter += std::abs(sweep * r);
+				add_box(Bounds(arc));
+				break;
+			}
+		}
+	}
+	flush();
+
+	for(size_t l=0; l < kMetricLanes; ++l) {
+		area += sums.area[l];
+		perimeter += sums.perimeter[l];
+		box.min = Point2d(std::min(box.min[0], sums.min_x[l]), std::min(box.min[1], sums.min_y[l]));
+		box.max = Point2d(std::max(box.max[0], sums.max_x[l]), std::max(box.max[1], sums.max_y[l]));
+	}
+	metrics.area = 0.5f * area;
+	metrics.perimeter = perimeter;
+	metrics.bounds = Box2d{box.min + origin, box.max + origin};
+	metrics.orientation = metrics.area > 0.f ? 1 : (metrics.area < 0.f ? -1 : 0);
+	return metrics;
+}
+
+const LoopMetrics& Loop::Metrics() const {
+	return LoadOrBuild(metrics_, [this]() {
+		return ComputeMetrics(curves_);
+	});
+}
+
+float Loop::Wrap(float s) const {
+	auto length = Length();
+	if(length <= 0.f) {
+		return 0.f;
+	}
+	if(s < 0.f || s >= length) {
+		s = std::fmod(s, length);
+		if(s < 0.f) {
+			s += length;
+		}
+		if(s >= length) {
+			s = 0.f;
+		}
+	}
+	return s;
+}
+
+size_t Loop::CurveAt(float s) const {
+	const auto &lengths = CumulativeLengths();
+	auto it = std::upper_bound(lengths.begin() + 1, lengths.end() - 1, s);
+	return size_t(it - lengths.begin()) - 1;
+}
+
+Point2d Loop::PointAt(float s) const {
+	auto pt = Point2d(0.f, 0.f);
+	PointsAt(&s, 1, &pt);
+	return pt;
+}
+
+Vec2d Loop::TangentAt(float s) const {
+	auto pt = Point2d(0.f, 0.f);
+	auto tangent = Vec2d(0.f, 0.f);
+	PointsAt(&s, 1, &pt, &tangent);
+	return tangent;
+}
+
+void Loop::PointsAt(const float *s, size_t count, Point2d *pts, Vec2d *tangents) const {
+	if(curves_.empty()) {
+		for(size_t i=0; i < count; ++i) {
+			pts[i] = Point2d(0.f, 0.f);
+			if(tangents) {
+				tangents[i] = Vec2d(0.f, 0.f);
+			}
+		}
+		return;
+	}
+
+	const auto &lengths = CumulativeLengths();
+	auto n = curves_.size();
+	auto curve = size_t(0);
+	auto prev = 0.f;
+	auto tangent = Vec2d(0.f, 0.f);
+	for(size_t i=0; i < count; ++i) {
+		auto si = Wrap(s[i]);
+		// Search on the first sample and after wrapping around, otherwise
+		// step forward
+		if(i == 0 || si < prev) {
+			curve = CurveAt(si);
+		}
+		while(curve + 1 < n && lengths[curve + 1] <= si) {
+			++curve;
+		}
+		prev = si;
+		CurvePointAt(curves_[curve], si - lengths[curve], pts[i], tangent);
+		if(tangents) {
+			tangents[i] = tangent;
+		}
+	}
+}
+
+std::vector<Point2d> Loop::PointsAt(const std::vector<float> &s) const {
+	auto pts = std::vector<Point2d>(s.size(), Point2d(0.f, 0.f));
+	PointsAt(s.data(), s.size(), pts.data());
+	return pts;
+}
+
 struct PointIntersection{
 	uint32_t element_id;
 	float param;
@@ -44,60 +385,133 @@ void draw(const T& x, ostream& out, size_t position) {
 }
 
 
-Loop Loop::Offset(float amt) {
-	auto tangents = std::vector< std::vector<Vec2d> >{};
-	tangents.reserve(curves_.size());
-	
-	for(const auto& curve : curves_) {
-		tangents.push_back(planar::Tangents(curve));
-	}
-	
-	auto sin_theta = std::vector<float>{};
-	sin_theta.reserve(tangents.size());
-	for(int i=0; i < tangents.size()-1; ++i) {
-		const auto &t1 = tangents[i][1];
-		const auto &t2 = tangents[i + 1][0];
-		sin_theta.push_back((t2 ^ t1)[0]);
-	}
-	{
-		const auto &t1 = tangents.back()[1];
-		const auto &t2 = tangents.front()[0];
-		sin_theta.push_back((t2 ^ t1)[0]);
+// Offset curves closer than this at a joint already meet
+const float kJoinEpsilon = 1e-5f;
+
+void SetEndpoint(Curve &curve, int which, const Point2d &pt) {
+	switch(TargetType(curve)) {
+		case Curve::CurveType::LineSegment: {
+			auto segment = *(LineSegment*)Target(curve);
+			segment.pts[which] = pt;
+			curve = segment;
+			break;
+		}
+		case Curve::CurveType::Arc: {
+			auto arc = *(Arc*)Target(curve);
+			arc.endpoints.pts[which] = pt;
+			curve = arc;
+			break;
+		}
+		case Curve::CurveType::Circle:
+			break;
 	}
-	
+}
 
-	auto offset_curves = std::vector<Curve>{};
-	offset_curves.reserve(curves_.size());
+Loop Loop::Offset(float amt) const {
+	return Offset(std::vector<float>(curves_.size(), amt));
+}
 
-	
-	for(const auto& curve : curves_) {
-		offset_curves.push_back(planar::Offset(curve, amt));
+Loop Loop::Offset(const std::vector<float> &amts) const {
+	return Offset(amts.data(), amts.size());
+}
+
+Loop Loop::Offset(const float *amts, size_t count) const {
+	auto n = curves_.size();
+	auto amt_at = [&](size_t i) {
+		return i < count ? amts[i] : 0.f;
+	};
+
+	auto offset_curves = std::vector<Curve>{};
+	offset_curves.reserve(n);
+	for(size_t i=0; i < n; ++i) {
+		offset_curves.push_back(planar::Offset(curves_[i], amt_at(i)));
 	}
 
-	for(int i=curves_.size()-2; i >= 0; --i) {
-		const auto &curve = curves_[i];
-		const auto &offset_curve1 = offset_curves[i + 1];
-		const auto &offset_curve0 = offset_curves[i];
-		
-		if(sin_theta[i] < 0.f) {
-			// needs current offset's endpoint and next offsets startpoint
-			auto c = Arc{Circle{Endpoints(curve)[1], amt}, {Endpoints(offset_curve0)[1], Endpoints(offset_curve1)[0]}};
-			offset_curves.insert(offset_curves.begin() + i + 1, c);
+	// Each joint between curve i and the next either has a gap to fill or
+	// the offset curves cross and are trimmed back to where they meet
+	auto joins = std::vector<std::vector<Curve>>(n);
+	for(size_t i=0; i < n; ++i) {
+		auto j = (i + 1) % n;
+		if(TargetType(curves_[i]) == Curve::CurveType::Circle || TargetType(curves_[j]) == Curve::CurveType::Circle) {
+			continue;
+		}
+		auto vertex = Endpoints(curves_[i])[1];
+		auto end = Endpoints(offset_curves[i])[1];
+		auto start = Endpoints(offset_curves[j])[0];
+		if((end - start).norm() <= kJoinEpsilon) {
+			SetEndpoint(offset_curves[j], 0, end);
+			continue;
+		}
+
+		// Positive amounts move right of travel, so a left turn opens a gap
+		// for them and a right turn for negative ones
+		auto amt0 = amt_at(i);
+		auto amt1 = amt_at(j);
+		auto turn = (Tangents(curves_[i])[1] ^ Tangents(curves_[j])[0])[0];
+		auto opens = amt0 * amt1 > 0.f && turn * amt0 > 0.f;
+		if(opens) {
+			// Round the corner at the smaller distance and step out radially
+			// to the larger
+			auto &join = joins[i];
+			if(std::abs(amt0) <= std::abs(amt1)) {
+				auto pt = vertex + (start - vertex) * (amt0 / amt1);
+				join.push_back(Arc{Circle{vertex, amt0}, {end, pt}});
+				if((start - pt).norm() > kJoinEpsilon) {
+					join.push_back(LineSegment{pt, start});
+				}
+			}
+			else {
+				auto pt = vertex + (end - vertex) * (amt1 / amt0);
+				if((pt - end).norm() > kJoinEpsilon) {
+					join.push_back(LineSegment{end, pt});
+				}
+				join.push_back(Arc{Circle{vertex, amt1}, {pt, start}});
+			}
+			continue;
+		}
+
+		// Trim to the crossing nearest the corner. Without one close by,
+		// bridge the ends with a line.
+		auto reach = 10.f * std::max(std::abs(amt0), std::abs(amt1));
+		auto best = reach;
+		auto found = false;
+		auto meet = vertex;
+		for(const auto &pt : Intersect(offset_curves[i], offset_curves[j])) {
+			auto dist = (pt - vertex).norm();
+			if(dist <= best) {
+				best = dist;
+				meet = pt;
+				found = true;
+			}
+		}
+		if(found) {
+			SetEndpoint(offset_curves[i], 1, meet);
+			SetEndpoint(offset_curves[j], 0, meet);
+		}
+		else {
+			joins[i].push_back(LineSegment{end, start});
 		}
 	}
-	{
-		const auto &curve = curves_.back();
-		const auto &offset_curve1 = offset_curves.front();
-		const auto &offset_curve0 = offset_curves.back();
-		
-		if(sin_theta.back() < 0.f) {
-			// needs current offset's endpoint and next offsets startpoint
-			auto c = Arc{Circle{Endpoints(curve)[1], amt}, {Endpoints(offset_curve0)[1], Endpoints(offset_curve1)[0]}};
-			offset_curves.insert(offset_curves.end() - 1, c);
+
+	auto result = std::vector<Curve>{};
+	result.reserve(n * 2);
+	for(size_t i=0; i < n; ++i) {
+		result.push_back(std::move(offset_curves[i]));
+		for(auto &join : joins[i]) {
+			result.push_back(std::move(join));
 		}
 	}
-	
-	return Loop(offset_curves);
+	return Loop(std::move(result));
+}
+
+Loop Reverse(const Loop &loop) {
+	const auto &curves = loop.curves();
+	auto reversed = std::vector<Curve>{};
+	reversed.reserve(curves.size());
+	for(auto it=curves.rbegin(); it != curves.rend(); ++it) {
+		reversed.push_back(Reverse(*it));
+	}
+	return Loop(std::move(reversed));
 }
 
 }
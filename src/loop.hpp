@@ -2,21 +2,86 @@
 #define loop_hpp
 
 #include "primitives.hpp"
+#include <memory>
 #include <vector>
 
 namespace planar {
 
+	// Exact length of a curve; arcs and circles by radius times sweep
+	float Length(const Curve &curve);
+
+	// Whole-loop properties, computed together in one pass over the curves
+	struct LoopMetrics{
+		// Positive for CCW loops, including the circular segments of arcs
+		float area;
+		float perimeter;
+		Box2d bounds;
+		// +1 for CCW, -1 for CW, 0 if the loop encloses no area
+		int orientation;
+	};
+
 	class Loop{
 	public:
 		Loop(const std::vector<Curve> &curves);
+		Loop(std::vector<Curve> &&curves);
+		Loop(const Loop &loop);
+		Loop(Loop &&loop) noexcept;
+		Loop& operator=(const Loop &loop);
+		Loop& operator=(Loop &&loop) noexcept;
 
-		Loop Offset(float amt);
+		// Offset every curve by amt, to the right of its direction of travel
+		// (growing CCW loops for positive amt). Gaps at corners are filled
+		// with arcs and crossings are trimmed back to where the curves meet.
+		// The result isn't checked for global self-intersections; see
+		// OffsetEngine for that.
+		Loop Offset(float amt) const;
+		// Offset curve i by amts[i] in one pass. Where neighbours move by
+		// different amounts, the corner is rounded at the smaller distance
+		// and stepped out radially to the larger. Curves past count aren't
+		// moved.
+		Loop Offset(const float *amts, size_t count) const;
+		Loop Offset(const std::vector<float> &amts) const;
 		const std::vector<Curve>& curves() const { return curves_; }
 
+		// Area, perimeter, bounds and orientation. Cached like the length
+		// table below. Loops only change by assignment, which brings the
+		// caches of the loop assigned from.
+		const LoopMetrics& Metrics() const;
+
+		// Arc length parameterization. The table holds the distance along
+		// the loop to the start of each curve, plus the total at the end.
+		// It's built on first use, from any thread, and shared by copies.
+		const std::vector<float>& CumulativeLengths() const;
+		float Length() const { return CumulativeLengths().back(); }
+
+		// Point and unit tangent at distance s from the start of the first
+		// curve, found by binary search over the table. s wraps around the
+		// loop, so any value is valid.
+		Point2d PointAt(float s) const;
+		Vec2d TangentAt(float s) const;
+		// Many samples at non-decreasing distances. Each one continues from
+		// the curve of the last instead of searching, so a sweep along the
+		// loop is O(1) per sample. tangents may be null.
+		void PointsAt(const float *s, size_t count, Point2d *pts, Vec2d *tangents = nullptr) const;
+		std::vector<Point2d> PointsAt(const std::vector<float> &s) const;
+
 	private:
+		size_t CurveAt(float s) const;
+		float Wrap(float s) const;
+
 		std::vector<Curve> curves_;
+		// Read and written with the atomic shared_ptr functions
+		mutable std::shared_ptr<const std::vector<float>> lengths_;
+		mutable std::shared_ptr<const LoopMetrics> metrics_;
 	};
 
+	// Area enclosed by the loop, positive for CCW loops and negative for CW
+	inline float SignedArea(const Loop &loop) { return loop.Metrics().area; }
+	inline Box2d Bounds(const Loop &loop) { return loop.Metrics().bounds; }
+
+	// Same loop traversed in the opposite direction
+	Loop Reverse(const Loop &loop);
+
 }
 
 #endif
@@ -0,0 +1,431 @@
+#include "minkowski.hpp"
+#include "boolean.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace planar {
+
+	const size_t kNoSector = ~size_t(0);
+
+	// Products of floats are exact in double and the difference keeps its
+	// sign, so these are exact orientation tests on float vectors
+	inline double Cross(const Vec2d &a, const Vec2d &b) {
+		return double(a[0]) * b[1] - double(a[1]) * b[0];
+	}
+
+	inline double Dot(const Vec2d &a, const Vec2d &b) {
+		return double(a[0]) * b[0] + double(a[1]) * b[1];
+	}
+
+	// Angle turning CCW from a to b, in [0, 2pi)
+	inline double TurnAngle(const Vec2d &a, const Vec2d &b) {
+		auto angle = std::atan2(Cross(a, b), Dot(a, b));
+		return angle < 0. ? angle + 2. * M_PI : angle;
+	}
+
+	// Tool edges in CCW order, each turning strictly left from the last.
+	// Edge j runs from pts[j] to pts[j + 1]. Vertex j is extreme to the
+	// right of every direction in its sector [edges[j - 1], edges[j]),
+	// and the sectors cover every direction exactly once.
+	struct Tool{
+		std::vector<Point2d> pts;
+		std::vector<Vec2d> edges;
+
+		size_t size() const { return pts.size(); }
+		size_t Next(size_t j) const { return j + 1 < pts.size() ? j + 1 : 0; }
+		size_t Prev(size_t j) const { return j > 0 ? j - 1 : pts.size() - 1; }
+		bool InSector(const Vec2d &dir, size_t j) const {
+			const auto &a = edges[Prev(j)];
+			const auto &b = edges[j];
+			auto from_a = Cross(a, dir);
+			if(!(from_a > 0. || (from_a == 0. && Dot(a, dir) > 0.))) {
+				return false;
+			}
+			// Two-point tools have half-turn sectors, bounded by a alone
+			return Cross(a, b) > 0. ? Cross(dir, b) > 0. : true;
+		}
+		// kNoSector only for a zero or non-finite direction
+		size_t SectorOf(const Vec2d &dir) const {
+			for(size_t j=0; j < pts.size(); ++j) {
+				if(InSector(dir, j)) {
+					return j;
+				}
+			}
+			return kNoSector;
+		}
+	};
+
+	// Convex hull by monotone chain, CCW without collinear points. Turns
+	// are tested on the rounded edge vectors the sectors are built from.
+	Tool MakeTool(std::vector<Point2d> pts) {
+		std::sort(pts.begin(), pts.end(), [](const Point2d &a, const Point2d &b) {
+			return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+		});
+		pts.erase(std::unique(pts.begin(), pts.end(), [](const Point2d &a, const Point2d &b) {
+			return a[0] == b[0] && a[1] == b[1];
+		}), pts.end());
+		auto tool = Tool{};
+		auto &hull = tool.pts;
+		for(int pass=0; pass < 2 && pts.size() > 1; ++pass) {
+			auto base = hull.size();
+			for(const auto &pt : pts) {
+				while(hull.size() >= base + 2 && Cross(hull.back() - hull[hull.size() - 2], pt - hull.back()) <= 0.) {
+					hull.pop_back();
+				}
+				hull.push_back(pt);
+			}
+			// The last point starts the other chain
+			if(!hull.empty()) {
+				hull.pop_back();
+			}
+			std::reverse(pts.begin(), pts.end());
+		}
+		if(pts.size() == 1) {
+			hull = pts;
+		}
+		// The joins between the chains aren't tested above
+		for(size_t j=0; hull.size() > 2 && j < hull.size();) {
+			auto prev = hull[j] - hull[tool.Prev(j)];
+			auto next = hull[tool.Next(j)] - hull[j];
+			if(Cross(prev, next) <= 0.) {
+				hull.erase(hull.begin() + j);
+				j = 0;
+			}
+			else {
+				++j;
+			}
+		}
+		for(size_t j=0; j < hull.size(); ++j) {
+			tool.edges.push_back(hull[tool.Next(j)] - hull[j]);
+		}
+		return tool;
+	}
+
+	Curve Translate(const Curve &curve, const Vec2d &v) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				return LineSegment{segment.pts[0] + v, segment.pts[1] + v};
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				return Circle{circle.center + v, circle.radius};
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				return Arc{Circle{arc.circle.center + v, arc.circle.radius}, LineSegment{arc.endpoints.pts[0] + v, arc.endpoints.pts[1] + v}};
+			}
+		}
+		return curve;
+	}
+
+	// Walks the loop carrying the tool vertex j whose sector holds the
+	// current tangent direction. ok() turns false if a tangent can't be
+	// placed in any sector, which only non-finite input can cause.
+	class Convolver{
+	public:
+		Convolver(const Tool &tool, std::vector<Curve> &out)
+		: tool_(tool)
+		, out_(out)
+		, j_(0)
+		, ok_(true)
+		{}
+
+		bool ok() const { return ok_; }
+
+		void Start(const Vec2d &tangent) {
+			j_ = tool_.SectorOf(tangent);
+			ok_ = j_ != kNoSector;
+		}
+
+		// Turn by the shorter way from tangent from to tangent to at pt.
+		// Without a turn, j can still be a sector off where an arc ended
+		// right by a sector boundary.
+		void Corner(const Point2d &pt, const Vec2d &from, const Vec2d &to) {
+			if(!ok_) {
+				return;
+			}
+			auto turn = Cross(from, to);
+			auto left = turn == 0. && Dot(from, to) > 0. ?
+				!tool_.InSector(to, tool_.Prev(j_)) :
+				turn >= 0.;
+			for(size_t steps=0; !tool_.InSector(to, j_); ++steps) {
+				if(steps == tool_.size()) {
+					ok_ = false;
+					return;
+				}
+				Step(pt, left);
+			}
+		}
+
+		void Line(const LineSegment &segment) {
+			out_.push_back(Translate(segment, tool_.pts[j_]));
+		}
+
+		// Arc sweeping sweep (unsigned) from start tangent tangent. It's cut
+		// where its tangent meets a tool edge direction.
+		void Turn(const Arc &arc, double sweep, Vec2d tangent) {
+			if(!ok_) {
+				return;
+			}
+			auto left = !std::signbit(arc.circle.radius);
+			auto r = std::abs(arc.circle.radius);
+			auto travelled = 0.;
+			auto start = arc.endpoints.pts[0];
+			for(size_t steps=0; steps <= 2 * tool_.size() + 1; ++steps) {
+				const auto &boundary = left ? tool_.edges[j_] : tool_.edges[tool_.Prev(j_)];
+				auto angle = left ? TurnAngle(tangent, boundary) : TurnAngle(boundary, tangent);
+				if(travelled + angle >= sweep) {
+					Piece(arc, start, arc.endpoints.pts[1]);
+					return;
+				}
+				travelled += angle;
+				// Radial direction where the tangent is boundary
+				auto radial = left ? Vec2d(boundary[1], -boundary[0]) : Vec2d(-boundary[1], boundary[0]);
+				auto pt = arc.circle.center + radial * (r / std::sqrt((radial <= radial)[0]));
+				Piece(arc, start, pt);
+				Step(pt, left);
+				start = pt;
+				tangent = boundary;
+			}
+			ok_ = false;
+		}
+
+	private:
+		// Insert the tool edge crossed turning left or right at pt
+		void Step(const Point2d &pt, bool left) {
+			auto next = left ? tool_.Next(j_) : tool_.Prev(j_);
+			out_.push_back(LineSegment{pt + tool_.pts[j_], pt + tool_.pts[next]});
+			j_ = next;
+		}
+
+		void Piece(const Arc &arc, const Point2d &start, const Point2d &end) {
+			auto chord = end - start;
+			if((chord <= chord)[0] == 0.f) {
+				return;
+			}
+			const auto &v = tool_.pts[j_];
+			out_.push_back(Arc{Circle{arc.circle.center + v, arc.circle.radius}, LineSegment{start + v, end + v}});
+		}
+
+		const Tool &tool_;
+		std::vector<Curve> &out_;
+		size_t j_;
+		bool ok_;
+	};
+
+	// Tangent directions at the ends of a curve, not normalized
+	void Tangents(const Curve &curve, Vec2d &start, Vec2d &end) {
+		auto perp = [](const Vec2d &radial, float radius) {
+			return std::signbit(radius) ? Vec2d(radial[1], -radial[0]) : Vec2d(-radial[1], radial[0]);
+		};
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: {
+				const auto &segment = *(LineSegment*)Target(curve);
+				start = end = segment.pts[1] - segment.pts[0];
+				break;
+			}
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				start = end = perp(Vec2d(std::abs(circle.radius), 0.f), circle.radius);
+				break;
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				start = perp(arc.endpoints.pts[0] - arc.circle.center, arc.circle.radius);
+				end = perp(arc.endpoints.pts[1] - arc.circle.center, arc.circle.radius);
+				break;
+			}
+		}
+	}
+
+	Point2d StartPoint(const Curve &curve) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: return (*(LineSegment*)Target(curve)).pts[0];
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				return circle.center + Point2d(std::abs(circle.radius), 0.f);
+			}
+			case Curve::CurveType::Arc: return (*(Arc*)Target(curve)).endpoints.pts[0];
+		}
+		return Point2d(0.f, 0.f);
+	}
+
+	// False if the walk failed, leaving out as it was
+	bool Convolve(const Loop &loop, const Tool &tool, std::vector<Curve> &out) {
+		if(tool.size() == 0) {
+			return true;
+		}
+		if(tool.size() == 1) {
+			for(const auto &curve : loop.curves()) {
+				out.push_back(Translate(curve, tool.pts[0]));
+			}
+			return true;
+		}
+
+		// Curves without a direction (points) add nothing
+		auto curves = std::vector<const Curve*>{};
+		for(const auto &curve : loop.curves()) {
+			auto start = Vec2d(0.f, 0.f);
+			auto end = Vec2d(0.f, 0.f);
+			Tangents(curve, start, end);
+			if((start <= start)[0] > 0.f) {
+				curves.push_back(&curve);
+			}
+		}
+		if(curves.empty()) {
+			return true;
+		}
+
+		auto size = out.size();
+		auto convolver = Convolver(tool, out);
+		auto first = Vec2d(0.f, 0.f);
+		auto start = Vec2d(0.f, 0.f);
+		auto end = Vec2d(0.f, 0.f);
+		Tangents(*curves.front(), first, end);
+		convolver.Start(first);
+		for(size_t i=0; i < curves.size() && convolver.ok(); ++i) {
+			const auto &curve = *curves[i];
+			auto from = end;
+			Tangents(curve, start, end);
+			if(i > 0) {
+				convolver.Corner(StartPoint(curve), from, start);
+			}
+			switch(TargetType(curve)) {
+				case Curve::CurveType::LineSegment:
+					convolver.Line(*(LineSegment*)Target(curve));
+					break;
+				case Curve::CurveType::Circle: {
+					const auto &circle = *(Circle*)Target(curve);
+					auto pt = StartPoint(curve);
+					convolver.Turn(Arc{circle, LineSegment{pt, pt}}, 2. * M_PI, start);
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					const auto &arc = *(Arc*)Target(curve);
+					convolver.Turn(arc, std::abs(SweepAngle(arc)), start);
+					break;
+				}
+			}
+		}
+		// Closing corner, which also brings j back to where it started
+		convolver.Corner(StartPoint(*curves.front()), end, first);
+		if(!convolver.ok()) {
+			out.erase(out.begin() + size, out.end());
+			return false;
+		}
+		return true;
+	}
+
+	// Furthest reach of a curve along direction
+	float Extent(const Curve &curve, const Vec2d &direction) {
+		auto extent = -std::numeric_limits<float>::infinity();
+		for(const auto &pt : Endpoints(curve)) {
+			extent = std::max(extent, (pt <= direction)[0]);
+		}
+		auto length = std::sqrt((direction <= direction)[0]);
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment: break;
+			case Curve::CurveType::Circle: {
+				const auto &circle = *(Circle*)Target(curve);
+				extent = (circle.center <= direction)[0] + std::abs(circle.radius) * length;
+				break;
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				auto r = std::abs(arc.circle.radius);
+				auto pt = arc.circle.center + direction * (r / length);
+				if(ArcAngleTo(arc, pt) <= std::abs(SweepAngle(arc))) {
+					extent = std::max(extent, (arc.circle.center <= direction)[0] + r * length);
+				}
+				break;
+			}
+		}
+		return extent;
+	}
+
+	// Points x where x - tool covers the whole of a hole. These wind zero
+	// times around the convolution (the tool overlaps the region in an
+	// annulus) but are in the sum. It's the tool shrunk along each edge
+	// normal by the hole's extent the other way, built by clipping the tool
+	// placed at a point of the hole.
+	void CoveredHole(const Loop &hole, const Tool &tool, std::vector<Loop> &out) {
+		if(tool.size() < 3 || hole.curves().empty()) {
+			return;
+		}
+		auto origin = StartPoint(hole.curves().front());
+		auto poly = std::vector<Point2d>{};
+		for(const auto &pt : tool.pts) {
+			poly.push_back(origin + pt);
+		}
+		auto clipped = std::vector<Point2d>{};
+		for(size_t j=0; j < tool.size() && poly.size() >= 3; ++j) {
+			auto edge = tool.pts[tool.Next(j)] - tool.pts[j];
+			auto normal = Vec2d(edge[1], -edge[0]);
+			auto reach = -std::numeric_limits<float>::infinity();
+			for(const auto &curve : hole.curves()) {
+				reach = std::max(reach, Extent(curve, normal * -1.f));
+			}
+			auto bound = (tool.pts[j] <= normal)[0] - reach;
+			clipped.clear();
+			for(size_t i=0; i < poly.size(); ++i) {
+				const auto &a = poly[i];
+				const auto &b = poly[(i + 1) % poly.size()];
+				auto da = (a <= normal)[0] - bound;
+				auto db = (b <= normal)[0] - bound;
+				if(da <= 0.f) {
+					clipped.push_back(a);
+				}
+				if((da < 0.f) != (db < 0.f) && da != db) {
+					clipped.push_back(a + (b - a) * (da / (da - db)));
+				}
+			}
+			poly.swap(clipped);
+		}
+		auto curves = std::vector<Curve>{};
+		for(size_t i=0; i < poly.size(); ++i) {
+			const auto &a = poly[i];
+			const auto &b = poly[(i + 1) % poly.size()];
+			auto chord = b - a;
+			if((chord <= chord)[0] > 0.f) {
+				curves.push_back(LineSegment{a, b});
+			}
+		}
+		if(curves.size() >= 3) {
+			auto loop = Loop(std::move(curves));
+			if(SignedArea(loop) > 0.f) {
+				out.push_back(std::move(loop));
+			}
+		}
+	}
+
+	std::vector<Curve> Convolution(const Loop &loop, const std::vector<Point2d> &tool) {
+		auto out = std::vector<Curve>{};
+		Convolve(loop, MakeTool(tool), out);
+		return out;
+	}
+
+	std::vector<Loop> MinkowskiSum(const Loop &loop, const std::vector<Point2d> &tool) {
+		return MinkowskiSum(std::vector<Loop>{loop}, tool);
+	}
+
+	std::vector<Loop> MinkowskiSum(const std::vector<Loop> &loops, const std::vector<Point2d> &tool) {
+		auto convex = MakeTool(tool);
+		auto convolutions = std::vector<Loop>{};
+		convolutions.reserve(loops.size());
+		for(const auto &loop : loops) {
+			auto curves = std::vector<Curve>{};
+			if(!Convolve(loop, convex, curves)) {
+				return std::vector<Loop>{};
+			}
+			if(!curves.empty()) {
+				convolutions.push_back(Loop(std::move(curves)));
+			}
+			if(SignedArea(loop) < 0.f) {
+				CoveredHole(loop, convex, convolutions);
+			}
+		}
+		return Union(convolutions);
+	}
+}
@@ -0,0 +1,32 @@
+#ifndef minkowski_hpp
+#define minkowski_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <vector>
+
+namespace planar {
+
+	// Convolution of a loop with a convex tool, the convex hull of tool
+	// (in any order). Travelling the loop, each curve is translated by the
+	// tool vertex that is extreme to its right; wherever the loop's
+	// tangent turns past the direction of a tool edge, at a corner or
+	// along an arc, that edge is inserted (backwards when turning right).
+	// Tool edges and loop curves are merged by direction in one pass, so
+	// the result has O(n + m) curves for n curves turning O(1) times
+	// around. Arcs stay arcs. Tangents are placed among the tool edges by
+	// exact orientation tests; the result is empty if one can't be placed,
+	// which only non-finite input causes.
+	std::vector<Curve> Convolution(const Loop &loop, const std::vector<Point2d> &tool);
+
+	// Minkowski sum of a region (loops under the Boolean convention: CCW
+	// outlines, CW holes) with a convex tool: its convolutions trimmed by
+	// the non-zero winding rule (see Union). Holes shrink by the tool and
+	// close once it no longer fits; where the tool spans a whole hole the
+	// convolutions wind zero times, so that part is added for each hole.
+	// Empty if a convolution fails.
+	std::vector<Loop> MinkowskiSum(const Loop &loop, const std::vector<Point2d> &tool);
+	std::vector<Loop> MinkowskiSum(const std::vector<Loop> &loops, const std::vector<Point2d> &tool);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "offset.hpp"
+#include "boolean.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace planar {
+
+	// Fragments trimmed between cancellation checks
+	const size_t kTrimBlock = 256;
+
+	OffsetEngine::OffsetEngine(const Loop &loop, unsigned threads, JobControl *control)
+	: loops_{loop}
+	, clearance_(loops_, threads, control)
+	{}
+
+	OffsetEngine::OffsetEngine(const std::vector<Loop> &loops, unsigned threads, JobControl *control)
+	: loops_(loops)
+	, clearance_(loops_, threads, control)
+	{}
+
+	std::vector<Loop> OffsetEngine::Offset(float amt, unsigned threads, JobControl *control) const {
+		if(amt == 0.f) {
+			return loops_;
+		}
+
+		auto count = clearance_.Reach(amt);
+		auto blocks = (count + kTrimBlock - 1) / kTrimBlock;
+		if(control) {
+			control->AddWork(blocks);
+		}
+		auto trimmed = std::vector<std::vector<ClearanceIndex::Span>>(blocks);
+		ParallelFor(blocks, threads, [&](size_t begin, size_t end) {
+			for(auto block=begin; block < end; ++block) {
+				if(control && control->cancelled()) {
+					return;
+				}
+				clearance_.Trim(amt, block * kTrimBlock, std::min(count, (block + 1) * kTrimBlock), trimmed[block]);
+				if(control) {
+					control->Advance();
+				}
+			}
+		}, 1);
+		if(control && control->cancelled()) {
+			return {};
+		}
+
+		auto spans = std::vector<ClearanceIndex::Span>{};
+		for(const auto &block : trimmed) {
+			spans.insert(spans.end(), block.begin(), block.end());
+		}
+		return StitchLoops(clearance_.Curves(amt, std::move(spans)), clearance_.tolerance());
+	}
+
+	std::vector<std::vector<Loop>> OffsetEngine::Offsets(const std::vector<float> &amts) const {
+		auto offsets = std::vector<std::vector<Loop>>{};
+		offsets.reserve(amts.size());
+		for(auto amt : amts) {
+			offsets.push_back(Offset(amt));
+		}
+		return offsets;
+	}
+}
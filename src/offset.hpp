@@ -0,0 +1,40 @@
+#ifndef offset_hpp
+#define offset_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "clearance.hpp"
+#include "job.hpp"
+#include <vector>
+
+namespace planar {
+
+	// Extracts trimmed offsets of a fixed set of loops at any distance
+	// from a clearance index over them (see clearance.hpp), built once.
+	// An extraction offsets and trims only the fragments whose clearance
+	// reaches the distance, then stitches the pieces into loops, so the
+	// passes of a pocket cost time near linear in what they output. Loops
+	// that split apart or vanish come out with the right topology.
+	class OffsetEngine{
+	public:
+		// The index is built across threads, reporting to control if given.
+		// A build cancelled partway leaves nothing to extract.
+		OffsetEngine(const Loop &loop, unsigned threads = 1, JobControl *control = nullptr);
+		OffsetEngine(const std::vector<Loop> &loops, unsigned threads = 1, JobControl *control = nullptr);
+
+		// Positive amt grows CCW loops, like Loop::Offset. Fragments are
+		// trimmed in blocks across threads. With a control, blocks report
+		// progress and a cancelled extraction returns no loops.
+		std::vector<Loop> Offset(float amt, unsigned threads = 1, JobControl *control = nullptr) const;
+		// One extraction per distance, e.g. the passes of a pocket
+		std::vector<std::vector<Loop>> Offsets(const std::vector<float> &amts) const;
+
+		const std::vector<Loop>& loops() const { return loops_; }
+
+	private:
+		std::vector<Loop> loops_;
+		ClearanceIndex clearance_;
+	};
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef parallel_hpp
+#define parallel_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace planar {
+
+	// Worker count for a requested thread count, where 0 means one per
+	// hardware thread
+	inline unsigned ThreadCount(unsigned threads) {
+		if(threads == 0) {
+			threads = std::thread::hardware_concurrency();
+		}
+		return std::max(threads, 1u);
+	}
+
+	// Call f(begin, end) over contiguous chunks of [0, count), one chunk per
+	// thread. The calling thread processes the last chunk. Counts below
+	// min_chunk per thread are not worth a thread and run inline.
+	template<typename F>
+	void ParallelFor(size_t count, unsigned threads, F f, size_t min_chunk = 1024) {
+		auto workers = std::min<size_t>(ThreadCount(threads), std::max<size_t>(count / min_chunk, 1));
+		if(workers <= 1) {
+			f(size_t(0), count);
+			return;
+		}
+
+		auto chunk = (count + workers - 1) / workers;
+		auto pool = std::vector<std::thread>{};
+		pool.reserve(workers - 1);
+		for(size_t i=0; i < workers - 1; ++i) {
+			auto begin = i * chunk;
+			auto end = std::min(begin + chunk, count);
+			pool.emplace_back([&f, begin, end]() { f(begin, end); });
+		}
+		f((workers - 1) * chunk, count);
+		for(auto &thread : pool) {
+			thread.join();
+		}
+	}
+}
+
+#endif
@@ -1,7 +1,9 @@
 #include "primitives.hpp"
 #include "vsr/space/vsr_cga2D_op.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <utility>
 
 namespace planar {
 //	Curve Offset(const Curve& x, float offset)
@@ -84,6 +86,34 @@ namespace planar {
 		return Arc{circle, endpoints};
 	}
 
+	float SweepAngle(const Arc &arc) {
+		auto dir0 = arc.endpoints.pts[0] - arc.circle.center;
+		auto dir1 = arc.endpoints.pts[1] - arc.circle.center;
+		auto theta = std::atan2((dir0 ^ dir1)[0], (dir0 <= dir1)[0]);
+		if(std::signbit(arc.circle.radius)) {
+			return theta < 0.f ? theta : theta - 2.f * float(M_PI);
+		}
+		return theta > 0.f ? theta : theta + 2.f * float(M_PI);
+	}
+
+	float ArcAngleTo(const Arc &arc, const Point2d &pt) {
+		auto dir0 = arc.endpoints.pts[0] - arc.circle.center;
+		auto dir = pt - arc.circle.center;
+		auto theta = std::atan2((dir0 ^ dir)[0], (dir0 <= dir)[0]);
+		if(std::signbit(arc.circle.radius)) {
+			theta = -theta;
+		}
+		return theta < 0.f ? theta + 2.f * float(M_PI) : theta;
+	}
+
+	Point2d ArcPointAtAngle(const Arc &arc, float angle) {
+		auto dir0 = arc.endpoints.pts[0] - arc.circle.center;
+		auto theta = std::signbit(arc.circle.radius) ? -angle : angle;
+		auto c = std::cos(theta);
+		auto s = std::sin(theta);
+		return arc.circle.center + Point2d(dir0[0] * c - dir0[1] * s, dir0[0] * s + dir0[1] * c);
+	}
+
 	LineSegment Offset(const LineSegment &segment, float amt) {
 		// Normal to line segment where amt > 0 is a translation
 		// in the direction of CCW(Dir(segment)) and amt < 0 is
@@ -111,9 +141,11 @@ namespace planar {
 			return Arc{circle, LineSegment{circle.center, circle.center}};
 		}
 		
-		auto dir0 = Normalize(arc.endpoints.pts[0] - arc.circle.center);
-		auto dir1 = Normalize(arc.endpoints.pts[1] - arc.circle.center);
-		auto endpoints = LineSegment{arc.endpoints.pts[0] + dir0, arc.endpoints.pts[0] + dir1};
+		// Endpoints move radially with the change in radius
+		auto scale = circle.radius / arc.circle.radius;
+		auto dir0 = arc.endpoints.pts[0] - arc.circle.center;
+		auto dir1 = arc.endpoints.pts[1] - arc.circle.center;
+		auto endpoints = LineSegment{arc.circle.center + dir0 * scale, arc.circle.center + dir1 * scale};
 		return Arc{circle, endpoints};
 	}
 
@@ -146,6 +178,132 @@ namespace planar {
 	}
 
 
+	Point2d Midpoint(const LineSegment &segment) {
+		return (segment.pts[0] + segment.pts[1]) * 0.5f;
+	}
+
+	Point2d Midpoint(const Circle &circle) {
+		return circle.center + Point2d(std::abs(circle.radius), 0.f);
+	}
+
+	Point2d Midpoint(const Arc &arc) {
+		return ArcPointAtAngle(arc, std::abs(SweepAngle(arc)) * 0.5f);
+	}
+
+	Box2d Bounds(const LineSegment &segment) {
+		return Box2d{
+			Point2d(std::min(segment.pts[0][0], segment.pts[1][0]), std::min(segment.pts[0][1], segment.pts[1][1])),
+			Point2d(std::max(segment.pts[0][0], segment.pts[1][0]), std::max(segment.pts[0][1], segment.pts[1][1]))
+		};
+	}
+
+	Box2d Bounds(const Circle &circle) {
+		auto r = std::abs(circle.radius);
+		return Box2d{circle.center - Point2d(r, r), circle.center + Point2d(r, r)};
+	}
+
+	Box2d Bounds(const Arc &arc) {
+		auto box = Bounds(arc.endpoints);
+		auto sweep = std::abs(SweepAngle(arc));
+		auto r = std::abs(arc.circle.radius);
+		// Extend by each axis extreme the arc passes through
+		auto extremes = std::array<Point2d, 4>{{
+			Point2d(r, 0.f), Point2d(0.f, r), Point2d(-r, 0.f), Point2d(0.f, -r)
+		}};
+		for(const auto &extreme : extremes) {
+			auto pt = arc.circle.center + extreme;
+			if(ArcAngleTo(arc, pt) <= sweep) {
+				box.min = Point2d(std::min(box.min[0], pt[0]), std::min(box.min[1], pt[1]));
+				box.max = Point2d(std::max(box.max[0], pt[0]), std::max(box.max[1], pt[1]));
+			}
+		}
+		return box;
+	}
+
+	LineSegment Reverse(const LineSegment &segment) {
+		return LineSegment{segment.pts[1], segment.pts[0]};
+	}
+
+	Circle Reverse(const Circle &circle) {
+		return Circle{circle.center, -circle.radius};
+	}
+
+	Arc Reverse(const Arc &arc) {
+		return Arc{Reverse(arc.circle), Reverse(arc.endpoints)};
+	}
+
+	// Parameters closer than this to a curve's ends don't split it
+	const float kSplitEpsilon = 1e-5f;
+
+	std::vector<Curve> Split(const LineSegment &segment, const std::vector<Point2d> &pts) {
+		auto dir = segment.pts[1] - segment.pts[0];
+		auto len2 = (dir <= dir)[0];
+		auto params = std::vector<std::pair<float, Point2d>>{};
+		params.reserve(pts.size());
+		for(const auto &pt : pts) {
+			auto t = ((pt - segment.pts[0]) <= dir)[0] / len2;
+			if(t > kSplitEpsilon && t < 1.f - kSplitEpsilon) {
+				params.emplace_back(t, pt);
+			}
+		}
+		std::sort(params.begin(), params.end(), [](const std::pair<float, Point2d> &a, const std::pair<float, Point2d> &b) {
+			return a.first < b.first;
+		});
+
+		auto curves = std::vector<Curve>{};
+		curves.reserve(params.size() + 1);
+		auto start = segment.pts[0];
+		auto prev_t = 0.f;
+		for(const auto &param : params) {
+			if(param.first - prev_t <= kSplitEpsilon) {
+				continue;
+			}
+			curves.push_back(LineSegment{start, param.second});
+			start = param.second;
+			prev_t = param.first;
+		}
+		curves.push_back(LineSegment{start, segment.pts[1]});
+		return curves;
+	}
+
+	std::vector<Curve> Split(const Circle &circle, const std::vector<Point2d> &pts) {
+		if(pts.empty()) {
+			return {circle};
+		}
+		// Treat the circle as a full turn starting and ending at the first point
+		return Split(Arc{circle, LineSegment{pts.front(), pts.front()}}, pts);
+	}
+
+	std::vector<Curve> Split(const Arc &arc, const std::vector<Point2d> &pts) {
+		auto sweep = std::abs(SweepAngle(arc));
+		auto params = std::vector<std::pair<float, Point2d>>{};
+		params.reserve(pts.size());
+		for(const auto &pt : pts) {
+			auto angle = ArcAngleTo(arc, pt);
+			if(angle > kSplitEpsilon && angle < sweep - kSplitEpsilon) {
+				params.emplace_back(angle, pt);
+			}
+		}
+		std::sort(params.begin(), params.end(), [](const std::pair<float, Point2d> &a, const std::pair<float, Point2d> &b) {
+			return a.first < b.first;
+		});
+
+		auto curves = std::vector<Curve>{};
+		curves.reserve(params.size() + 1);
+		auto start = arc.endpoints.pts[0];
+		auto prev_angle = 0.f;
+		for(const auto &param : params) {
+			if(param.first - prev_angle <= kSplitEpsilon) {
+				continue;
+			}
+			curves.push_back(Arc{arc.circle, LineSegment{start, param.second}});
+			start = param.second;
+			prev_angle = param.first;
+		}
+		curves.push_back(Arc{arc.circle, LineSegment{start, arc.endpoints.pts[1]}});
+		return curves;
+	}
+
 	std::vector<vsr::cga2D::Vec> Intersect(const LineSegment &segment1, const LineSegment &segment2) {
 		auto L1 = ToLine(segment1);
 		auto L2 = ToLine(segment2);
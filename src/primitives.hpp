@@ -24,8 +24,23 @@ namespace planar {
 		LineSegment endpoints;
 	};
 
+	struct Box2d{
+		Point2d min;
+		Point2d max;
+	};
+
 	Arc ArcWithDirectionAndAngle(const Point2d &center, float radius, const vsr::cga2D::Vec &direction, float angle);
 
+	// Signed angle swept from the start to the end of the arc. Positive
+	// radius arcs run CCW and sweep (0, 2pi], negative radius arcs run CW
+	// and sweep [-2pi, 0). Coincident endpoints are a full turn.
+	float SweepAngle(const Arc &arc);
+	// Unsigned angle travelled along the arc's direction from its start
+	// point to the direction of pt, in [0, 2pi).
+	float ArcAngleTo(const Arc &arc, const Point2d &pt);
+	// Point reached after travelling angle (unsigned) from the arc's start
+	Point2d ArcPointAtAngle(const Arc &arc, float angle);
+
 	LineSegment Offset(const LineSegment &segment, float amt);
 	Circle Offset(const Circle &circle, float amt);
 	Arc Offset(const Arc &arc, float amt);
@@ -38,6 +53,21 @@ namespace planar {
 	std::vector<Vec2d> Endpoints(const Circle &circle);
 	std::vector<Vec2d> Endpoints(const Arc &arc);
 
+	// Point halfway along the curve. A circle has no start, so its point at
+	// angle 0 is used.
+	Point2d Midpoint(const LineSegment &segment);
+	Point2d Midpoint(const Circle &circle);
+	Point2d Midpoint(const Arc &arc);
+
+	Box2d Bounds(const LineSegment &segment);
+	Box2d Bounds(const Circle &circle);
+	Box2d Bounds(const Arc &arc);
+
+	// Same geometry traversed in the opposite direction
+	LineSegment Reverse(const LineSegment &segment);
+	Circle Reverse(const Circle &circle);
+	Arc Reverse(const Arc &arc);
+
 	std::vector<Point2d> Intersect(const LineSegment &segment1, const LineSegment &segment2);
 	std::vector<Point2d> Intersect(const Circle &circle1, const Circle &circle2);
 	std::vector<Point2d> Intersect(const Arc &arc1, const Arc &arc2);
@@ -91,6 +121,22 @@ namespace planar {
 			return x.self_->TargetType_();
 		}
 		
+		friend Point2d Midpoint(const Curve& x) {
+			return x.self_->Midpoint_();
+		}
+		
+		friend Box2d Bounds(const Curve& x) {
+			return x.self_->Bounds_();
+		}
+		
+		friend Curve Reverse(const Curve& x) {
+			return x.self_->Reverse_();
+		}
+		
+		friend std::vector<Curve> Split(const Curve& x, const std::vector<Point2d> &pts) {
+			return x.self_->Split_(pts);
+		}
+		
 		
 		friend std::vector<Point2d> Intersect(const Curve& x, const Curve& y) {
 			return x.self_->Intersect_(y);
@@ -105,6 +151,10 @@ namespace planar {
 			virtual std::vector<Vec2d> Endpoints_() const = 0;
 			virtual const void* Target_() const = 0;
 			virtual CurveType TargetType_() const = 0;
+			virtual Point2d Midpoint_() const = 0;
+			virtual Box2d Bounds_() const = 0;
+			virtual Curve Reverse_() const = 0;
+			virtual std::vector<Curve> Split_(const std::vector<Point2d> &pts) const = 0;
 			virtual std::vector<Point2d> Intersect_(const Curve &rhs) const = 0;
 			// Visitor pattern methods
 			virtual std::vector<Point2d> Intersect_(const struct LineSegment &rhs) const = 0;
@@ -136,6 +186,18 @@ namespace planar {
 			CurveType TargetType_() const {
 				return CurveTraits<T>::value;
 			}
+			Point2d Midpoint_() const {
+				return Midpoint(data_);
+			}
+			Box2d Bounds_() const {
+				return Bounds(data_);
+			}
+			Curve Reverse_() const {
+				return Reverse(data_);
+			}
+			std::vector<Curve> Split_(const std::vector<Point2d> &pts) const {
+				return Split(data_, pts);
+			}
 			
 			std::vector<Point2d> Intersect_(const Curve &rhs) const {
 				return rhs.self_->Intersect_(data_);
@@ -159,6 +221,17 @@ namespace planar {
 	Curve Offset(const Curve& x, float offset);
 	std::vector<Vec2d> Tangents(const Curve& x);
 	std::vector<Vec2d> Endpoints(const Curve& x);
+	Point2d Midpoint(const Curve& x);
+	Box2d Bounds(const Curve& x);
+	Curve Reverse(const Curve& x);
+	std::vector<Curve> Split(const Curve& x, const std::vector<Point2d> &pts);
+
+	// Split a curve at the given points, which are assumed to lie on it.
+	// Points at (or numerically at) the curve's endpoints are ignored. A
+	// circle split at one or more points becomes a closed chain of arcs.
+	std::vector<Curve> Split(const LineSegment &segment, const std::vector<Point2d> &pts);
+	std::vector<Curve> Split(const Circle &circle, const std::vector<Point2d> &pts);
+	std::vector<Curve> Split(const Arc &arc, const std::vector<Point2d> &pts);
 
 	template<>
 	struct Curve::CurveTraits<struct LineSegment> {
@@ -0,0 +1,156 @@
+#include "quantize.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace planar {
+
+	int32_t QuantizeValue(double v) {
+		auto q = std::llround(v);
+		return int32_t(std::max<long long>(std::min<long long>(q, kMaxQuantized), -kMaxQuantized));
+	}
+
+	QuantizeGrid FitGrid(const Box2d &box) {
+		auto half_extent = 0.5 * std::max(double(box.max[0]) - double(box.min[0]), double(box.max[1]) - double(box.min[1]));
+		auto quantum = half_extent > 0.0 ? half_extent / double(kMaxQuantized - 1) : 1.0;
+		return FitGrid(box, quantum);
+	}
+
+	QuantizeGrid FitGrid(const Box2d &box, double quantum) {
+		return QuantizeGrid{(box.min + box.max) * 0.5f, quantum};
+	}
+
+	IPoint2d Quantize(const QuantizeGrid &grid, const Point2d &pt) {
+		return IPoint2d{
+			QuantizeValue((double(pt[0]) - double(grid.origin[0])) / grid.quantum),
+			QuantizeValue((double(pt[1]) - double(grid.origin[1])) / grid.quantum)
+		};
+	}
+
+	ILineSegment Quantize(const QuantizeGrid &grid, const LineSegment &segment) {
+		return ILineSegment{{{Quantize(grid, segment.pts[0]), Quantize(grid, segment.pts[1])}}};
+	}
+
+	ICircle Quantize(const QuantizeGrid &grid, const Circle &circle) {
+		return ICircle{Quantize(grid, circle.center), QuantizeValue(double(circle.radius) / grid.quantum)};
+	}
+
+	IArc Quantize(const QuantizeGrid &grid, const Arc &arc) {
+		return IArc{Quantize(grid, arc.circle), Quantize(grid, arc.endpoints)};
+	}
+
+	Point2d Dequantize(const QuantizeGrid &grid, const IPoint2d &pt) {
+		return Point2d(
+			float(double(grid.origin[0]) + double(pt.x) * grid.quantum),
+			float(double(grid.origin[1]) + double(pt.y) * grid.quantum)
+		);
+	}
+
+	LineSegment Dequantize(const QuantizeGrid &grid, const ILineSegment &segment) {
+		return LineSegment{{{Dequantize(grid, segment.pts[0]), Dequantize(grid, segment.pts[1])}}};
+	}
+
+	Circle Dequantize(const QuantizeGrid &grid, const ICircle &circle) {
+		return Circle{Dequantize(grid, circle.center), float(double(circle.radius) * grid.quantum)};
+	}
+
+	Arc Dequantize(const QuantizeGrid &grid, const IArc &arc) {
+		return Arc{Dequantize(grid, arc.circle), Dequantize(grid, arc.endpoints)};
+	}
+
+	void PushPoint(const IPoint2d &pt, std::vector<int32_t> &values) {
+		values.push_back(pt.x);
+		values.push_back(pt.y);
+	}
+
+	QuantizedLoop Quantize(const QuantizeGrid &grid, const Loop &loop) {
+		auto result = QuantizedLoop{};
+		result.types.reserve(loop.curves().size());
+		result.values.reserve(loop.curves().size() * 4);
+		for(const auto &curve : loop.curves()) {
+			auto type = TargetType(curve);
+			result.types.push_back(uint8_t(type));
+			switch(type) {
+				case Curve::CurveType::LineSegment: {
+					auto segment = Quantize(grid, *(LineSegment*)Target(curve));
+					PushPoint(segment.pts[0], result.values);
+					PushPoint(segment.pts[1], result.values);
+					break;
+				}
+				case Curve::CurveType::Circle: {
+					auto circle = Quantize(grid, *(Circle*)Target(curve));
+					PushPoint(circle.center, result.values);
+					result.values.push_back(circle.radius);
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					auto arc = Quantize(grid, *(Arc*)Target(curve));
+					PushPoint(arc.circle.center, result.values);
+					result.values.push_back(arc.circle.radius);
+					PushPoint(arc.endpoints.pts[0], result.values);
+					PushPoint(arc.endpoints.pts[1], result.values);
+					break;
+				}
+			}
+		}
+		return result;
+	}
+
+	Loop Dequantize(const QuantizeGrid &grid, const QuantizedLoop &loop) {
+		auto curves = std::vector<Curve>{};
+		curves.reserve(loop.types.size());
+		auto v = loop.values.data();
+		for(auto type : loop.types) {
+			switch(Curve::CurveType(type)) {
+				case Curve::CurveType::LineSegment:
+					curves.push_back(Dequantize(grid, ILineSegment{{{IPoint2d{v[0], v[1]}, IPoint2d{v[2], v[3]}}}}));
+					v += 4;
+					break;
+				case Curve::CurveType::Circle:
+					curves.push_back(Dequantize(grid, ICircle{IPoint2d{v[0], v[1]}, v[2]}));
+					v += 3;
+					break;
+				case Curve::CurveType::Arc:
+					curves.push_back(Dequantize(grid, IArc{
+						ICircle{IPoint2d{v[0], v[1]}, v[2]},
+						ILineSegment{{{IPoint2d{v[3], v[4]}, IPoint2d{v[5], v[6]}}}}
+					}));
+					v += 7;
+					break;
+			}
+		}
+		return Loop(std::move(curves));
+	}
+
+	void Orientations(const IPoint2d &a, const IPoint2d &b, const int32_t *x, const int32_t *y, size_t count, int8_t *sign) {
+		auto dx = int64_t(b.x - a.x);
+		auto dy = int64_t(b.y - a.y);
+		for(size_t i=0; i < count; ++i) {
+			auto cross = dx * int64_t(y[i] - a.y) - dy * int64_t(x[i] - a.x);
+			sign[i] = int8_t((cross > 0) - (cross < 0));
+		}
+	}
+
+	// c lies within the bounding box of a and b; used once a, b, c are
+	// known to be collinear
+	bool InSpan(const IPoint2d &a, const IPoint2d &b, const IPoint2d &c) {
+		return std::min(a.x, b.x) <= c.x && c.x <= std::max(a.x, b.x) &&
+			std::min(a.y, b.y) <= c.y && c.y <= std::max(a.y, b.y);
+	}
+
+	bool Intersects(const ILineSegment &segment1, const ILineSegment &segment2) {
+		const auto &a = segment1.pts[0];
+		const auto &b = segment1.pts[1];
+		const auto &c = segment2.pts[0];
+		const auto &d = segment2.pts[1];
+		auto o1 = Orientation(a, b, c);
+		auto o2 = Orientation(a, b, d);
+		auto o3 = Orientation(c, d, a);
+		auto o4 = Orientation(c, d, b);
+		if(o1 != o2 && o3 != o4) {
+			return true;
+		}
+		return (o1 == 0 && InSpan(a, b, c)) || (o2 == 0 && InSpan(a, b, d)) ||
+			(o3 == 0 && InSpan(c, d, a)) || (o4 == 0 && InSpan(c, d, b));
+	}
+}
@@ -0,0 +1,85 @@
+#ifndef quantize_hpp
+#define quantize_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// Integer mirrors of the primitives with coordinates counted in quanta
+	// of a QuantizeGrid. Integer geometry is identical on every host and
+	// compiler, and predicates on it are exact.
+	struct IPoint2d{
+		int32_t x;
+		int32_t y;
+	};
+
+	struct ILineSegment{
+		std::array<IPoint2d, 2> pts;
+	};
+
+	struct ICircle{
+		IPoint2d center;
+		int32_t radius;
+	};
+
+	struct IArc{
+		ICircle circle;
+		ILineSegment endpoints;
+	};
+
+	// Quantized values are clamped to +-kMaxQuantized so that differences
+	// of coordinates fit in 31 bits and their products in an int64
+	const int32_t kMaxQuantized = (1 << 30) - 1;
+
+	// Integer coordinate i stands for origin + i * quantum
+	struct QuantizeGrid{
+		Point2d origin;
+		double quantum;
+	};
+
+	// Finest grid that holds everything in box, and a grid of a given
+	// quantum centered on box
+	QuantizeGrid FitGrid(const Box2d &box);
+	QuantizeGrid FitGrid(const Box2d &box, double quantum);
+
+	IPoint2d Quantize(const QuantizeGrid &grid, const Point2d &pt);
+	ILineSegment Quantize(const QuantizeGrid &grid, const LineSegment &segment);
+	ICircle Quantize(const QuantizeGrid &grid, const Circle &circle);
+	IArc Quantize(const QuantizeGrid &grid, const Arc &arc);
+
+	Point2d Dequantize(const QuantizeGrid &grid, const IPoint2d &pt);
+	LineSegment Dequantize(const QuantizeGrid &grid, const ILineSegment &segment);
+	Circle Dequantize(const QuantizeGrid &grid, const ICircle &circle);
+	Arc Dequantize(const QuantizeGrid &grid, const IArc &arc);
+
+	// Compact loop storage: a type per curve and its integer values packed
+	// back to back (4 for a line, 3 for a circle, 7 for an arc)
+	struct QuantizedLoop{
+		std::vector<uint8_t> types;
+		std::vector<int32_t> values;
+	};
+
+	QuantizedLoop Quantize(const QuantizeGrid &grid, const Loop &loop);
+	Loop Dequantize(const QuantizeGrid &grid, const QuantizedLoop &loop);
+
+	// Exact sign of the turn a -> b -> c: 1 for CCW (c left of a->b), -1 for
+	// CW, 0 if collinear
+	inline int Orientation(const IPoint2d &a, const IPoint2d &b, const IPoint2d &c) {
+		auto cross = int64_t(b.x - a.x) * int64_t(c.y - a.y) - int64_t(b.y - a.y) * int64_t(c.x - a.x);
+		return (cross > 0) - (cross < 0);
+	}
+
+	// Orientation of a -> b -> (x[i], y[i]) for many points, written as a
+	// branch-free loop the compiler can vectorize
+	void Orientations(const IPoint2d &a, const IPoint2d &b, const int32_t *x, const int32_t *y, size_t count, int8_t *sign);
+
+	// Exact test for whether two segments share any point, including
+	// touching at an end or overlapping collinearly
+	bool Intersects(const ILineSegment &segment1, const ILineSegment &segment2);
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef queue_hpp
+#define queue_hpp
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace planar {
+
+	// Blocking FIFO with a fixed capacity for handing work between pipeline
+	// stages. Push blocks while the queue is full, which applies back
+	// pressure to the producer. After Close, Push is refused and Pop drains
+	// what's left before returning false.
+	template<typename T>
+	class BoundedQueue{
+	public:
+		BoundedQueue(size_t capacity)
+		: capacity_(capacity > 0 ? capacity : 1)
+		{}
+
+		bool Push(T value) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			not_full_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+			if(closed_) {
+				return false;
+			}
+			items_.push_back(std::move(value));
+			max_depth_ = std::max(max_depth_, items_.size());
+			depth_sum_ += items_.size();
+			++pushes_;
+			not_empty_.notify_one();
+			return true;
+		}
+
+		bool Pop(T &value) {
+			std::unique_lock<std::mutex> lock(mutex_);
+			not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+			if(items_.empty()) {
+				return false;
+			}
+			value = std::move(items_.front());
+			items_.pop_front();
+			not_full_.notify_one();
+			return true;
+		}
+
+		void Close() {
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+			not_full_.notify_all();
+			not_empty_.notify_all();
+		}
+
+		size_t capacity() const { return capacity_; }
+
+		// Deepest the queue has been, and its average depth seen by pushes
+		size_t max_depth() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return max_depth_;
+		}
+
+		double mean_depth() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return pushes_ > 0 ? double(depth_sum_) / double(pushes_) : 0.0;
+		}
+
+	private:
+		size_t capacity_;
+		std::deque<T> items_;
+		bool closed_ = false;
+		size_t max_depth_ = 0;
+		size_t depth_sum_ = 0;
+		size_t pushes_ = 0;
+		mutable std::mutex mutex_;
+		std::condition_variable not_full_;
+		std::condition_variable not_empty_;
+	};
+}
+
+#endif
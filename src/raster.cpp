@@ -0,0 +1,320 @@
+#include "raster.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace planar {
+
+	// Rows binned and rasterized together by one thread
+	const uint32_t kRasterBand = 16;
+
+	// Piece of a loop's boundary in pixel coordinates that is monotone in
+	// both x and y, stored with y0 <= y1. dir is the sign of the piece's y
+	// travel along the loop. Arcs (r > 0) are quarter turns or less about
+	// (cx, cy), with angles t0, t1 at the ends and mid between them.
+	struct RasterEdge{
+		double x0;
+		double y0;
+		double x1;
+		double y1;
+		double cx;
+		double cy;
+		double r;
+		double t0;
+		double t1;
+		double mid;
+		float dir;
+	};
+
+	struct EdgePoint{
+		double x;
+		double y;
+		double t;
+	};
+
+	inline double NearestTurn(double t, double ref) {
+		auto turn = 2. * M_PI;
+		return t + turn * std::round((ref - t) / turn);
+	}
+
+	EdgePoint PointAtY(const RasterEdge &edge, double y) {
+		if(y <= edge.y0) {
+			return EdgePoint{edge.x0, edge.y0, edge.t0};
+		}
+		if(y >= edge.y1) {
+			return EdgePoint{edge.x1, edge.y1, edge.t1};
+		}
+		if(edge.r == 0.) {
+			return EdgePoint{edge.x0 + (y - edge.y0) * (edge.x1 - edge.x0) / (edge.y1 - edge.y0), y, 0.};
+		}
+		auto s = std::min(std::max((y - edge.cy) / edge.r, -1.), 1.);
+		auto c = std::sqrt(1. - s * s);
+		if(std::cos(edge.mid) < 0.) {
+			c = -c;
+		}
+		return EdgePoint{edge.cx + edge.r * c, y, NearestTurn(std::atan2(s, c), edge.mid)};
+	}
+
+	// Only called strictly between the piece's x extents
+	EdgePoint PointAtX(const RasterEdge &edge, double x) {
+		if(edge.r == 0.) {
+			return EdgePoint{x, edge.y0 + (x - edge.x0) * (edge.y1 - edge.y0) / (edge.x1 - edge.x0), 0.};
+		}
+		auto c = std::min(std::max((x - edge.cx) / edge.r, -1.), 1.);
+		auto s = std::sqrt(1. - c * c);
+		if(std::sin(edge.mid) < 0.) {
+			s = -s;
+		}
+		return EdgePoint{x, edge.cy + edge.r * s, NearestTurn(std::atan2(s, c), edge.mid)};
+	}
+
+	void AddLineEdge(double x0, double y0, double x1, double y1, std::vector<RasterEdge> &edges) {
+		if(y0 == y1) {
+			// Level edges cover nothing
+			return;
+		}
+		if(y0 < y1) {
+			edges.push_back(RasterEdge{x0, y0, x1, y1, 0., 0., 0., 0., 0., 0., 1.f});
+		}
+		else {
+			edges.push_back(RasterEdge{x1, y1, x0, y0, 0., 0., 0., 0., 0., 0., -1.f});
+		}
+	}
+
+	// Arc from angle t0 sweeping by sweep, cut at the axes into monotone
+	// pieces
+	void AddArcEdges(double cx, double cy, double r, double t0, double sweep, std::vector<RasterEdge> &edges) {
+		auto quarter = 0.5 * M_PI;
+		auto t1 = t0 + sweep;
+		auto step = sweep > 0. ? 1. : -1.;
+		auto k = sweep > 0. ? std::floor(t0 / quarter) + 1. : std::ceil(t0 / quarter) - 1.;
+		auto begin = t0;
+		auto x_begin = cx + r * std::cos(begin);
+		auto y_begin = cy + r * std::sin(begin);
+		while(begin != t1) {
+			auto end = k * quarter;
+			if(step * (end - t1) >= 0.) {
+				end = t1;
+			}
+			k += step;
+			auto x_end = cx + r * std::cos(end);
+			auto y_end = cy + r * std::sin(end);
+			auto mid = 0.5 * (begin + end);
+			if(y_begin < y_end) {
+				edges.push_back(RasterEdge{x_begin, y_begin, x_end, y_end, cx, cy, r, begin, end, mid, 1.f});
+			}
+			else if(y_begin > y_end) {
+				edges.push_back(RasterEdge{x_end, y_end, x_begin, y_begin, cx, cy, r, end, begin, mid, -1.f});
+			}
+			begin = end;
+			x_begin = x_end;
+			y_begin = y_end;
+		}
+	}
+
+	// Pixel coordinates flip y, which turns CCW arcs CW
+	void AddEdges(const Loop &loop, const PixelGrid &grid, std::vector<RasterEdge> &edges) {
+		auto scale = 1. / double(grid.pixel_size);
+		auto px = [&](const Point2d &pt) { return (double(pt[0]) - grid.origin[0]) * scale; };
+		auto py = [&](const Point2d &pt) { return (double(grid.origin[1]) - pt[1]) * scale; };
+		for(const auto &curve : loop.curves()) {
+			switch(TargetType(curve)) {
+				case Curve::CurveType::LineSegment: {
+					const auto &segment = *(LineSegment*)Target(curve);
+					AddLineEdge(px(segment.pts[0]), py(segment.pts[0]), px(segment.pts[1]), py(segment.pts[1]), edges);
+					break;
+				}
+				case Curve::CurveType::Circle: {
+					const auto &circle = *(Circle*)Target(curve);
+					auto sweep = circle.radius > 0.f ? -2. * M_PI : 2. * M_PI;
+					AddArcEdges(px(circle.center), py(circle.center), std::abs(circle.radius) * scale, 0., sweep, edges);
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					const auto &arc = *(Arc*)Target(curve);
+					auto cx = px(arc.circle.center);
+					auto cy = py(arc.circle.center);
+					auto t0 = std::atan2(py(arc.endpoints.pts[0]) - cy, px(arc.endpoints.pts[0]) - cx);
+					AddArcEdges(cx, cy, std::abs(arc.circle.radius) * scale, t0, -double(SweepAngle(arc)), edges);
+					break;
+				}
+			}
+		}
+	}
+
+	// Add a piece lying within one row and one column (or left or right of
+	// the image) to the row's accumulation buffer, whose prefix sums are
+	// the signed coverage. The area right of the piece within its pixel is
+	// the trapezoid under its chord plus, for arcs, the circular segment
+	// between chord and arc.
+	void Accumulate(const RasterEdge &edge, const EdgePoint &a, const EdgePoint &b, uint32_t width, float *acc) {
+		auto dy = b.y - a.y;
+		if(dy <= 0.) {
+			return;
+		}
+		auto x = 0.5 * (a.x + b.x);
+		if(x >= double(width)) {
+			return;
+		}
+		if(x < 0.) {
+			acc[0] += edge.dir * float(dy);
+			return;
+		}
+		auto column = std::min(uint32_t(x), width - 1);
+		auto integral = x * dy;
+		if(edge.r > 0.) {
+			auto angle = b.t - a.t;
+			integral += 0.5 * edge.r * edge.r * (angle - std::sin(angle));
+		}
+		auto area = (double(column) + 1.) * dy - integral;
+		acc[column] += edge.dir * float(area);
+		acc[column + 1] += edge.dir * float(dy - area);
+	}
+
+	// Walk a piece through the pixels of rows [row_begin, row_end)
+	void AccumulateEdge(const RasterEdge &edge, uint32_t row_begin, uint32_t row_end, uint32_t width, float *acc) {
+		auto y_begin = std::max(edge.y0, double(row_begin));
+		auto y_end = std::min(edge.y1, double(row_end));
+		if(y_begin >= y_end) {
+			return;
+		}
+		auto stride = size_t(width) + 1;
+		auto row = uint32_t(y_begin);
+		auto a = PointAtY(edge, y_begin);
+		while(a.y < y_end) {
+			auto b = PointAtY(edge, std::min(double(row) + 1., y_end));
+			auto *row_acc = acc + (row - row_begin) * stride;
+			// Cut at the column boundaries inside the image
+			auto lo = std::max(std::floor(std::min(a.x, b.x)) + 1., 0.);
+			auto hi = std::min(std::ceil(std::max(a.x, b.x)) - 1., double(width));
+			auto prev = a;
+			if(lo <= hi) {
+				auto count = int64_t(hi - lo) + 1;
+				for(int64_t i=0; i < count; ++i) {
+					auto x = a.x < b.x ? lo + double(i) : hi - double(i);
+					auto next = PointAtX(edge, x);
+					next.y = std::min(std::max(next.y, prev.y), b.y);
+					Accumulate(edge, prev, next, width, row_acc);
+					prev = next;
+				}
+			}
+			Accumulate(edge, prev, b, width, row_acc);
+			a = b;
+			++row;
+		}
+	}
+
+	inline void StoreCoverage(float value, float *out) {
+		*out = value;
+	}
+
+	inline void StoreCoverage(float value, uint8_t *out) {
+		*out = uint8_t(value * 255.f + 0.5f);
+	}
+
+	template<typename Pixel>
+	void RasterizeEdges(const std::vector<RasterEdge> &edges, const PixelGrid &grid, Pixel *coverage, unsigned threads) {
+		if(grid.width == 0 || grid.height == 0) {
+			return;
+		}
+		auto bands = (grid.height + kRasterBand - 1) / kRasterBand;
+		auto band_range = [&](const RasterEdge &edge, uint32_t &first, uint32_t &last) {
+			if(edge.y1 <= 0. || edge.y0 >= double(grid.height)) {
+				return false;
+			}
+			first = uint32_t(std::max(edge.y0, 0.)) / kRasterBand;
+			last = std::min(uint32_t(std::min(edge.y1, double(grid.height) - 1.)) / kRasterBand, bands - 1);
+			return true;
+		};
+
+		// Bin edges by band (CSR)
+		auto offsets = std::vector<uint32_t>(bands + 1, 0);
+		uint32_t first = 0;
+		uint32_t last = 0;
+		for(const auto &edge : edges) {
+			if(band_range(edge, first, last)) {
+				for(auto band=first; band <= last; ++band) {
+					++offsets[band + 1];
+				}
+			}
+		}
+		for(uint32_t band=0; band < bands; ++band) {
+			offsets[band + 1] += offsets[band];
+		}
+		auto ids = std::vector<uint32_t>(offsets.back());
+		auto fill = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+		for(uint32_t i=0; i < edges.size(); ++i) {
+			if(band_range(edges[i], first, last)) {
+				for(auto band=first; band <= last; ++band) {
+					ids[fill[band]++] = i;
+				}
+			}
+		}
+
+		ParallelFor(bands, threads, [&](size_t begin, size_t end) {
+			auto stride = size_t(grid.width) + 1;
+			auto acc = std::vector<float>{};
+			for(auto band=begin; band < end; ++band) {
+				auto row_begin = uint32_t(band) * kRasterBand;
+				auto row_end = std::min(row_begin + kRasterBand, grid.height);
+				acc.assign((row_end - row_begin) * stride, 0.f);
+				for(auto i=offsets[band]; i < offsets[band + 1]; ++i) {
+					AccumulateEdge(edges[ids[i]], row_begin, row_end, grid.width, acc.data());
+				}
+				for(auto row=row_begin; row < row_end; ++row) {
+					const auto *row_acc = acc.data() + (row - row_begin) * stride;
+					auto *out = coverage + size_t(row) * grid.width;
+					auto sum = 0.f;
+					for(uint32_t column=0; column < grid.width; ++column) {
+						sum += row_acc[column];
+						StoreCoverage(std::min(std::abs(sum), 1.f), out + column);
+					}
+				}
+			}
+		}, 4);
+	}
+
+	template<typename Pixel>
+	void RasterizeLoops(const std::vector<Loop> &loops, const PixelGrid &grid, Pixel *coverage, unsigned threads) {
+		auto edges = std::vector<RasterEdge>{};
+		for(const auto &loop : loops) {
+			AddEdges(loop, grid, edges);
+		}
+		RasterizeEdges(edges, grid, coverage, threads);
+	}
+
+	template<typename Pixel>
+	void RasterizeLoop(const Loop &loop, const PixelGrid &grid, Pixel *coverage, unsigned threads) {
+		auto edges = std::vector<RasterEdge>{};
+		AddEdges(loop, grid, edges);
+		RasterizeEdges(edges, grid, coverage, threads);
+	}
+
+	PixelGrid FitPixelGrid(const Box2d &bounds, uint32_t width, uint32_t height, float margin) {
+		auto inner_width = std::max(float(width) - 2.f * margin, 1.f);
+		auto inner_height = std::max(float(height) - 2.f * margin, 1.f);
+		auto pixel_size = std::max((bounds.max[0] - bounds.min[0]) / inner_width, (bounds.max[1] - bounds.min[1]) / inner_height);
+		if(!(pixel_size > 0.f)) {
+			pixel_size = 1.f;
+		}
+		auto center = (bounds.min + bounds.max) * 0.5f;
+		auto origin = Point2d(center[0] - 0.5f * float(width) * pixel_size, center[1] + 0.5f * float(height) * pixel_size);
+		return PixelGrid{width, height, origin, pixel_size};
+	}
+
+	void Rasterize(const std::vector<Loop> &loops, const PixelGrid &grid, float *coverage, unsigned threads) {
+		RasterizeLoops(loops, grid, coverage, threads);
+	}
+
+	void Rasterize(const std::vector<Loop> &loops, const PixelGrid &grid, uint8_t *coverage, unsigned threads) {
+		RasterizeLoops(loops, grid, coverage, threads);
+	}
+
+	void Rasterize(const Loop &loop, const PixelGrid &grid, float *coverage, unsigned threads) {
+		RasterizeLoop(loop, grid, coverage, threads);
+	}
+
+	void Rasterize(const Loop &loop, const PixelGrid &grid, uint8_t *coverage, unsigned threads) {
+		RasterizeLoop(loop, grid, coverage, threads);
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef raster_hpp
+#define raster_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// Placement of an image on the plane. Pixels are pixel_size squares
+	// laid out from origin, the top left corner, with rows running down
+	// (-y) and columns across (+x), so pixel (column, row) is
+	// [origin.x + column * pixel_size, origin.x + (column + 1) * pixel_size] x
+	// [origin.y - (row + 1) * pixel_size, origin.y - row * pixel_size].
+	struct PixelGrid{
+		uint32_t width;
+		uint32_t height;
+		Point2d origin;
+		float pixel_size;
+	};
+
+	// Grid of width x height pixels showing bounds, scaled uniformly to fit
+	// inside margin pixels on each side and centered
+	PixelGrid FitPixelGrid(const Box2d &bounds, uint32_t width, uint32_t height, float margin = 0.f);
+
+	// Anti-aliased coverage of loops under the non-zero winding rule,
+	// written row by row to width * height pixels (uint8_t scaled to 255).
+	// Coverage is the exact area of each pixel inside the loops, lines and
+	// arcs alike, wherever the winding number is 0 or +-1; where loops
+	// overlap it saturates. Rows are split into bands run across threads.
+	void Rasterize(const std::vector<Loop> &loops, const PixelGrid &grid, float *coverage, unsigned threads = 0);
+	void Rasterize(const std::vector<Loop> &loops, const PixelGrid &grid, uint8_t *coverage, unsigned threads = 0);
+	void Rasterize(const Loop &loop, const PixelGrid &grid, float *coverage, unsigned threads = 0);
+	void Rasterize(const Loop &loop, const PixelGrid &grid, uint8_t *coverage, unsigned threads = 0);
+}
+
+#endif
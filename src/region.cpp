@@ -0,0 +1,220 @@
+#include "region.hpp"
+#include "containment.hpp"
+#include "offset.hpp"
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+namespace planar {
+
+	// A point of the loop with the smallest x
+	Point2d LeftmostPoint(const Loop &loop) {
+		auto best = Point2d(0.f, 0.f);
+		auto found = false;
+		auto consider = [&](const Point2d &pt) {
+			if(!found || pt[0] < best[0]) {
+				best = pt;
+				found = true;
+			}
+		};
+		for(const auto &curve : loop.curves()) {
+			switch(TargetType(curve)) {
+				case Curve::CurveType::LineSegment: {
+					const auto &segment = *(LineSegment*)Target(curve);
+					consider(segment.pts[0]);
+					consider(segment.pts[1]);
+					break;
+				}
+				case Curve::CurveType::Circle: {
+					const auto &circle = *(Circle*)Target(curve);
+					consider(circle.center - Point2d(std::abs(circle.radius), 0.f));
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					const auto &arc = *(Arc*)Target(curve);
+					auto left = arc.circle.center - Point2d(std::abs(arc.circle.radius), 0.f);
+					if(Bounds(arc).min[0] < std::min(arc.endpoints.pts[0][0], arc.endpoints.pts[1][0])) {
+						consider(left);
+					}
+					consider(arc.endpoints.pts[0]);
+					consider(arc.endpoints.pts[1]);
+					break;
+				}
+			}
+		}
+		return best;
+	}
+
+	struct LoopPiece{
+		MonotonePiece piece;
+		float min_y;
+		float max_y;
+		uint32_t loop;
+	};
+
+	// Stands for a query point among the pieces on the sweep line
+	const uint32_t kSweepProbe = ~uint32_t(0);
+
+	// Orders the pieces crossing the sweep line by x. The loops don't
+	// cross, so two pieces keep their order over the span they share and
+	// are compared halfway up it, away from any vertex they meet at. A
+	// query point is placed among them on the sweep line.
+	struct SweepOrder{
+		const std::vector<LoopPiece> *pieces;
+		const float *sweep_y;
+		const float *probe_x;
+
+		float X(uint32_t id, float y) const {
+			return id == kSweepProbe ? *probe_x : CrossingX((*pieces)[id].piece, y);
+		}
+
+		bool operator()(uint32_t a, uint32_t b) const {
+			if(a == b) {
+				return false;
+			}
+			if(a == kSweepProbe || b == kSweepProbe) {
+				return X(a, *sweep_y) < X(b, *sweep_y);
+			}
+			const auto &pa = (*pieces)[a];
+			const auto &pb = (*pieces)[b];
+			auto y = 0.5f * (std::max(pa.min_y, pb.min_y) + std::min(pa.max_y, pb.max_y));
+			auto xa = X(a, y);
+			auto xb = X(b, y);
+			return xa != xb ? xa < xb : a < b;
+		}
+	};
+
+	Region::Region(const std::vector<Loop> &loops)
+	: loops_(loops)
+	, parents_(loops.size(), -1)
+	, depths_(loops.size(), 0)
+	{
+		auto pieces = std::vector<LoopPiece>{};
+		auto areas = std::vector<float>(loops_.size());
+		auto queries = std::vector<Point2d>{};
+		queries.reserve(loops_.size());
+		for(uint32_t i=0; i < loops_.size(); ++i) {
+			for(const auto &curve : loops_[i].curves()) {
+				for(const auto &piece : MonotonePieces(curve)) {
+					auto y0 = piece.endpoints.pts[0][1];
+					auto y1 = piece.endpoints.pts[1][1];
+					if(y0 != y1) {
+						pieces.push_back(LoopPiece{piece, std::min(y0, y1), std::max(y0, y1), i});
+					}
+				}
+			}
+			areas[i] = SignedArea(loops_[i]);
+			queries.push_back(LeftmostPoint(loops_[i]));
+		}
+		// Pieces in the order they enter and leave the sweep
+		auto entering = std::vector<uint32_t>(pieces.size());
+		for(uint32_t i=0; i < entering.size(); ++i) {
+			entering[i] = i;
+		}
+		auto leaving = entering;
+		std::sort(entering.begin(), entering.end(), [&](uint32_t a, uint32_t b) {
+			return pieces[a].min_y < pieces[b].min_y;
+		});
+		std::sort(leaving.begin(), leaving.end(), [&](uint32_t a, uint32_t b) {
+			return pieces[a].max_y < pieces[b].max_y;
+		});
+
+		auto order = std::vector<uint32_t>(loops_.size());
+		for(uint32_t i=0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+			return queries[i][1] < queries[j][1];
+		});
+
+		auto sweep_y = 0.f;
+		auto probe_x = 0.f;
+		auto active = std::set<uint32_t, SweepOrder>(SweepOrder{&pieces, &sweep_y, &probe_x});
+		auto handles = std::vector<std::set<uint32_t, SweepOrder>::iterator>(pieces.size());
+
+		// Sweep up, finding the nearest piece of another loop to the left of
+		// each query point. The leftmost point of a loop is inside the
+		// piece's loop when it's on the piece's filled side.
+		auto nearest = std::vector<int32_t>(loops_.size(), -1);
+		auto inside = std::vector<uint8_t>(loops_.size(), 0);
+		size_t next_entering = 0;
+		size_t next_leaving = 0;
+		for(auto i : order) {
+			const auto &pt = queries[i];
+			auto y = pt[1];
+			// Pieces span [min y, max y): leave before entering at the same y
+			while(true) {
+				auto enters = next_entering < entering.size() && pieces[entering[next_entering]].min_y <= y;
+				auto leaves = next_leaving < leaving.size() && pieces[leaving[next_leaving]].max_y <= y;
+				if(leaves && (!enters || pieces[leaving[next_leaving]].max_y <= pieces[entering[next_entering]].min_y)) {
+					active.erase(handles[leaving[next_leaving++]]);
+				}
+				else if(enters) {
+					auto id = entering[next_entering++];
+					handles[id] = active.insert(id).first;
+				}
+				else {
+					break;
+				}
+			}
+
+			// The loop's own pieces at its leftmost point are at or right of it
+			sweep_y = y;
+			probe_x = pt[0];
+			auto it = active.lower_bound(kSweepProbe);
+			while(it != active.begin()) {
+				--it;
+				const auto &piece = pieces[*it];
+				if(piece.loop == i || !(CrossingX(piece.piece, y) < pt[0])) {
+					continue;
+				}
+				nearest[i] = int32_t(piece.loop);
+				// Running down, the point is on the piece's left
+				inside[i] = (CrossingDirection(piece.piece) < 0) == (areas[piece.loop] > 0.f);
+				break;
+			}
+		}
+
+		// A loop's nearest neighbour starts further left, so it's resolved
+		// first when going left to right
+		std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+			return queries[i][0] < queries[j][0];
+		});
+		for(auto i : order) {
+			auto other = nearest[i];
+			if(other >= 0) {
+				parents_[i] = inside[i] ? other : parents_[other];
+			}
+			depths_[i] = parents_[i] >= 0 ? depths_[parents_[i]] + 1 : 0;
+			if((depths_[i] & 1) == (areas[i] > 0.f ? 1u : 0u)) {
+				loops_[i] = Reverse(loops_[i]);
+			}
+		}
+		BuildChildren();
+	}
+
+	void Region::BuildChildren() {
+		child_offsets_.assign(loops_.size() + 1, 0);
+		for(auto parent : parents_) {
+			if(parent >= 0) {
+				++child_offsets_[parent + 1];
+			}
+		}
+		for(size_t i=0; i < loops_.size(); ++i) {
+			child_offsets_[i + 1] += child_offsets_[i];
+		}
+		child_ids_.resize(child_offsets_.back());
+		auto fill = std::vector<uint32_t>(child_offsets_.begin(), child_offsets_.end() - 1);
+		for(uint32_t i=0; i < loops_.size(); ++i) {
+			if(parents_[i] >= 0) {
+				child_ids_[fill[parents_[i]]++] = i;
+			}
+		}
+	}
+
+	Region Region::Offset(float amt, unsigned threads) const {
+		// Trimmed together, so loops that cross or merge are resolved,
+		// then nested afresh
+		return Region(OffsetEngine(loops_, threads).Offset(amt, threads));
+	}
+}
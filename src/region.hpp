@@ -0,0 +1,53 @@
+#ifndef region_hpp
+#define region_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// A set of non-crossing loops with their nesting: outer loops, the
+	// holes directly inside them, islands inside the holes and so on. The
+	// tree is found by one sweep in y over the loops' monotone pieces. Each
+	// loop's leftmost point looks left for the nearest piece of another
+	// loop; that loop either encloses it or is a sibling sharing its
+	// parent. Loops keep their input order but are reoriented so that
+	// loops at even depth run CCW and holes (odd depth) run CW, matching
+	// the Boolean convention.
+	class Region{
+	public:
+		Region(const std::vector<Loop> &loops);
+
+		size_t size() const { return loops_.size(); }
+		const std::vector<Loop>& loops() const { return loops_; }
+
+		// Index of the loop directly enclosing loop i, or -1 at the top level
+		int32_t parent(size_t i) const { return parents_[i]; }
+		uint32_t depth(size_t i) const { return depths_[i]; }
+		bool hole(size_t i) const { return (depths_[i] & 1) != 0; }
+
+		// Loops directly inside loop i, in increasing order
+		const uint32_t* Children(size_t i) const { return child_ids_.data() + child_offsets_[i]; }
+		size_t ChildCount(size_t i) const { return child_offsets_[i + 1] - child_offsets_[i]; }
+
+		// Trimmed offset of the whole region (an OffsetEngine built and
+		// run across threads). Outers and islands grow and holes shrink for
+		// positive amt, the other way round for negative. Loops that
+		// collapse vanish and loops that meet merge, so the result is
+		// rebuilt as a new Region with its own nesting.
+		Region Offset(float amt, unsigned threads = 0) const;
+
+	private:
+		void BuildChildren();
+
+		std::vector<Loop> loops_;
+		std::vector<int32_t> parents_;
+		std::vector<uint32_t> depths_;
+		std::vector<uint32_t> child_offsets_;
+		std::vector<uint32_t> child_ids_;
+	};
+}
+
+#endif
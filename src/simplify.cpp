@@ -0,0 +1,155 @@
+#include "simplify.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace planar {
+
+	// A run of mergeable curves: a line through start along direction, or
+	// an arc of circle, that has swept sweep so far
+	struct Run{
+		Curve::CurveType type;
+		Point2d start;
+		Point2d end;
+		Vec2d direction;
+		Circle circle;
+		float sweep;
+	};
+
+	Run StartRun(const Curve &curve) {
+		auto endpoints = Endpoints(curve);
+		auto run = Run{TargetType(curve), endpoints[0], endpoints[1], Tangents(curve)[0], Circle{Point2d(0.f, 0.f), 0.f}, 0.f};
+		if(run.type == Curve::CurveType::Arc) {
+			const auto &arc = *(Arc*)Target(curve);
+			run.circle = arc.circle;
+			run.sweep = SweepAngle(arc);
+		}
+		return run;
+	}
+
+	// Extend run by curve if the result stays within tolerance. Lines have
+	// to keep every vertex within half the tolerance of the run's initial
+	// line so the merged chord, which is also inside that band, can't
+	// drift further than tolerance from any of them.
+	bool Extend(Run &run, const Curve &curve, float tolerance) {
+		if(TargetType(curve) != run.type) {
+			return false;
+		}
+		auto tangents = Tangents(curve);
+		auto endpoints = Endpoints(curve);
+		switch(run.type) {
+			case Curve::CurveType::LineSegment: {
+				auto off_line = ((endpoints[1] - run.start) ^ run.direction)[0];
+				if((tangents[0] <= run.direction)[0] <= 0.f || std::abs(off_line) > tolerance * 0.5f) {
+					return false;
+				}
+				run.end = endpoints[1];
+				return true;
+			}
+			case Curve::CurveType::Arc: {
+				const auto &arc = *(Arc*)Target(curve);
+				auto sweep = SweepAngle(arc);
+				if(std::abs(arc.circle.radius - run.circle.radius) > tolerance ||
+					(arc.circle.center - run.circle.center).norm() > tolerance ||
+					std::abs(run.sweep + sweep) > 2.f * float(M_PI) + 1e-4f)
+				{
+					return false;
+				}
+				run.end = endpoints[1];
+				run.sweep += sweep;
+				return true;
+			}
+			default:
+				return false;
+		}
+	}
+
+	Curve FinishRun(const Run &run) {
+		if(run.type == Curve::CurveType::LineSegment) {
+			return LineSegment{run.start, run.end};
+		}
+		return Arc{run.circle, LineSegment{run.start, run.end}};
+	}
+
+	size_t Simplify(Loop &loop, float tolerance) {
+		const auto &curves = loop.curves();
+		auto n = curves.size();
+		if(n < 2) {
+			return 0;
+		}
+
+		// Start at a joint that can't merge so no run spans the seam. If
+		// every joint merges, the loop is a single run.
+		auto first = size_t(0);
+		for(size_t i=0; i < n; ++i) {
+			const auto &prev = curves[(i + n - 1) % n];
+			if(TargetType(prev) == Curve::CurveType::Circle || Length(prev) <= tolerance) {
+				continue;
+			}
+			auto run = StartRun(prev);
+			if(!Extend(run, curves[i], tolerance)) {
+				first = i;
+				break;
+			}
+		}
+
+		auto result = std::vector<Curve>{};
+		auto has_run = false;
+		auto run = Run{};
+		auto has_dropped = false;
+		auto dropped_start = Point2d(0.f, 0.f);
+		for(size_t k=0; k < n; ++k) {
+			const auto &curve = curves[(first + k) % n];
+			if(TargetType(curve) == Curve::CurveType::Circle) {
+				if(has_run) {
+					result.push_back(FinishRun(run));
+					has_run = false;
+				}
+				result.push_back(curve);
+				continue;
+			}
+			// Drop short curves, moving the run's end so the loop stays
+			// connected
+			if(Length(curve) <= tolerance) {
+				if(has_run) {
+					run.end = Endpoints(curve)[1];
+				}
+				else if(!has_dropped) {
+					dropped_start = Endpoints(curve)[0];
+					has_dropped = true;
+				}
+				continue;
+			}
+			if(has_run && Extend(run, curve, tolerance)) {
+				continue;
+			}
+			if(has_run) {
+				result.push_back(FinishRun(run));
+			}
+			run = StartRun(curve);
+			if(!has_run && has_dropped) {
+				run.start = dropped_start;
+				has_dropped = false;
+			}
+			has_run = true;
+		}
+		if(has_run) {
+			// The final run may have wrapped past the whole loop
+			if(result.empty() && run.type == Curve::CurveType::Arc && std::abs(run.sweep) >= 2.f * float(M_PI) - 1e-4f) {
+				result.push_back(run.circle);
+			}
+			else {
+				result.push_back(FinishRun(run));
+			}
+		}
+		if(result.empty()) {
+			return 0;
+		}
+
+		auto removed = n - result.size();
+		if(removed > 0) {
+			loop = Loop(std::move(result));
+		}
+		return removed;
+	}
+}
@@ -0,0 +1,18 @@
+#ifndef simplify_hpp
+#define simplify_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+
+namespace planar {
+
+	// Merge runs of collinear LineSegments and of Arcs on the same circle
+	// and direction, and drop curves no longer than tolerance, in one pass
+	// over the loop. Merged curves stay within tolerance of every original
+	// vertex. Runs may wrap past the loop's first curve; a loop that merges
+	// into a single full turn becomes a Circle. Returns the number of curves
+	// removed.
+	size_t Simplify(Loop &loop, float tolerance);
+}
+
+#endif
@@ -0,0 +1,394 @@
+#include "tessellate.hpp"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+
+namespace planar {
+
+	const uint32_t kNoVertex = ~uint32_t(0);
+
+	enum class SweepKind : uint8_t{
+		Start,
+		End,
+		Split,
+		Merge,
+		Regular
+	};
+
+	// Sweep order is down in y, then right in x, so no two vertices are
+	// level
+	inline bool Above(const float *xy, uint32_t a, uint32_t b) {
+		auto ay = xy[2 * a + 1];
+		auto by = xy[2 * b + 1];
+		return ay > by || (ay == by && xy[2 * a] < xy[2 * b]);
+	}
+
+	// Positive if a -> b -> c turns left
+	inline double Orientation(const float *xy, uint32_t a, uint32_t b, uint32_t c) {
+		auto abx = double(xy[2 * b]) - xy[2 * a];
+		auto aby = double(xy[2 * b + 1]) - xy[2 * a + 1];
+		auto acx = double(xy[2 * c]) - xy[2 * a];
+		auto acy = double(xy[2 * c + 1]) - xy[2 * a + 1];
+		return abx * acy - aby * acx;
+	}
+
+	// Edges crossing the sweep line, ordered by where they cross it. Edge
+	// e runs from vertex e to next[e]. Edges never cross, so the order
+	// stays valid as the line moves. The probe edge stands for the current
+	// vertex in searches.
+	struct SweepLine{
+		const float *xy;
+		const uint32_t *next;
+		uint32_t probe;
+		double x;
+		double y;
+
+		double XAt(uint32_t e) const {
+			if(e == probe) {
+				return x;
+			}
+			double ax = xy[2 * e];
+			double ay = xy[2 * e + 1];
+			double bx = xy[2 * next[e]];
+			double by = xy[2 * next[e] + 1];
+			if(ay == by) {
+				// Level edges cross where the sweep is along them
+				return std::min(std::max(x, std::min(ax, bx)), std::max(ax, bx));
+			}
+			auto t = std::min(std::max((y - ay) / (by - ay), 0.), 1.);
+			return ax + t * (bx - ax);
+		}
+	};
+
+	struct EdgeLess{
+		const SweepLine *line;
+
+		bool operator()(uint32_t a, uint32_t b) const {
+			auto xa = line->XAt(a);
+			auto xb = line->XAt(b);
+			return xa < xb || (xa == xb && a < b);
+		}
+	};
+
+	void Emit(const float *xy, uint32_t a, uint32_t b, uint32_t c, std::vector<uint32_t> &indices) {
+		auto o = Orientation(xy, a, b, c);
+		if(o == 0.) {
+			return;
+		}
+		if(o < 0.) {
+			std::swap(b, c);
+		}
+		indices.push_back(a);
+		indices.push_back(b);
+		indices.push_back(c);
+	}
+
+	// Triangulate a y-monotone CCW polygon by walking down both chains at
+	// once, keeping the vertices that can't be cut off yet on a stack
+	void TriangulateMonotone(const float *xy, const std::vector<uint32_t> &face, std::vector<uint32_t> &indices) {
+		auto k = face.size();
+		if(k < 3) {
+			return;
+		}
+		if(k == 3) {
+			Emit(xy, face[0], face[1], face[2], indices);
+			return;
+		}
+
+		size_t top = 0;
+		size_t bottom = 0;
+		for(size_t i=1; i < k; ++i) {
+			if(Above(xy, face[i], face[top])) {
+				top = i;
+			}
+			if(Above(xy, face[bottom], face[i])) {
+				bottom = i;
+			}
+		}
+		// Going CCW from the top runs down the left chain
+		auto left = std::vector<uint8_t>(k, 0);
+		for(auto i=top; i != bottom; i=(i + 1) % k) {
+			left[i] = 1;
+		}
+		auto order = std::vector<uint32_t>(k);
+		for(uint32_t i=0; i < k; ++i) {
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t i, uint32_t j) {
+			return Above(xy, face[i], face[j]);
+		});
+
+		auto stack = std::vector<uint32_t>{order[0], order[1]};
+		for(size_t j=2; j + 1 < k; ++j) {
+			auto u = order[j];
+			if(left[u] != left[stack.back()]) {
+				// Across from the stack: fan to all of it
+				while(stack.size() > 1) {
+					auto a = stack.back();
+					stack.pop_back();
+					Emit(xy, face[u], face[a], face[stack.back()], indices);
+				}
+				stack.clear();
+				stack.push_back(order[j - 1]);
+				stack.push_back(u);
+			}
+			else {
+				// Same side: cut off ears while the diagonal stays inside
+				auto last = stack.back();
+				stack.pop_back();
+				while(!stack.empty()) {
+					auto o = Orientation(xy, face[stack.back()], face[last], face[u]);
+					if(left[u] ? o <= 0. : o >= 0.) {
+						break;
+					}
+					Emit(xy, face[u], face[last], face[stack.back()], indices);
+					last = stack.back();
+					stack.pop_back();
+				}
+				stack.push_back(last);
+				stack.push_back(u);
+			}
+		}
+		auto u = order[k - 1];
+		while(stack.size() > 1) {
+			auto a = stack.back();
+			stack.pop_back();
+			Emit(xy, face[u], face[a], face[stack.back()], indices);
+		}
+	}
+
+	void Triangulate(const VertexBuffer &vertices, std::vector<uint32_t> &indices) {
+		const auto *xy = vertices.xy.data();
+		auto n = uint32_t(vertices.vertex_count());
+		auto next = std::vector<uint32_t>(n);
+		auto prev = std::vector<uint32_t>(n);
+		for(size_t l=0; l < vertices.loop_count(); ++l) {
+			auto begin = vertices.offsets[l];
+			auto end = vertices.offsets[l + 1];
+			for(auto v=begin; v < end; ++v) {
+				next[v] = v + 1 < end ? v + 1 : begin;
+				prev[v] = v > begin ? v - 1 : end - 1;
+			}
+		}
+
+		auto kinds = std::vector<SweepKind>(n);
+		auto order = std::vector<uint32_t>(n);
+		for(uint32_t v=0; v < n; ++v) {
+			order[v] = v;
+			auto prev_above = Above(xy, prev[v], v);
+			auto next_above = Above(xy, next[v], v);
+			auto convex = Orientation(xy, prev[v], v, next[v]) > 0.;
+			if(!prev_above && !next_above) {
+				kinds[v] = convex ? SweepKind::Start : SweepKind::Split;
+			}
+			else if(prev_above && next_above) {
+				kinds[v] = convex ? SweepKind::End : SweepKind::Merge;
+			}
+			else {
+				kinds[v] = SweepKind::Regular;
+			}
+		}
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return Above(xy, a, b);
+		});
+
+		// Sweep down, tracking the edges with the interior on their right.
+		// Each remembers the lowest vertex seen between it and the next edge
+		// over (its helper); split and merge vertices are joined to helpers
+		// by diagonals.
+		auto line = SweepLine{xy, next.data(), n, 0., 0.};
+		auto status = std::set<uint32_t, EdgeLess>(EdgeLess{&line});
+		auto positions = std::vector<std::set<uint32_t, EdgeLess>::iterator>(n, status.end());
+		auto helper = std::vector<uint32_t>(n, kNoVertex);
+		auto diagonals = std::vector<std::pair<uint32_t, uint32_t>>{};
+		auto insert = [&](uint32_t e, uint32_t v) {
+			positions[e] = status.insert(e).first;
+			helper[e] = v;
+		};
+		auto erase = [&](uint32_t e) {
+			if(positions[e] != status.end()) {
+				status.erase(positions[e]);
+				positions[e] = status.end();
+			}
+		};
+		auto join_merge_helper = [&](uint32_t e, uint32_t v) {
+			if(helper[e] != kNoVertex && kinds[helper[e]] == SweepKind::Merge) {
+				diagonals.push_back(std::make_pair(v, helper[e]));
+			}
+		};
+		auto left_of = [&]() {
+			auto it = status.lower_bound(n);
+			return it == status.begin() ? kNoVertex : *std::prev(it);
+		};
+		for(auto v : order) {
+			line.x = xy[2 * v];
+			line.y = xy[2 * v + 1];
+			auto p = prev[v];
+			switch(kinds[v]) {
+				case SweepKind::Start:
+					insert(v, v);
+					break;
+				case SweepKind::End:
+					join_merge_helper(p, v);
+					erase(p);
+					break;
+				case SweepKind::Split: {
+					auto e = left_of();
+					if(e != kNoVertex) {
+						diagonals.push_back(std::make_pair(v, helper[e]));
+						helper[e] = v;
+					}
+					insert(v, v);
+					break;
+				}
+				case SweepKind::Merge: {
+					join_merge_helper(p, v);
+					erase(p);
+					auto e = left_of();
+					if(e != kNoVertex) {
+						join_merge_helper(e, v);
+						helper[e] = v;
+					}
+					break;
+				}
+				case SweepKind::Regular:
+					if(Above(xy, p, v)) {
+						join_merge_helper(p, v);
+						erase(p);
+						insert(v, v);
+					}
+					else {
+						auto e = left_of();
+						if(e != kNoVertex) {
+							join_merge_helper(e, v);
+							helper[e] = v;
+						}
+					}
+					break;
+			}
+		}
+
+		// Half-edges: every boundary edge once, every diagonal both ways.
+		// Outgoing half-edges of each vertex in CSR layout.
+		for(auto &d : diagonals) {
+			if(d.first > d.second) {
+				std::swap(d.first, d.second);
+			}
+		}
+		std::sort(diagonals.begin(), diagonals.end());
+		diagonals.erase(std::unique(diagonals.begin(), diagonals.end()), diagonals.end());
+		auto offsets = std::vector<uint32_t>(n + 1, 0);
+		for(uint32_t v=0; v < n; ++v) {
+			offsets[v + 1] = 1;
+		}
+		for(const auto &d : diagonals) {
+			++offsets[d.first + 1];
+			++offsets[d.second + 1];
+		}
+		for(uint32_t v=0; v < n; ++v) {
+			offsets[v + 1] += offsets[v];
+		}
+		auto targets = std::vector<uint32_t>(offsets[n]);
+		auto fill = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+		for(uint32_t v=0; v < n; ++v) {
+			targets[fill[v]++] = next[v];
+		}
+		for(const auto &d : diagonals) {
+			targets[fill[d.first]++] = d.second;
+			targets[fill[d.second]++] = d.first;
+		}
+
+		// Trace the faces, keeping the interior on the left: arriving at a
+		// vertex, leave by the first edge clockwise from the way back
+		auto used = std::vector<uint8_t>(targets.size(), 0);
+		auto face = std::vector<uint32_t>{};
+		for(uint32_t v=0; v < n; ++v) {
+			for(auto h=offsets[v]; h < offsets[v + 1]; ++h) {
+				if(used[h]) {
+					continue;
+				}
+				face.clear();
+				auto from = v;
+				auto cur = h;
+				while(!used[cur]) {
+					used[cur] = 1;
+					face.push_back(from);
+					auto to = targets[cur];
+					auto back_x = double(xy[2 * from]) - xy[2 * to];
+					auto back_y = double(xy[2 * from + 1]) - xy[2 * to + 1];
+					auto best = cur;
+					auto best_angle = 10.;
+					for(auto k=offsets[to]; k < offsets[to + 1]; ++k) {
+						auto dx = double(xy[2 * targets[k]]) - xy[2 * to];
+						auto dy = double(xy[2 * targets[k] + 1]) - xy[2 * to + 1];
+						auto angle = -std::atan2(back_x * dy - back_y * dx, back_x * dx + back_y * dy);
+						if(angle <= 0.) {
+							angle += 2. * M_PI;
+						}
+						if(angle < best_angle) {
+							best_angle = angle;
+							best = k;
+						}
+					}
+					from = to;
+					cur = best;
+				}
+				TriangulateMonotone(xy, face, indices);
+			}
+		}
+	}
+
+	// Drop repeated points, which flattening leaves where curves meet at a
+	// shared vertex, and loops too small to bound anything
+	void RemoveRepeatedPoints(VertexBuffer &vertices) {
+		auto &xy = vertices.xy;
+		auto &offsets = vertices.offsets;
+		size_t out = 0;
+		size_t loops = 0;
+		auto src_begin = offsets[0];
+		for(size_t l=0; l + 1 < offsets.size(); ++l) {
+			auto src_end = offsets[l + 1];
+			auto begin = out;
+			for(auto v=src_begin; v < src_end; ++v) {
+				auto x = xy[2 * v];
+				auto y = xy[2 * v + 1];
+				if(out > begin && xy[2 * (out - 1)] == x && xy[2 * (out - 1) + 1] == y) {
+					continue;
+				}
+				xy[2 * out] = x;
+				xy[2 * out + 1] = y;
+				++out;
+			}
+			while(out > begin + 1 && xy[2 * (out - 1)] == xy[2 * begin] && xy[2 * (out - 1) + 1] == xy[2 * begin + 1]) {
+				--out;
+			}
+			src_begin = src_end;
+			if(out - begin < 3) {
+				out = begin;
+				continue;
+			}
+			offsets[++loops] = uint32_t(out);
+		}
+		xy.resize(2 * out);
+		offsets.resize(loops + 1);
+	}
+
+	void Tessellate(const std::vector<Loop> &loops, float tolerance, TriangleBuffer &buffer) {
+		buffer.clear();
+		Flatten(loops, tolerance, buffer.vertices);
+		RemoveRepeatedPoints(buffer.vertices);
+		Triangulate(buffer.vertices, buffer.indices);
+	}
+
+	void Tessellate(const Loop &loop, float tolerance, TriangleBuffer &buffer) {
+		buffer.clear();
+		Flatten(loop, tolerance, buffer.vertices);
+		RemoveRepeatedPoints(buffer.vertices);
+		Triangulate(buffer.vertices, buffer.indices);
+	}
+
+	void Tessellate(const Region &region, float tolerance, TriangleBuffer &buffer) {
+		Tessellate(region.loops(), tolerance, buffer);
+	}
+}
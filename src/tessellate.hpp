@@ -0,0 +1,43 @@
+#ifndef tessellate_hpp
+#define tessellate_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "flatten.hpp"
+#include "region.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// Indexed triangles over flattened loops. Each triangle is three
+	// indices into vertices, in CCW order.
+	struct TriangleBuffer{
+		VertexBuffer vertices;
+		std::vector<uint32_t> indices;
+
+		size_t triangle_count() const { return indices.size() / 3; }
+		// Keeps the allocations for reuse
+		void clear() {
+			vertices.clear();
+			indices.clear();
+		}
+	};
+
+	// Triangulate the polygons in vertices, which follow the Boolean
+	// convention (CCW outlines, CW holes, no crossings) and have no
+	// repeated consecutive points. A sweep in y adds diagonals at the
+	// vertices where the boundary turns back (O(n log n)), cutting the
+	// polygons into y-monotone pieces, and each piece is triangulated in
+	// one pass down its two chains. Triangles are appended to indices.
+	void Triangulate(const VertexBuffer &vertices, std::vector<uint32_t> &indices);
+
+	// Flatten loops to tolerance (see Flatten) and triangulate them,
+	// replacing the contents of buffer
+	void Tessellate(const std::vector<Loop> &loops, float tolerance, TriangleBuffer &buffer);
+	void Tessellate(const Loop &loop, float tolerance, TriangleBuffer &buffer);
+	// Regions are oriented by nesting, so any input orientation works
+	void Tessellate(const Region &region, float tolerance, TriangleBuffer &buffer);
+}
+
+#endif
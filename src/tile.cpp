@@ -0,0 +1,179 @@
+#include "tile.hpp"
+#include "boolean.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace planar {
+
+	const uint32_t TileGrid::kMaxTileColumns;
+
+	// Aim for about this many curves per tile when picking the tile size
+	const float kCurvesPerTile = 256.f;
+
+	TileGrid::TileGrid(const std::vector<Curve> &curves, float tile_size, float halo)
+	: origin_(0.f, 0.f)
+	, tile_size_(1.f)
+	, halo_(std::max(halo, 0.f))
+	, columns_(1)
+	, rows_(1)
+	{
+		auto bounds = std::vector<Box2d>{};
+		bounds.reserve(curves.size());
+		for(const auto &curve : curves) {
+			bounds.push_back(Bounds(curve));
+		}
+		if(bounds.empty()) {
+			offsets_.assign(2, 0);
+			return;
+		}
+
+		auto box = bounds[0];
+		for(const auto &b : bounds) {
+			box.min = Point2d(std::min(box.min[0], b.min[0]), std::min(box.min[1], b.min[1]));
+			box.max = Point2d(std::max(box.max[0], b.max[0]), std::max(box.max[1], b.max[1]));
+		}
+		auto width = std::max(box.max[0] - box.min[0], 0.f);
+		auto height = std::max(box.max[1] - box.min[1], 0.f);
+		if(!(tile_size > 0.f)) {
+			auto tiles = std::max(float(curves.size()) / kCurvesPerTile, 1.f);
+			tile_size = std::sqrt(width * height / tiles);
+		}
+		auto extent = std::max(width, height);
+		tile_size = std::max(tile_size, extent / float(kMaxTileColumns));
+		if(!(tile_size > 0.f)) {
+			tile_size = 1.f;
+		}
+
+		origin_ = box.min;
+		tile_size_ = tile_size;
+		columns_ = std::min(uint32_t(std::floor(width / tile_size)) + 1, kMaxTileColumns);
+		rows_ = std::min(uint32_t(std::floor(height / tile_size)) + 1, kMaxTileColumns);
+
+		// Count then fill, visiting curves in order so each tile's list is
+		// sorted
+		auto tile_count = size_t(columns_) * rows_;
+		offsets_.assign(tile_count + 1, 0);
+		auto for_each_tile = [&](const Box2d &b, uint32_t id, bool fill) {
+			auto c0 = Column(b.min[0] - halo_);
+			auto c1 = Column(b.max[0] + halo_);
+			auto r0 = Row(b.min[1] - halo_);
+			auto r1 = Row(b.max[1] + halo_);
+			for(auto r=r0; r <= r1; ++r) {
+				for(auto c=c0; c <= c1; ++c) {
+					auto tile = size_t(r) * columns_ + c;
+					if(fill) {
+						ids_[offsets_[tile]++] = id;
+					}
+					else {
+						++offsets_[tile + 1];
+					}
+				}
+			}
+		};
+		for(uint32_t i=0; i < bounds.size(); ++i) {
+			for_each_tile(bounds[i], i, false);
+		}
+		for(size_t t=0; t < tile_count; ++t) {
+			offsets_[t + 1] += offsets_[t];
+		}
+		ids_.resize(offsets_.back());
+		for(uint32_t i=0; i < bounds.size(); ++i) {
+			for_each_tile(bounds[i], i, true);
+		}
+		// Filling advanced each offset to the start of the next tile
+		for(size_t t=tile_count; t > 0; --t) {
+			offsets_[t] = offsets_[t - 1];
+		}
+		offsets_[0] = 0;
+	}
+
+	uint32_t TileGrid::Column(float x) const {
+		auto c = std::floor((x - origin_[0]) / tile_size_);
+		return uint32_t(std::min(std::max(c, 0.f), float(columns_ - 1)));
+	}
+
+	uint32_t TileGrid::Row(float y) const {
+		auto r = std::floor((y - origin_[1]) / tile_size_);
+		return uint32_t(std::min(std::max(r, 0.f), float(rows_ - 1)));
+	}
+
+	Box2d TileGrid::Core(size_t tile) const {
+		auto c = float(tile % columns_);
+		auto r = float(tile / columns_);
+		return Box2d{
+			Point2d(origin_[0] + c * tile_size_, origin_[1] + r * tile_size_),
+			Point2d(origin_[0] + (c + 1.f) * tile_size_, origin_[1] + (r + 1.f) * tile_size_)
+		};
+	}
+
+	size_t TileGrid::TileAt(const Point2d &pt) const {
+		return size_t(Row(pt[1])) * columns_ + Column(pt[0]);
+	}
+
+	TilePoints TileSplitPoints(const TileGrid &grid, size_t tile, const std::vector<Curve> &curves, float tol) {
+		auto ids = grid.Curves(tile);
+		auto count = grid.CurveCount(tile);
+		auto local = std::vector<Curve>{};
+		auto bounds = std::vector<Box2d>{};
+		local.reserve(count);
+		bounds.reserve(count);
+		for(size_t i=0; i < count; ++i) {
+			local.push_back(curves[ids[i]]);
+			bounds.push_back(Bounds(local.back()));
+		}
+
+		auto result = TilePoints{};
+		auto split_pts = SplitPoints(local, bounds, tol);
+		for(size_t i=0; i < count; ++i) {
+			for(const auto &pt : split_pts[i]) {
+				if(grid.TileAt(pt) == tile) {
+					result.curve_ids.push_back(ids[i]);
+					result.pts.push_back(pt);
+				}
+			}
+		}
+		return result;
+	}
+
+	std::vector<std::vector<Curve>> MergeTileSplits(const std::vector<Curve> &curves, const std::vector<TilePoints> &tiles) {
+		auto split_pts = std::vector<std::vector<Point2d>>(curves.size());
+		for(const auto &tile : tiles) {
+			for(size_t i=0; i < tile.pts.size(); ++i) {
+				split_pts[tile.curve_ids[i]].push_back(tile.pts[i]);
+			}
+		}
+		auto fragments = std::vector<std::vector<Curve>>{};
+		fragments.reserve(curves.size());
+		for(size_t i=0; i < curves.size(); ++i) {
+			fragments.push_back(Split(curves[i], split_pts[i]));
+		}
+		return fragments;
+	}
+
+	std::vector<std::vector<Curve>> SplitAtIntersections(const TileGrid &grid, const std::vector<Curve> &curves, float tol, unsigned threads, JobControl *control) {
+		auto tiles = std::vector<TilePoints>(grid.size());
+		if(control) {
+			control->AddWork(grid.size());
+		}
+		ParallelFor(grid.size(), threads, [&](size_t begin, size_t end) {
+			for(auto t=begin; t < end; ++t) {
+				if(control && control->cancelled()) {
+					return;
+				}
+				tiles[t] = TileSplitPoints(grid, t, curves, tol);
+				if(control) {
+					control->Advance();
+				}
+			}
+		}, 1);
+		if(control && control->cancelled()) {
+			return {};
+		}
+		return MergeTileSplits(curves, tiles);
+	}
+
+	std::vector<std::vector<Curve>> SplitAtIntersections(const std::vector<Curve> &curves, float tol, float tile_size, unsigned threads, JobControl *control) {
+		return SplitAtIntersections(TileGrid(curves, tile_size, tol), curves, tol, threads, control);
+	}
+}
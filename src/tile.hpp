@@ -0,0 +1,78 @@
+#ifndef tile_hpp
+#define tile_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include "job.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace planar {
+
+	// Uniform grid of square tiles over a set of curves, for splitting work
+	// on one huge loop into independent pieces. Each tile owns its core, a
+	// half-open cell of the grid, so every point of the plane has exactly
+	// one owner (points off the grid belong to the nearest tile). Each tile
+	// lists the curves whose bounds come within halo of its core, in
+	// increasing order; work that looks halo beyond a point sees everything
+	// it needs in the tile that owns the point. A tile's inputs are just
+	// its curves, so they can be handed to another thread or process and
+	// the results merged by ownership.
+	class TileGrid{
+	public:
+		// tile_size <= 0 picks a size giving a few hundred curves per tile.
+		// The grid is capped at kMaxTileColumns on a side.
+		TileGrid(const std::vector<Curve> &curves, float tile_size, float halo);
+
+		static const uint32_t kMaxTileColumns = 1024;
+
+		size_t size() const { return offsets_.size() - 1; }
+		uint32_t columns() const { return columns_; }
+		uint32_t rows() const { return rows_; }
+		float tile_size() const { return tile_size_; }
+		float halo() const { return halo_; }
+
+		// Core of a tile; tile = row * columns() + column
+		Box2d Core(size_t tile) const;
+		size_t TileAt(const Point2d &pt) const;
+
+		// Ids of the curves in reach of a tile
+		const uint32_t* Curves(size_t tile) const { return ids_.data() + offsets_[tile]; }
+		size_t CurveCount(size_t tile) const { return offsets_[tile + 1] - offsets_[tile]; }
+
+	private:
+		uint32_t Column(float x) const;
+		uint32_t Row(float y) const;
+
+		Point2d origin_;
+		float tile_size_;
+		float halo_;
+		uint32_t columns_;
+		uint32_t rows_;
+		std::vector<uint32_t> offsets_;
+		std::vector<uint32_t> ids_;
+	};
+
+	// Split points found within one tile and owned by it: pts[i] lies on
+	// curves[curve_ids[i]]
+	struct TilePoints{
+		std::vector<uint32_t> curve_ids;
+		std::vector<Point2d> pts;
+	};
+
+	// Intersections among a tile's curves (see SplitPoints) that the tile
+	// owns. The grid's halo should be at least tol.
+	TilePoints TileSplitPoints(const TileGrid &grid, size_t tile, const std::vector<Curve> &curves, float tol);
+
+	// Cut each curve at the points of all tiles. Tiles are merged in order,
+	// so the result doesn't depend on where or when each tile ran.
+	std::vector<std::vector<Curve>> MergeTileSplits(const std::vector<Curve> &curves, const std::vector<TilePoints> &tiles);
+
+	// SplitAtIntersections with the tiles of grid split across threads.
+	// With a control, each tile is a unit of progress and cancelling stops
+	// at the next tile with an empty result.
+	std::vector<std::vector<Curve>> SplitAtIntersections(const TileGrid &grid, const std::vector<Curve> &curves, float tol, unsigned threads = 0, JobControl *control = nullptr);
+	std::vector<std::vector<Curve>> SplitAtIntersections(const std::vector<Curve> &curves, float tol, float tile_size, unsigned threads = 0, JobControl *control = nullptr);
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include "transform.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace planar {
+
+	Transform2d IdentityTransform() {
+		return Transform2d{1.f, 0.f, 0.f, 1.f, 0.f, 0.f};
+	}
+
+	Transform2d Translation(const Vec2d &offset) {
+		return Transform2d{1.f, 0.f, 0.f, 1.f, offset[0], offset[1]};
+	}
+
+	Transform2d Rotation(float angle) {
+		auto c = std::cos(angle);
+		auto s = std::sin(angle);
+		return Transform2d{c, -s, s, c, 0.f, 0.f};
+	}
+
+	Transform2d Rotation(float angle, const Point2d &center) {
+		return Compose(Translation(center), Compose(Rotation(angle), Translation(center * -1.f)));
+	}
+
+	Transform2d Scaling(float scale) {
+		return Transform2d{scale, 0.f, 0.f, scale, 0.f, 0.f};
+	}
+
+	Transform2d Reflection(const Point2d &pt, const Vec2d &direction) {
+		auto d = direction / direction.norm();
+		auto xx = d[0] * d[0] - d[1] * d[1];
+		auto xy = 2.f * d[0] * d[1];
+		auto mirror = Transform2d{xx, xy, xy, -xx, 0.f, 0.f};
+		return Compose(Translation(pt), Compose(mirror, Translation(pt * -1.f)));
+	}
+
+	Transform2d Compose(const Transform2d &first, const Transform2d &second) {
+		return Transform2d{
+			first.xx * second.xx + first.xy * second.yx,
+			first.xx * second.xy + first.xy * second.yy,
+			first.yx * second.xx + first.yy * second.yx,
+			first.yx * second.xy + first.yy * second.yy,
+			first.xx * second.tx + first.xy * second.ty + first.tx,
+			first.yx * second.tx + first.yy * second.ty + first.ty
+		};
+	}
+
+	float Determinant(const Transform2d &xf) {
+		return xf.xx * xf.yy - xf.xy * xf.yx;
+	}
+
+	bool IsSimilarity(const Transform2d &xf) {
+		// The columns are perpendicular and equally long, up to rounding
+		auto size = xf.xx * xf.xx + xf.xy * xf.xy + xf.yx * xf.yx + xf.yy * xf.yy;
+		auto tol = 1e-5f * size;
+		return Determinant(xf) != 0.f
+			&& std::abs(xf.xx * xf.xy + xf.yx * xf.yy) <= tol
+			&& std::abs(xf.xx * xf.xx + xf.yx * xf.yx - xf.xy * xf.xy - xf.yy * xf.yy) <= tol;
+	}
+
+	Transform2d Inverse(const Transform2d &xf) {
+		auto inv_det = 1.f / Determinant(xf);
+		auto xx = xf.yy * inv_det;
+		auto xy = -xf.xy * inv_det;
+		auto yx = -xf.yx * inv_det;
+		auto yy = xf.xx * inv_det;
+		return Transform2d{xx, xy, yx, yy, -(xx * xf.tx + xy * xf.ty), -(yx * xf.tx + yy * xf.ty)};
+	}
+
+	// Factor applied to signed radii
+	float RadiusScale(const Transform2d &xf) {
+		auto det = Determinant(xf);
+		auto scale = std::sqrt(std::abs(det));
+		return det < 0.f ? -scale : scale;
+	}
+
+	Point2d Transform(const Transform2d &xf, const Point2d &pt) {
+		return Point2d(xf.xx * pt[0] + xf.xy * pt[1] + xf.tx, xf.yx * pt[0] + xf.yy * pt[1] + xf.ty);
+	}
+
+	LineSegment Transform(const Transform2d &xf, const LineSegment &segment) {
+		return LineSegment{Transform(xf, segment.pts[0]), Transform(xf, segment.pts[1])};
+	}
+
+	Circle Transform(const Transform2d &xf, const Circle &circle) {
+		return Circle{Transform(xf, circle.center), circle.radius * RadiusScale(xf)};
+	}
+
+	Arc Transform(const Transform2d &xf, const Arc &arc) {
+		return Arc{Transform(xf, arc.circle), Transform(xf, arc.endpoints)};
+	}
+
+	Curve Transform(const Transform2d &xf, const Curve &curve) {
+		switch(TargetType(curve)) {
+			case Curve::CurveType::LineSegment:
+				return Transform(xf, *(LineSegment*)Target(curve));
+			case Curve::CurveType::Circle:
+				return Transform(xf, *(Circle*)Target(curve));
+			case Curve::CurveType::Arc:
+				return Transform(xf, *(Arc*)Target(curve));
+		}
+		return curve;
+	}
+
+	Loop Transform(const Transform2d &xf, const Loop &loop) {
+		auto curves = std::vector<Curve>{};
+		curves.reserve(loop.curves().size());
+		for(const auto &curve : loop.curves()) {
+			curves.push_back(Transform(xf, curve));
+		}
+		return Loop(std::move(curves));
+	}
+
+	void Transform(const Transform2d &xf, float *x, float *y, size_t count) {
+		for(size_t i=0; i < count; ++i) {
+			auto px = x[i];
+			auto py = y[i];
+			x[i] = xf.xx * px + xf.xy * py + xf.tx;
+			y[i] = xf.yx * px + xf.yy * py + xf.ty;
+		}
+	}
+
+	CurveArrays ToArrays(const Loop &loop) {
+		auto arrays = CurveArrays{};
+		auto push = [&](Curve::CurveType type, const Point2d &p0, const Point2d &p1, const Point2d &center, float radius) {
+			arrays.types.push_back(uint8_t(type));
+			arrays.x0.push_back(p0[0]);
+			arrays.y0.push_back(p0[1]);
+			arrays.x1.push_back(p1[0]);
+			arrays.y1.push_back(p1[1]);
+			arrays.cx.push_back(center[0]);
+			arrays.cy.push_back(center[1]);
+			arrays.radius.push_back(radius);
+		};
+		for(const auto &curve : loop.curves()) {
+			switch(TargetType(curve)) {
+				case Curve::CurveType::LineSegment: {
+					const auto &segment = *(LineSegment*)Target(curve);
+					push(Curve::CurveType::LineSegment, segment.pts[0], segment.pts[1], segment.pts[0], 0.f);
+					break;
+				}
+				case Curve::CurveType::Circle: {
+					const auto &circle = *(Circle*)Target(curve);
+					push(Curve::CurveType::Circle, circle.center, circle.center, circle.center, circle.radius);
+					break;
+				}
+				case Curve::CurveType::Arc: {
+					const auto &arc = *(Arc*)Target(curve);
+					push(Curve::CurveType::Arc, arc.endpoints.pts[0], arc.endpoints.pts[1], arc.circle.center, arc.circle.radius);
+					break;
+				}
+			}
+		}
+		return arrays;
+	}
+
+	Loop ToLoop(const CurveArrays &arrays) {
+		auto curves = std::vector<Curve>{};
+		curves.reserve(arrays.types.size());
+		for(size_t i=0; i < arrays.types.size(); ++i) {
+			auto p0 = Point2d(arrays.x0[i], arrays.y0[i]);
+			auto p1 = Point2d(arrays.x1[i], arrays.y1[i]);
+			auto center = Point2d(arrays.cx[i], arrays.cy[i]);
+			switch(Curve::CurveType(arrays.types[i])) {
+				case Curve::CurveType::LineSegment:
+					curves.push_back(LineSegment{p0, p1});
+					break;
+				case Curve::CurveType::Circle:
+					curves.push_back(Circle{center, arrays.radius[i]});
+					break;
+				case Curve::CurveType::Arc:
+					curves.push_back(Arc{Circle{center, arrays.radius[i]}, LineSegment{p0, p1}});
+					break;
+			}
+		}
+		return Loop(std::move(curves));
+	}
+
+	void Transform(const Transform2d &xf, CurveArrays &curves) {
+		auto count = curves.types.size();
+		Transform(xf, curves.x0.data(), curves.y0.data(), count);
+		Transform(xf, curves.x1.data(), curves.y1.data(), count);
+		Transform(xf, curves.cx.data(), curves.cy.data(), count);
+		auto scale = RadiusScale(xf);
+		auto radius = curves.radius.data();
+		for(size_t i=0; i < count; ++i) {
+			radius[i] *= scale;
+		}
+	}
+
+	std::vector<Loop> Transform(const std::vector<Transform2d> &placements, const Loop &loop) {
+		auto source = ToArrays(loop);
+		auto placed = source;
+		auto loops = std::vector<Loop>{};
+		loops.reserve(placements.size());
+		for(const auto &xf : placements) {
+			placed.x0 = source.x0;
+			placed.y0 = source.y0;
+			placed.x1 = source.x1;
+			placed.y1 = source.y1;
+			placed.cx = source.cx;
+			placed.cy = source.cy;
+			placed.radius = source.radius;
+			Transform(xf, placed);
+			loops.push_back(ToLoop(placed));
+		}
+		return loops;
+	}
+
+	LoopInstance::LoopInstance(std::shared_ptr<const Loop> loop, const Transform2d &placement)
+	: loop_(std::move(loop))
+	, placement_(placement)
+	{}
+
+	Curve LoopInstance::CurveAt(size_t i) const {
+		return Transform(placement_, loop_->curves()[i]);
+	}
+
+	Box2d LoopInstance::Bounds() const {
+		const auto &box = loop_->Metrics().bounds;
+		Point2d corners[4] = {
+			Transform(placement_, box.min),
+			Transform(placement_, Point2d(box.max[0], box.min[1])),
+			Transform(placement_, box.max),
+			Transform(placement_, Point2d(box.min[0], box.max[1]))
+		};
+		auto result = Box2d{corners[0], corners[0]};
+		for(const auto &pt : corners) {
+			result.min = Point2d(std::min(result.min[0], pt[0]), std::min(result.min[1], pt[1]));
+			result.max = Point2d(std::max(result.max[0], pt[0]), std::max(result.max[1], pt[1]));
+		}
+		return result;
+	}
+
+	Loop LoopInstance::Materialize() const {
+		return Transform(placement_, *loop_);
+	}
+
+	LoopInstance LoopInstance::Offset(float amt) const {
+		if(!IsSimilarity(placement_)) {
+			return LoopInstance(std::make_shared<const Loop>(Materialize().Offset(amt)), IdentityTransform());
+		}
+		auto local = std::make_shared<const Loop>(loop_->Offset(amt / RadiusScale(placement_)));
+		return LoopInstance(std::move(local), placement_);
+	}
+
+	bool Overlaps(const Box2d &a, const Box2d &b) {
+		return a.min[0] <= b.max[0] && b.min[0] <= a.max[0] && a.min[1] <= b.max[1] && b.min[1] <= a.max[1];
+	}
+
+	std::vector<Point2d> Intersect(const LoopInstance &a, const LoopInstance &b) {
+		auto pts = std::vector<Point2d>{};
+		if(!Overlaps(a.Bounds(), b.Bounds())) {
+			return pts;
+		}
+
+		// Sort-and-sweep over x extents in a's frame, testing only pairs
+		// with one curve from each loop
+		const auto &curves_a = a.loop().curves();
+		auto to_a = Compose(Inverse(a.placement()), b.placement());
+		auto curves_b = std::vector<Curve>{};
+		curves_b.reserve(b.size());
+		for(const auto &curve : b.loop().curves()) {
+			curves_b.push_back(Transform(to_a, curve));
+		}
+
+		struct Entry{
+			Box2d bounds;
+			uint32_t index;
+			uint8_t set;
+		};
+		auto entries = std::vector<Entry>{};
+		entries.reserve(curves_a.size() + curves_b.size());
+		for(uint32_t i=0; i < curves_a.size(); ++i) {
+			entries.push_back(Entry{Bounds(curves_a[i]), i, 0});
+		}
+		for(uint32_t i=0; i < curves_b.size(); ++i) {
+			entries.push_back(Entry{Bounds(curves_b[i]), i, 1});
+		}
+		std::sort(entries.begin(), entries.end(), [](const Entry &e0, const Entry &e1) {
+			return e0.bounds.min[0] < e1.bounds.min[0];
+		});
+
+		std::vector<uint32_t> active[2];
+		for(const auto &entry : entries) {
+			auto &others = active[1 - entry.set];
+			for(size_t k=0; k < others.size();) {
+				const auto &other = entries[others[k]];
+				if(other.bounds.max[0] < entry.bounds.min[0]) {
+					others[k] = others.back();
+					others.pop_back();
+					continue;
+				}
+				++k;
+				if(!Overlaps(entry.bounds, other.bounds)) {
+					continue;
+				}
+				const auto &curve_a = entry.set == 0 ? curves_a[entry.index] : curves_a[other.index];
+				const auto &curve_b = entry.set == 0 ? curves_b[other.index] : curves_b[entry.index];
+				for(const auto &pt : Intersect(curve_a, curve_b)) {
+					pts.push_back(Transform(a.placement(), pt));
+				}
+			}
+			active[entry.set].push_back(uint32_t(&entry - entries.data()));
+		}
+		return pts;
+	}
+
+	std::vector<LoopInstance> Offset(const std::vector<LoopInstance> &instances, float amt) {
+		auto shared = std::map<std::pair<const Loop*, float>, std::shared_ptr<const Loop>>{};
+		auto result = std::vector<LoopInstance>{};
+		result.reserve(instances.size());
+		for(const auto &instance : instances) {
+			if(!IsSimilarity(instance.placement())) {
+				result.push_back(instance.Offset(amt));
+				continue;
+			}
+			auto local_amt = amt / RadiusScale(instance.placement());
+			auto &offset = shared[std::make_pair(&instance.loop(), local_amt)];
+			if(!offset) {
+				offset = std::make_shared<const Loop>(instance.loop().Offset(local_amt));
+			}
+			result.push_back(LoopInstance(offset, instance.placement()));
+		}
+		return result;
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef transform_hpp
+#define transform_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace planar {
+
+	// Affine map x' = xx * x + xy * y + tx, y' = yx * x + yy * y + ty.
+	// Circles and arcs stay circular under similarities (rotations,
+	// reflections, uniform scales and translations); radii are scaled by
+	// sqrt(|det|) and change sign under reflections, which reverse the
+	// direction of travel. Other maps are applied to the points exactly and
+	// to the radii only approximately.
+	struct Transform2d{
+		float xx;
+		float xy;
+		float yx;
+		float yy;
+		float tx;
+		float ty;
+	};
+
+	Transform2d IdentityTransform();
+	Transform2d Translation(const Vec2d &offset);
+	// CCW by angle radians about the origin or a center
+	Transform2d Rotation(float angle);
+	Transform2d Rotation(float angle, const Point2d &center);
+	Transform2d Scaling(float scale);
+	// Mirror across the line through pt along direction
+	Transform2d Reflection(const Point2d &pt, const Vec2d &direction);
+
+	// Apply second, then first
+	Transform2d Compose(const Transform2d &first, const Transform2d &second);
+	Transform2d Inverse(const Transform2d &xf);
+	float Determinant(const Transform2d &xf);
+	// Whether xf scales all lengths alike, keeping circles circular
+	bool IsSimilarity(const Transform2d &xf);
+
+	Point2d Transform(const Transform2d &xf, const Point2d &pt);
+	LineSegment Transform(const Transform2d &xf, const LineSegment &segment);
+	Circle Transform(const Transform2d &xf, const Circle &circle);
+	Arc Transform(const Transform2d &xf, const Arc &arc);
+	Curve Transform(const Transform2d &xf, const Curve &curve);
+	Loop Transform(const Transform2d &xf, const Loop &loop);
+
+	// Transform points in place; a branch-free loop the compiler vectorizes
+	void Transform(const Transform2d &xf, float *x, float *y, size_t count);
+
+	// Curves as structure of arrays for batch transforms. Every curve has a
+	// start, an end, a center and a radius: lines have radius 0 and their
+	// start as center, circles their center as start and end.
+	struct CurveArrays{
+		std::vector<uint8_t> types;
+		std::vector<float> x0;
+		std::vector<float> y0;
+		std::vector<float> x1;
+		std::vector<float> y1;
+		std::vector<float> cx;
+		std::vector<float> cy;
+		std::vector<float> radius;
+	};
+
+	CurveArrays ToArrays(const Loop &loop);
+	Loop ToLoop(const CurveArrays &curves);
+	void Transform(const Transform2d &xf, CurveArrays &curves);
+
+	// Step and repeat: the loop placed by each transform, unpacking it once
+	std::vector<Loop> Transform(const std::vector<Transform2d> &placements, const Loop &loop);
+
+	// A placement of a shared loop. The curves are transformed only when
+	// they're needed, one at a time, so many instances cost one copy of
+	// the geometry.
+	class LoopInstance{
+	public:
+		LoopInstance(std::shared_ptr<const Loop> loop, const Transform2d &placement);
+
+		const Loop& loop() const { return *loop_; }
+		const std::shared_ptr<const Loop>& shared_loop() const { return loop_; }
+		const Transform2d& placement() const { return placement_; }
+		size_t size() const { return loop_->curves().size(); }
+
+		// Curve i in place
+		Curve CurveAt(size_t i) const;
+		// The placed loop's bounds, or a box around them for rotations
+		Box2d Bounds() const;
+		// A copy of the placed loop
+		Loop Materialize() const;
+
+		// Offsetting commutes with similarities, so this offsets the
+		// shared loop (by amt over the scale, negated for mirror images)
+		// and places the result with the same transform. Other placements
+		// stretch distances unevenly: the placed loop is offset instead and
+		// the result placed with the identity.
+		LoopInstance Offset(float amt) const;
+
+	private:
+		std::shared_ptr<const Loop> loop_;
+		Transform2d placement_;
+	};
+
+	// Crossings of two placed loops, in world coordinates. Only b's curves
+	// are transformed, into a's frame, and the crossings mapped back out.
+	std::vector<Point2d> Intersect(const LoopInstance &a, const LoopInstance &b);
+
+	// Offset every instance, computing each distinct (loop, scale) pair
+	// once and sharing the result between its instances. Instances placed
+	// by other than a similarity are offset on their own.
+	std::vector<LoopInstance> Offset(const std::vector<LoopInstance> &instances, float amt);
+}
+
+#endif
@@ -0,0 +1,93 @@
+#include "weld.hpp"
+#include "boolean.hpp"
+#include <cmath>
+
+namespace planar {
+
+	const uint32_t kNoVertex = 0xffffffff;
+
+	VertexWelder::VertexWelder(float tolerance)
+	: tolerance_(tolerance),
+		inv_cell_(1.0 / double(tolerance))
+	{}
+
+	int64_t VertexWelder::Cell(float v) const {
+		return int64_t(std::floor(double(v) * inv_cell_));
+	}
+
+	uint64_t VertexWelder::Key(int64_t x, int64_t y) {
+		return (uint64_t(x) * 0x9e3779b97f4a7c15ull) ^ uint64_t(y);
+	}
+
+	int64_t VertexWelder::Find(const Point2d &pt) const {
+		auto cx = Cell(pt[0]);
+		auto cy = Cell(pt[1]);
+		auto tol2 = tolerance_ * tolerance_;
+		auto best = kNoVertex;
+		for(auto x=cx - 1; x <= cx + 1; ++x) {
+			for(auto y=cy - 1; y <= cy + 1; ++y) {
+				auto cell = cells_.find(Key(x, y));
+				if(cell == cells_.end()) {
+					continue;
+				}
+				for(auto id=cell->second; id != kNoVertex; id=next_[id]) {
+					auto d = vertices_[id] - pt;
+					if(id < best && (d <= d)[0] <= tol2) {
+						best = id;
+					}
+				}
+			}
+		}
+		return best == kNoVertex ? -1 : int64_t(best);
+	}
+
+	uint32_t VertexWelder::Weld(const Point2d &pt) {
+		auto found = Find(pt);
+		if(found >= 0) {
+			return uint32_t(found);
+		}
+		auto id = uint32_t(vertices_.size());
+		vertices_.push_back(pt);
+		// Colliding keys just share a chain; distances are always checked
+		auto cell = cells_.emplace(Key(Cell(pt[0]), Cell(pt[1])), id);
+		next_.push_back(cell.second ? kNoVertex : cell.first->second);
+		cell.first->second = id;
+		return id;
+	}
+
+	void VertexWelder::clear() {
+		vertices_.clear();
+		cells_.clear();
+		next_.clear();
+	}
+
+	CurveVertices WeldIntersections(const std::vector<Curve> &curves, float tolerance) {
+		auto result = CurveVertices{};
+		auto welder = VertexWelder(tolerance);
+		for(const auto &fragments : SplitAtIntersections(curves, tolerance)) {
+			auto first = true;
+			for(const auto &fragment : fragments) {
+				auto endpoints = Endpoints(fragment);
+				if(endpoints.empty()) {
+					continue;
+				}
+				if(first) {
+					result.ids.push_back(welder.Weld(endpoints[0]));
+					first = false;
+				}
+				result.ids.push_back(welder.Weld(endpoints[1]));
+			}
+			result.offsets.push_back(uint32_t(result.ids.size()));
+		}
+		result.vertices = welder.vertices();
+		return result;
+	}
+
+	CurveVertices WeldIntersections(const std::vector<Loop> &loops, float tolerance) {
+		auto curves = std::vector<Curve>{};
+		for(const auto &loop : loops) {
+			curves.insert(curves.end(), loop.curves().begin(), loop.curves().end());
+		}
+		return WeldIntersections(curves, tolerance);
+	}
+}
@@ -0,0 +1,58 @@
+#ifndef weld_hpp
+#define weld_hpp
+
+#include "primitives.hpp"
+#include "loop.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace planar {
+
+	// Assigns the same id to points within tolerance of each other using a
+	// hash grid of tolerance sized cells, so each Weld is expected O(1).
+	// Ids are handed out in insertion order and a point joins the lowest id
+	// in reach, so the result only depends on the order of the points.
+	// tolerance must be positive.
+	class VertexWelder{
+	public:
+		VertexWelder(float tolerance);
+
+		uint32_t Weld(const Point2d &pt);
+		// Id of an existing vertex within tolerance of pt, or -1
+		int64_t Find(const Point2d &pt) const;
+
+		// Position of each id: the first point welded to it
+		const std::vector<Point2d>& vertices() const { return vertices_; }
+		size_t size() const { return vertices_.size(); }
+		float tolerance() const { return tolerance_; }
+		void clear();
+
+	private:
+		int64_t Cell(float v) const;
+		static uint64_t Key(int64_t x, int64_t y);
+
+		float tolerance_;
+		double inv_cell_;
+		std::vector<Point2d> vertices_;
+		// Vertices in a cell are chained from cells_ through next_
+		std::unordered_map<uint64_t, uint32_t> cells_;
+		std::vector<uint32_t> next_;
+	};
+
+	// Welded vertices of a set of curves split at all their intersections.
+	// Curve i passes through vertices ids[offsets[i]] to ids[offsets[i + 1]
+	// - 1] in order along it, starting and ending at its end points; an
+	// uncut Circle has none.
+	struct CurveVertices{
+		std::vector<Point2d> vertices;
+		std::vector<uint32_t> offsets{0};
+		std::vector<uint32_t> ids;
+	};
+
+	// Curves are numbered by loop and then by position in the loop
+	CurveVertices WeldIntersections(const std::vector<Curve> &curves, float tolerance);
+	CurveVertices WeldIntersections(const std::vector<Loop> &loops, float tolerance);
+}
+
+#endif
@@ -1,6 +1,30 @@
 #include "lest/lest.hpp"
 #include "primitives.hpp"
+#include "loop.hpp"
+#include "containment.hpp"
+#include "boolean.hpp"
+#include "distance.hpp"
+#include "flatten.hpp"
+#include "offset.hpp"
+#include "io.hpp"
+#include "import.hpp"
+#include "simplify.hpp"
+#include "fit.hpp"
+#include "weld.hpp"
+#include "quantize.hpp"
+#include "cache.hpp"
+#include "clip.hpp"
+#include "queue.hpp"
+#include "tile.hpp"
+#include "region.hpp"
+#include "transform.hpp"
+#include "async.hpp"
+#include "tessellate.hpp"
+#include "raster.hpp"
+#include "minkowski.hpp"
+#include <chrono>
 #include <cmath>
+#include <type_traits>
 
 // void TestMarchingCubes(lest::env &lest_env, int size, F f)
 // EXPECT(v_old->x == lest::approx(v_new.pos.x));
@@ -21,6 +45,22 @@ void TestIntersection(
 	}
 }
 
+planar::Loop Square(const planar::Point2d &center, float half_size) {
+	using LineSegment = planar::LineSegment;
+	using P2D = planar::Point2d;
+
+	auto x0 = center[0] - half_size;
+	auto x1 = center[0] + half_size;
+	auto y0 = center[1] - half_size;
+	auto y1 = center[1] + half_size;
+	return planar::Loop(std::vector<planar::Curve>{
+		LineSegment{P2D(x1, y1), P2D(x0, y1)},
+		LineSegment{P2D(x0, y1), P2D(x0, y0)},
+		LineSegment{P2D(x0, y0), P2D(x1, y0)},
+		LineSegment{P2D(x1, y0), P2D(x1, y1)}
+	});
+}
+
 // clang-format off
 const lest::test specification[] = {
 	CASE("Test LineSegment-LineSegment Intersections") {
@@ -399,7 +439,1468 @@ const lest::test specification[] = {
             planar::ArcWithDirectionAndAngle(P2D(1.5, 0.), 1., P2D(0., 1.), M_PI),
             {P2D(0.75, std::sqrt(1. - 0.75*0.75))}
         );
-    }
+    },
+	CASE("Test Loop Winding Numbers") {
+		using P2D = planar::Point2d;
+
+		auto square = Square(P2D(0., 0.), 1.);
+		EXPECT(planar::WindingNumber(square, P2D(0., 0.)) == 1);
+		EXPECT(planar::WindingNumber(square, P2D(0.5, 0.9)) == 1);
+		EXPECT(planar::WindingNumber(square, P2D(1.5, 0.)) == 0);
+		EXPECT(planar::WindingNumber(square, P2D(0., -1.5)) == 0);
+
+		auto ring = std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), 2.}}),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), -1.}})
+		};
+		EXPECT(planar::Contains(ring, P2D(1.5, 0.)));
+		EXPECT(planar::Contains(ring, P2D(0., -1.5)));
+		EXPECT(!planar::Contains(ring, P2D(0.5, 0.)));
+		EXPECT(!planar::Contains(ring, P2D(2.5, 0.)));
+
+		auto half_disc = planar::Loop(std::vector<planar::Curve>{
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(0., 1.), M_PI),
+			planar::LineSegment{P2D(-1., 0.), P2D(1., 0.)}
+		});
+		EXPECT(planar::WindingNumber(half_disc, P2D(0., 0.5)) == 1);
+		EXPECT(planar::WindingNumber(half_disc, P2D(0., -0.5)) == 0);
+		EXPECT(planar::WindingNumber(half_disc, P2D(0.8, 0.8)) == 0);
+	},
+	CASE("Test Loop Boolean Operations") {
+		using P2D = planar::Point2d;
+
+		auto a = std::vector<planar::Loop>{Square(P2D(0., 0.), 1.)};
+		auto b = std::vector<planar::Loop>{Square(P2D(1., 1.), 1.)};
+
+		auto unioned = planar::Union(a, b);
+		EXPECT(unioned.size() == 1u);
+		EXPECT(unioned[0].curves().size() == 8u);
+		EXPECT(planar::Contains(unioned, P2D(1.5, 1.5)));
+		EXPECT(planar::Contains(unioned, P2D(-0.5, -0.5)));
+		EXPECT(!planar::Contains(unioned, P2D(1.5, -0.5)));
+
+		auto intersected = planar::Intersection(a, b);
+		EXPECT(intersected.size() == 1u);
+		EXPECT(intersected[0].curves().size() == 4u);
+		EXPECT(planar::Contains(intersected, P2D(0.5, 0.5)));
+		EXPECT(!planar::Contains(intersected, P2D(-0.5, -0.5)));
+
+		auto difference = planar::Difference(a, b);
+		EXPECT(difference.size() == 1u);
+		EXPECT(difference[0].curves().size() == 6u);
+		EXPECT(planar::Contains(difference, P2D(-0.5, -0.5)));
+		EXPECT(!planar::Contains(difference, P2D(0.5, 0.5)));
+
+		// Arcs stay arcs
+		auto disc = std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(1., 0.), 0.5}})
+		};
+		auto rounded = planar::Union(a, disc);
+		EXPECT(rounded.size() == 1u);
+		auto arcs = 0;
+		for(const auto &curve : rounded[0].curves()) {
+			arcs += TargetType(curve) == planar::Curve::CurveType::Arc;
+		}
+		EXPECT(arcs == 1);
+		EXPECT(planar::Contains(rounded, P2D(1.4, 0.)));
+
+		auto islands = planar::Union(std::vector<planar::Loop>{
+			Square(P2D(0., 0.), 1.), Square(P2D(1.5, 0.), 1.), Square(P2D(10., 0.), 1.)
+		});
+		EXPECT(islands.size() == 2u);
+
+		// Vertices of a fine polygon lie near, not on, the other's edges
+		auto polygon = [](P2D center, double radius, int count) {
+			auto curves = std::vector<planar::Curve>{};
+			auto pt = [&](int i) {
+				auto angle = 2. * M_PI * double(i % count) / double(count);
+				return center + P2D(float(radius * std::cos(angle)), float(radius * std::sin(angle)));
+			};
+			for(int i=0; i < count; ++i) {
+				curves.push_back(planar::LineSegment{pt(i), pt(i + 1)});
+			}
+			return std::vector<planar::Loop>{planar::Loop(curves)};
+		};
+		auto lens = planar::Union(polygon(P2D(0., 0.), 100., 32000), polygon(P2D(50., 0.), 100., 64000));
+		EXPECT(lens.size() == 1u);
+		EXPECT(std::abs(planar::SignedArea(lens[0]) - 41310.8) < 1.);
+	},
+	CASE("Test Loop Winding Index") {
+		using P2D = planar::Point2d;
+
+		auto loops = std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{
+				planar::ArcWithDirectionAndAngle(P2D(0., 0.), 2., P2D(0., 1.), M_PI),
+				planar::LineSegment{P2D(-2., 0.), P2D(-2., -2.)},
+				planar::LineSegment{P2D(-2., -2.), P2D(2., -2.)},
+				planar::LineSegment{P2D(2., -2.), P2D(2., 0.)}
+			}),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., -0.5), -0.75}})
+		};
+		auto index = planar::WindingIndex(loops);
+
+		auto xs = std::vector<float>{};
+		auto ys = std::vector<float>{};
+		for(int i=0; i < 64; ++i) {
+			for(int j=0; j < 64; ++j) {
+				xs.push_back(-3.f + 6.f * (float(i) + 0.37f) / 64.f);
+				ys.push_back(-3.f + 6.f * (float(j) + 0.61f) / 64.f);
+			}
+		}
+		auto winding = std::vector<int>(xs.size());
+		planar::WindingNumbers(index, xs.data(), ys.data(), xs.size(), winding.data(), 4);
+		auto mismatches = 0;
+		for(size_t i=0; i < xs.size(); ++i) {
+			mismatches += winding[i] != planar::WindingNumber(loops, P2D(xs[i], ys[i]));
+		}
+		EXPECT(mismatches == 0);
+		EXPECT(index.Contains(P2D(0., 1.5)));
+		EXPECT(!index.Contains(P2D(0., -0.5)));
+		EXPECT(!index.Contains(P2D(1.9, 1.9)));
+
+		// Edges on cell boundaries, queried at the height of every vertex
+		auto stairs = std::vector<planar::Curve>{};
+		auto step = P2D(0., 0.);
+		for(int i=0; i < 40; ++i) {
+			auto right = step + P2D(1., 0.);
+			auto up = right + P2D(0., 1.);
+			stairs.push_back(planar::LineSegment{step, right});
+			stairs.push_back(planar::LineSegment{right, up});
+			step = up;
+		}
+		stairs.push_back(planar::LineSegment{step, P2D(0., 40.)});
+		stairs.push_back(planar::LineSegment{P2D(0., 40.), P2D(0., 0.)});
+		auto staircase = std::vector<planar::Loop>{planar::Loop(stairs)};
+		auto stairs_index = planar::WindingIndex(staircase);
+		auto stair_mismatches = 0;
+		for(int i=0; i <= 160; ++i) {
+			for(int j=0; j <= 40; ++j) {
+				auto pt = P2D(float(i) * 0.25f, float(j));
+				stair_mismatches += stairs_index.WindingNumber(pt) != planar::WindingNumber(staircase, pt);
+			}
+		}
+		EXPECT(stair_mismatches == 0);
+	},
+	CASE("Test Loop Signed Distance") {
+		using P2D = planar::Point2d;
+
+		auto square = Square(P2D(0., 0.), 1.);
+		EXPECT(planar::SignedDistance(planar::LineSegment{P2D(0., 0.), P2D(1., 0.)}, P2D(0.5, -2.)) == lest::approx(2.));
+		EXPECT(planar::SignedDistance(planar::LineSegment{P2D(0., 0.), P2D(1., 0.)}, P2D(0.5, 2.)) == lest::approx(-2.));
+		EXPECT(planar::SignedDistance(planar::Circle{P2D(0., 0.), -1.}, P2D(3., 0.)) == lest::approx(-2.));
+
+		auto closest = planar::ClosestPoint(square, P2D(0.25, 3.));
+		EXPECT(closest[0] == lest::approx(0.25));
+		EXPECT(closest[1] == lest::approx(1.));
+
+		auto loops = std::vector<planar::Loop>{
+			square,
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(3., 0.), 1.}})
+		};
+		auto index = planar::DistanceIndex(loops);
+		EXPECT(index.SignedDistance(P2D(0., 0.)) == lest::approx(-1.));
+		EXPECT(index.SignedDistance(P2D(3., 0.)) == lest::approx(-1.));
+		EXPECT(index.SignedDistance(P2D(1.5, 0.)) == lest::approx(0.5));
+		EXPECT(index.SignedDistance(P2D(-2., 2.)) == lest::approx(std::sqrt(2.)));
+
+		auto width = 32u;
+		auto height = 16u;
+		auto box = planar::Box2d{P2D(-2., -2.), P2D(5., 2.)};
+		auto field = std::vector<float>(width * height);
+		planar::DistanceField(index, box, width, height, field.data(), 2);
+		auto mismatches = 0;
+		for(uint32_t row=0; row < height; ++row) {
+			for(uint32_t col=0; col < width; ++col) {
+				auto pt = P2D(-2. + 7. * (col + 0.5) / width, -2. + 4. * (row + 0.5) / height);
+				auto dist = std::min((planar::ClosestPoint(loops[0], pt) - pt).norm(), (planar::ClosestPoint(loops[1], pt) - pt).norm());
+				if(planar::Contains(loops, pt)) {
+					dist = -dist;
+				}
+				mismatches += std::abs(field[row * width + col] - dist) > 1e-4f;
+			}
+		}
+		EXPECT(mismatches == 0);
+	},
+	CASE("Test Offset Engine") {
+		using LineSegment = planar::LineSegment;
+		using P2D = planar::Point2d;
+
+		auto square = planar::OffsetEngine(Square(P2D(0., 0.), 1.));
+		auto inner = square.Offset(-0.5);
+		EXPECT(inner.size() == 1u);
+		EXPECT(inner[0].curves().size() == 4u);
+		EXPECT(planar::Contains(inner, P2D(0.45, 0.45)));
+		EXPECT(!planar::Contains(inner, P2D(0.55, 0.)));
+		EXPECT(square.Offset(-1.5).empty());
+
+		auto outer = square.Offset(0.5);
+		EXPECT(outer.size() == 1u);
+		EXPECT(outer[0].curves().size() == 8u);
+		EXPECT(planar::Contains(outer, P2D(1.45, 0.)));
+		EXPECT(!planar::Contains(outer, P2D(1.45, 1.45)));
+
+		// A dumbbell pinches apart once the offset exceeds the half width
+		// of its handle
+		auto dumbbell = planar::OffsetEngine(planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(0., 0.), P2D(4., 0.)},
+			LineSegment{P2D(4., 0.), P2D(4., 1.5)},
+			LineSegment{P2D(4., 1.5), P2D(6., 1.5)},
+			LineSegment{P2D(6., 1.5), P2D(6., 0.)},
+			LineSegment{P2D(6., 0.), P2D(10., 0.)},
+			LineSegment{P2D(10., 0.), P2D(10., 4.)},
+			LineSegment{P2D(10., 4.), P2D(6., 4.)},
+			LineSegment{P2D(6., 4.), P2D(6., 2.5)},
+			LineSegment{P2D(6., 2.5), P2D(4., 2.5)},
+			LineSegment{P2D(4., 2.5), P2D(4., 4.)},
+			LineSegment{P2D(4., 4.), P2D(0., 4.)},
+			LineSegment{P2D(0., 4.), P2D(0., 0.)}
+		}));
+		auto passes = dumbbell.Offsets({-0.25f, -0.75f, -2.5f});
+		EXPECT(passes[0].size() == 1u);
+		EXPECT(planar::Contains(passes[0], P2D(5., 2.)));
+		EXPECT(passes[1].size() == 2u);
+		EXPECT(!planar::Contains(passes[1], P2D(5., 2.)));
+		EXPECT(planar::Contains(passes[1], P2D(2., 2.)));
+		EXPECT(planar::Contains(passes[1], P2D(8., 2.)));
+		EXPECT(passes[2].empty());
+
+		auto ring = planar::OffsetEngine(std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), 2.}}),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), -1.}})
+		});
+		auto thinner = ring.Offset(-0.25);
+		EXPECT(thinner.size() == 2u);
+		EXPECT(planar::Contains(thinner, P2D(1.5, 0.)));
+		EXPECT(!planar::Contains(thinner, P2D(1.2, 0.)));
+		EXPECT(ring.Offset(-0.6).empty());
+
+		// A comb whose teeth merge when grown, trimmed across threads
+		auto comb = std::vector<planar::Curve>{LineSegment{P2D(0., 0.), P2D(40., 0.)}};
+		for(int i=9; i >= 0; --i) {
+			auto x = float(i) * 4.f;
+			comb.push_back(LineSegment{P2D(x + 4.f, i == 9 ? 0.f : 2.f), P2D(x + 4.f, 10.)});
+			comb.push_back(LineSegment{P2D(x + 4.f, 10.), P2D(x + 2.f, 10.)});
+			comb.push_back(LineSegment{P2D(x + 2.f, 10.), P2D(x + 2.f, 2.)});
+			comb.push_back(LineSegment{P2D(x + 2.f, 2.), P2D(x, 2.)});
+		}
+		comb.push_back(LineSegment{P2D(0., 2.), P2D(0., 0.)});
+		auto engine = planar::OffsetEngine(planar::Loop(comb), 4);
+		for(auto amt : {0.5f, 1.5f, -0.25f}) {
+			auto expected = engine.Offset(amt);
+			auto result = engine.Offset(amt, 4);
+			EXPECT(result.size() == expected.size());
+			EXPECT(planar::Contains(result, P2D(3., 5.)) == planar::Contains(expected, P2D(3., 5.)));
+			EXPECT(planar::Contains(result, P2D(1., 5.)) == planar::Contains(expected, P2D(1., 5.)));
+		}
+		EXPECT(engine.Offset(1.5f).size() == 1u);
+		EXPECT(planar::Contains(engine.Offset(1.5f), P2D(1., 5.)));
+		EXPECT(planar::Contains(engine.Offset(-0.25f), P2D(3., 5.)));
+		EXPECT(!planar::Contains(engine.Offset(-0.25f), P2D(1., 5.)));
+
+		// Every pass of a pocket with arcs, corners and an island lies at
+		// its distance from the source, in closed loops
+		auto pocket = std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{
+				LineSegment{P2D(0., 0.), P2D(8., 0.)},
+				planar::Arc{planar::Circle{P2D(8., 2.), 2.}, LineSegment{P2D(8., 0.), P2D(8., 4.)}},
+				LineSegment{P2D(8., 4.), P2D(5., 4.)},
+				LineSegment{P2D(5., 4.), P2D(4., 2.5)},
+				LineSegment{P2D(4., 2.5), P2D(3., 4.)},
+				LineSegment{P2D(3., 4.), P2D(0., 4.)},
+				LineSegment{P2D(0., 4.), P2D(0., 0.)}
+			}),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(7.5, 2.), -0.5}})
+		};
+		auto distance = planar::DistanceIndex(pocket);
+		auto amts = std::vector<float>{-0.2f, -0.4f, -0.7f, -1.1f, -1.3f, 0.3f};
+		auto pocket_passes = planar::OffsetEngine(pocket).Offsets(amts);
+		for(const auto &pass : pocket_passes) {
+			EXPECT(!pass.empty());
+		}
+		// The island merges into the outline, then the notch pinches it
+		EXPECT(pocket_passes[2].size() == 2u);
+		EXPECT(pocket_passes[3].size() == 1u);
+		EXPECT(pocket_passes[4].size() == 2u);
+		EXPECT(pocket_passes[5].size() == 2u);
+		auto exact = true;
+		auto closed = true;
+		for(size_t i=0; i < pocket_passes.size(); ++i) {
+			for(const auto &loop : pocket_passes[i]) {
+				const auto &curves = loop.curves();
+				for(size_t j=0; j < curves.size(); ++j) {
+					exact = exact && std::abs(distance.SignedDistance(planar::Midpoint(curves[j])) - amts[i]) < 1e-3f;
+					auto endpoints = planar::Endpoints(curves[j]);
+					if(!endpoints.empty()) {
+						exact = exact && std::abs(distance.SignedDistance(endpoints[0]) - amts[i]) < 1e-3f;
+						auto next = planar::Endpoints(curves[(j + 1) % curves.size()]);
+						closed = closed && (next[0] - endpoints[1]).norm() < 1e-3f;
+					}
+				}
+			}
+		}
+		EXPECT(exact);
+		EXPECT(closed);
+
+		// A densely discretized wavy circle offsets to one closed loop,
+		// indexed in well under quadratic time
+		auto wavy = std::vector<P2D>{};
+		for(int i=0; i < 2000; ++i) {
+			auto angle = 2. * M_PI * double(i) / 2000.;
+			auto r = 100. + 5. * std::sin(37. * angle);
+			wavy.push_back(P2D(float(r * std::cos(angle)), float(r * std::sin(angle))));
+		}
+		auto wavy_curves = std::vector<planar::Curve>{};
+		for(size_t i=0; i < wavy.size(); ++i) {
+			wavy_curves.push_back(LineSegment{wavy[i], wavy[(i + 1) % wavy.size()]});
+		}
+		auto start = std::chrono::steady_clock::now();
+		auto wavy_engine = planar::OffsetEngine(planar::Loop(wavy_curves));
+		EXPECT(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+		auto wavy_pass = wavy_engine.Offset(-3.f);
+		EXPECT(wavy_pass.size() == 1u);
+		auto wavy_closed = !wavy_pass.empty();
+		for(const auto &loop : wavy_pass) {
+			const auto &curves = loop.curves();
+			for(size_t j=0; j < curves.size(); ++j) {
+				auto next = planar::Endpoints(curves[(j + 1) % curves.size()]);
+				wavy_closed = wavy_closed && (next[0] - planar::Endpoints(curves[j])[1]).norm() < 1e-3f;
+			}
+		}
+		EXPECT(wavy_closed);
+		EXPECT(planar::Contains(wavy_pass, P2D(0., 0.)));
+		EXPECT(!planar::Contains(wavy_pass, P2D(99., 0.)));
+	},
+	CASE("Test Loop Flattening") {
+		using P2D = planar::Point2d;
+
+		EXPECT(planar::SegmentCount(1., 2. * M_PI, 2.) == 1u);
+		EXPECT(planar::SegmentCount(1., M_PI, 1. - std::cos(M_PI_4)) == 2u);
+		EXPECT(planar::SegmentCount(1000., 2. * M_PI, 1e-5) == 22215u);
+		EXPECT(planar::SegmentCount(1., M_PI, 0.) == planar::kMaxArcSegments);
+		EXPECT(planar::SegmentCount(1e6, 2. * M_PI, 1e-9) == planar::kMaxArcSegments);
+
+		auto buffer = planar::VertexBuffer{};
+		auto loops = std::vector<planar::Loop>{
+			Square(P2D(0., 0.), 1.),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(5., 0.), 2.}}),
+			planar::Loop(std::vector<planar::Curve>{
+				planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(0., 1.), M_PI),
+				planar::LineSegment{P2D(-1., 0.), P2D(1., 0.)}
+			})
+		};
+		auto tolerance = 1e-3f;
+		planar::Flatten(loops, tolerance, buffer);
+		EXPECT(buffer.loop_count() == 3u);
+		EXPECT(buffer.offsets[1] == 4u);
+		EXPECT(buffer.offsets[3] == buffer.vertex_count());
+
+		// Every vertex is on the curve and every chord midpoint is within
+		// tolerance of it
+		auto circle_error = 0.f;
+		for(auto i=buffer.offsets[1]; i < buffer.offsets[2]; ++i) {
+			auto j = i + 1 < buffer.offsets[2] ? i + 1 : buffer.offsets[1];
+			auto p0 = P2D(buffer.xy[2 * i], buffer.xy[2 * i + 1]);
+			auto p1 = P2D(buffer.xy[2 * j], buffer.xy[2 * j + 1]);
+			EXPECT((p0 - P2D(5., 0.)).norm() == lest::approx(2.));
+			circle_error = std::max(circle_error, 2.f - ((p0 + p1) * 0.5f - P2D(5., 0.)).norm());
+		}
+		EXPECT(circle_error <= tolerance * 1.01f);
+		EXPECT(circle_error >= tolerance * 0.5f);
+
+		auto last = buffer.offsets[3] - 1;
+		EXPECT(buffer.xy[2 * last] == lest::approx(-1.));
+		EXPECT(buffer.xy[2 * last + 1] == lest::approx(0.));
+
+		// Thousands of rotation steps don't drift off the circle
+		auto fine = std::vector<float>{};
+		planar::Flatten(planar::Circle{P2D(0., 0.), 100.}, 1e-5f, fine);
+		auto fine_count = fine.size() / 2;
+		EXPECT(fine_count > 5000u);
+		auto drift = 0.;
+		for(size_t i=0; i < fine_count; ++i) {
+			auto angle = 2. * M_PI * double(i) / double(fine_count);
+			drift = std::max(drift, std::hypot(fine[2 * i] - 100. * std::cos(angle), fine[2 * i + 1] - 100. * std::sin(angle)));
+		}
+		EXPECT(drift <= 1e-5);
+
+		buffer.clear();
+		EXPECT(buffer.loop_count() == 0u);
+		EXPECT(buffer.vertex_count() == 0u);
+	},
+	CASE("Test Loop Text Format") {
+		using P2D = planar::Point2d;
+
+		auto loop = planar::Loop(std::vector<planar::Curve>{
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(0., 1.), M_PI),
+			planar::LineSegment{P2D(-1., 0.), P2D(1., 0.)}
+		});
+		auto text = std::string{};
+		planar::WriteLoop(loop, text);
+		EXPECT(text.back() == '\n');
+
+		auto parsed = planar::Loop(std::vector<planar::Curve>{});
+		EXPECT(planar::ParseLoop(text, parsed));
+		auto again = std::string{};
+		planar::WriteLoop(parsed, again);
+		EXPECT(again == text);
+
+		EXPECT(planar::ParseLoop(std::string("C 5 0 2"), parsed));
+		EXPECT(parsed.curves().size() == 1u);
+		EXPECT(!planar::ParseLoop(std::string("# comment"), parsed));
+		EXPECT(!planar::ParseLoop(std::string(""), parsed));
+		EXPECT(!planar::ParseLoop(std::string("L 0 0 1"), parsed));
+		EXPECT(!planar::ParseLoop(std::string("L 0 0 1 x"), parsed));
+
+		planar::BoundedQueue<int> queue(2);
+		EXPECT(queue.Push(1));
+		EXPECT(queue.Push(2));
+		queue.Close();
+		EXPECT(!queue.Push(3));
+		auto value = 0;
+		EXPECT(queue.Pop(value));
+		EXPECT(value == 1);
+		EXPECT(queue.Pop(value));
+		EXPECT(value == 2);
+		EXPECT(!queue.Pop(value));
+		EXPECT(queue.max_depth() == 2u);
+	},
+	CASE("Test SVG and DXF Import") {
+		using P2D = planar::Point2d;
+
+		auto value = 0.f;
+		auto number = std::string("-1.25e-2,7");
+		auto it = number.data();
+		EXPECT(planar::ParseFloat(it, number.data() + number.size(), value));
+		EXPECT(value == -1.25e-2f);
+		EXPECT(*it == ',');
+
+		// Unit square, then a CCW half disk written with relative commands
+		auto loops = std::vector<planar::Loop>{};
+		EXPECT(planar::ImportSvgPath(std::string(
+			"M0,0 H1 V1 L0 1 Z "
+			"m3 0 h2 a1 1 0 0 1 -2 0z "
+			"M10 10 l1 0"), loops));
+		EXPECT(loops.size() == 2u);
+		EXPECT(loops[0].curves().size() == 4u);
+		EXPECT(planar::WindingNumber(loops[0], P2D(0.5, 0.5)) == 1);
+		EXPECT(loops[1].curves().size() == 2u);
+		EXPECT(planar::WindingNumber(loops[1], P2D(4., 0.5)) == 1);
+		EXPECT(planar::WindingNumber(loops[1], P2D(4., -0.5)) == 0);
+		EXPECT(!planar::ImportSvgPath(std::string("M0 0 C1 1 2 2 3 3"), loops));
+		EXPECT(!planar::ImportSvgPath(std::string("M0 0 A1 2 0 0 1 1 0"), loops));
+
+		// Closed square polyline with a half disk bulge on top, and a circle
+		auto dxf = std::string(
+			"0\nSECTION\n2\nENTITIES\n"
+			"0\nLWPOLYLINE\n90\n4\n70\n1\n"
+			" 10\n0.0\n 20\n0.0\n"
+			" 10\n0.0\n 20\n-2.0\n"
+			" 10\n2.0\n 20\n-2.0\n"
+			" 10\n2.0\n 20\n0.0\n 42\n1.0\n"
+			"0\nCIRCLE\n10\n5\n20\n5\n40\n2\n"
+			"0\nENDSEC\n0\nEOF\n");
+		loops.clear();
+		EXPECT(planar::ImportDxf(dxf.data(), dxf.data() + dxf.size(), loops));
+		EXPECT(loops.size() == 2u);
+		EXPECT(loops[0].curves().size() == 4u);
+		EXPECT(planar::WindingNumber(loops[0], P2D(1., 0.9)) == 1);
+		EXPECT(planar::WindingNumber(loops[0], P2D(1.9, 0.9)) == 0);
+		EXPECT(planar::WindingNumber(loops[0], P2D(1., -1.)) == 1);
+		EXPECT(planar::WindingNumber(loops[1], P2D(5., 6.)) == 1);
+		EXPECT(!planar::ImportDxf(dxf.data(), dxf.data() + dxf.find("40\n2") + 3, loops));
+	},
+	CASE("Test Loop Simplification") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+
+		// Square with split edges, a zero length piece and a run that wraps
+		// past the first curve
+		auto square = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(0., 0.), P2D(1., 0.)},
+			LineSegment{P2D(1., 0.), P2D(2., 0.)},
+			LineSegment{P2D(2., 0.), P2D(2., 1.)},
+			LineSegment{P2D(2., 1.), P2D(2., 1.)},
+			LineSegment{P2D(2., 1.), P2D(2., 2.)},
+			LineSegment{P2D(2., 2.), P2D(0., 2.)},
+			LineSegment{P2D(0., 2.), P2D(0., 1.)},
+			LineSegment{P2D(0., 1.), P2D(0., 0.)}
+		});
+		EXPECT(planar::Simplify(square, 1e-4) == 4u);
+		EXPECT(square.curves().size() == 4u);
+		EXPECT(planar::WindingNumber(square, P2D(1., 1.)) == 1);
+		EXPECT(planar::WindingNumber(square, P2D(3., 1.)) == 0);
+
+		// Nearly collinear pieces only merge while within tolerance
+		auto bent = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(0., 0.), P2D(1., 0.01)},
+			LineSegment{P2D(1., 0.01), P2D(2., 0.)},
+			LineSegment{P2D(2., 0.), P2D(1., 1.)},
+			LineSegment{P2D(1., 1.), P2D(0., 0.)}
+		});
+		EXPECT(planar::Simplify(bent, 1e-3) == 0u);
+		EXPECT(planar::Simplify(bent, 0.1) == 1u);
+
+		// Quarter arcs of one circle merge into the circle itself
+		auto circle = planar::Loop(std::vector<planar::Curve>{
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(0., 1.), M_PI_2),
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(-1., 0.), M_PI_2),
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(0., -1.), M_PI_2),
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(1., 0.), M_PI_2)
+		});
+		EXPECT(planar::Simplify(circle, 1e-4) == 3u);
+		EXPECT(TargetType(circle.curves()[0]) == planar::Curve::CurveType::Circle);
+
+		auto half_disk = planar::Loop(std::vector<planar::Curve>{
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(1., 1.), M_PI_2),
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(-1., 1.), M_PI_2),
+			LineSegment{P2D(-1., 0.), P2D(1., 0.)}
+		});
+		EXPECT(planar::Simplify(half_disk, 1e-4) == 1u);
+		EXPECT(planar::WindingNumber(half_disk, P2D(0., 0.9)) == 1);
+		EXPECT(planar::WindingNumber(half_disk, P2D(0., -0.5)) == 0);
+	},
+	CASE("Test Arc Fitting") {
+		using P2D = planar::Point2d;
+
+		// Dense CCW stadium: two straight sides and two half circles
+		auto pts = std::vector<P2D>{};
+		for(int i=0; i < 50; ++i) {
+			pts.push_back(P2D(-5. + 10. * i / 50., -2.));
+		}
+		for(int i=0; i < 100; ++i) {
+			auto theta = -M_PI_2 + M_PI * i / 100.;
+			pts.push_back(P2D(5. + 2. * std::cos(theta), 2. * std::sin(theta)));
+		}
+		for(int i=0; i < 50; ++i) {
+			pts.push_back(P2D(5. - 10. * i / 50., 2.));
+		}
+		for(int i=0; i < 100; ++i) {
+			auto theta = M_PI_2 + M_PI * i / 100.;
+			pts.push_back(P2D(-5. + 2. * std::cos(theta), 2. * std::sin(theta)));
+		}
+		auto curves = std::vector<planar::Curve>{};
+		for(size_t i=0; i < pts.size(); ++i) {
+			curves.push_back(planar::LineSegment{pts[i], pts[(i + 1) % pts.size()]});
+		}
+		auto stadium = planar::Loop(curves);
+		auto tolerance = 1e-3f;
+		EXPECT(planar::FitArcs(stadium, tolerance) > 280u);
+		EXPECT(stadium.curves().size() <= 20u);
+
+		// Every curve joins the next without a kink
+		const auto &fitted = stadium.curves();
+		EXPECT(planar::WindingNumber(stadium, P2D(0., 0.)) == 1);
+		for(size_t i=0; i < fitted.size(); ++i) {
+			auto t0 = planar::Tangents(fitted[i])[1];
+			auto t1 = planar::Tangents(fitted[(i + 1) % fitted.size()])[0];
+			EXPECT((t0 <= t1)[0] > 0.999f);
+		}
+		auto index = planar::DistanceIndex(stadium);
+		for(const auto &pt : pts) {
+			EXPECT(index.Distance(pt) <= tolerance * 1.01f);
+		}
+
+		// Sharp corners stay sharp
+		auto square = Square(P2D(0., 0.), 1.);
+		EXPECT(planar::FitArcs(square, tolerance) == 0u);
+	},
+	CASE("Test Vertex Welding") {
+		using P2D = planar::Point2d;
+
+		auto welder = planar::VertexWelder(1e-3);
+		EXPECT(welder.Weld(P2D(0., 0.)) == 0u);
+		EXPECT(welder.Weld(P2D(1., 0.)) == 1u);
+		EXPECT(welder.Weld(P2D(0.0004, -0.0004)) == 0u);
+		EXPECT(welder.Weld(P2D(1.0009, 0.)) == 1u);
+		EXPECT(welder.Weld(P2D(0.002, 0.)) == 2u);
+		EXPECT(welder.Find(P2D(5., 5.)) == -1);
+		EXPECT(welder.size() == 3u);
+		EXPECT(welder.vertices()[0][0] == 0.f);
+
+		// Two overlapping squares meet at two crossings besides their eight
+		// corners, and each corner is shared by two curves
+		auto loops = std::vector<planar::Loop>{Square(P2D(0., 0.), 1.), Square(P2D(1., 1.), 1.)};
+		auto topology = planar::WeldIntersections(loops, 1e-5);
+		EXPECT(topology.vertices.size() == 10u);
+		EXPECT(topology.offsets.size() == 9u);
+		auto uses = std::vector<int>(topology.vertices.size(), 0);
+		for(size_t c=0; c < 8; ++c) {
+			auto begin = topology.offsets[c];
+			auto end = topology.offsets[c + 1];
+			EXPECT(end - begin >= 2u);
+			auto next = c % 4 == 3 ? c - 3 : c + 1;
+			EXPECT(topology.ids[end - 1] == topology.ids[topology.offsets[next]]);
+			for(auto k=begin; k < end; ++k) {
+				++uses[topology.ids[k]];
+			}
+		}
+		for(auto count : uses) {
+			EXPECT(count == 2);
+		}
+	},
+	CASE("Test Quantized Coordinates") {
+		using P2D = planar::Point2d;
+		using IP = planar::IPoint2d;
+
+		auto grid = planar::FitGrid(planar::Box2d{P2D(-10., -10.), P2D(10., 10.)}, 1e-3);
+		auto pt = planar::Quantize(grid, P2D(1.2345, -2.));
+		EXPECT(pt.x == 1235);
+		EXPECT(pt.y == -2000);
+		EXPECT(planar::Dequantize(grid, pt)[0] == lest::approx(1.235));
+
+		// Round trips are stable after the first snap to the grid
+		auto loop = planar::Loop(std::vector<planar::Curve>{
+			planar::ArcWithDirectionAndAngle(P2D(0., 0.), 1., P2D(0., 1.), M_PI),
+			planar::LineSegment{P2D(-1., 0.), P2D(1., 0.)}
+		});
+		auto quantized = planar::Quantize(grid, loop);
+		EXPECT(quantized.types.size() == 2u);
+		EXPECT(quantized.values.size() == 11u);
+		auto again = planar::Quantize(grid, planar::Dequantize(grid, quantized));
+		EXPECT(again.values == quantized.values);
+
+		auto fit = planar::FitGrid(planar::Box2d{P2D(-1e6, 0.), P2D(1e6, 1.)});
+		EXPECT(planar::Quantize(fit, P2D(1e6, 0.)).x <= planar::kMaxQuantized);
+
+		// Exact predicates, including at the edge of the coordinate range
+		auto m = planar::kMaxQuantized;
+		EXPECT(planar::Orientation(IP{0, 0}, IP{10, 0}, IP{5, 1}) == 1);
+		EXPECT(planar::Orientation(IP{0, 0}, IP{10, 0}, IP{5, -1}) == -1);
+		EXPECT(planar::Orientation(IP{-m, -m}, IP{m, m}, IP{m - 1, m - 1}) == 0);
+		EXPECT(planar::Orientation(IP{-m, -m}, IP{m, m - 1}, IP{m - 1, m - 1}) == 1);
+
+		auto xs = std::vector<int32_t>{5, 5, 20};
+		auto ys = std::vector<int32_t>{1, -1, 0};
+		auto signs = std::vector<int8_t>(3);
+		planar::Orientations(IP{0, 0}, IP{10, 0}, xs.data(), ys.data(), 3, signs.data());
+		EXPECT(signs[0] == 1);
+		EXPECT(signs[1] == -1);
+		EXPECT(signs[2] == 0);
+
+		using IS = planar::ILineSegment;
+		EXPECT(planar::Intersects(IS{{{IP{0, 0}, IP{10, 10}}}}, IS{{{IP{0, 10}, IP{10, 0}}}}));
+		EXPECT(planar::Intersects(IS{{{IP{0, 0}, IP{10, 0}}}}, IS{{{IP{10, 0}, IP{10, 5}}}}));
+		EXPECT(planar::Intersects(IS{{{IP{0, 0}, IP{10, 0}}}}, IS{{{IP{5, 0}, IP{20, 0}}}}));
+		EXPECT(!planar::Intersects(IS{{{IP{0, 0}, IP{10, 0}}}}, IS{{{IP{11, 0}, IP{20, 0}}}}));
+		EXPECT(!planar::Intersects(IS{{{IP{0, 0}, IP{10, 0}}}}, IS{{{IP{0, 1}, IP{10, 1}}}}));
+	},
+	CASE("Test Loop Variable Offset") {
+		using P2D = planar::Point2d;
+
+		auto closed = [](const planar::Loop &loop) {
+			const auto &curves = loop.curves();
+			for(size_t i=0; i < curves.size(); ++i) {
+				auto end = planar::Endpoints(curves[i])[1];
+				auto start = planar::Endpoints(curves[(i + 1) % curves.size()])[0];
+				if((end - start).norm() > 1e-5f) {
+					return false;
+				}
+			}
+			return true;
+		};
+		auto square = Square(P2D(0., 0.), 1.);
+
+		// Round outer corners, trimmed inner corners
+		auto outer = square.Offset(0.5);
+		EXPECT(outer.curves().size() == 8u);
+		EXPECT(closed(outer));
+		EXPECT(planar::Contains(outer, P2D(1.45, 0.)));
+		EXPECT(!planar::Contains(outer, P2D(1.45, 1.45)));
+		auto inner = square.Offset(-0.25);
+		EXPECT(inner.curves().size() == 4u);
+		EXPECT(closed(inner));
+		EXPECT(planar::Contains(inner, P2D(0.7, 0.7)));
+		EXPECT(!planar::Contains(inner, P2D(0.8, 0.)));
+
+		// Only the top edge moves
+		auto allowance = square.Offset(std::vector<float>{0.5, 0., 0., 0.});
+		EXPECT(allowance.curves().size() == 6u);
+		EXPECT(closed(allowance));
+		EXPECT(planar::Contains(allowance, P2D(0.9, 1.4)));
+		EXPECT(!planar::Contains(allowance, P2D(0., 1.6)));
+		EXPECT(!planar::Contains(allowance, P2D(1.1, 0.)));
+
+		// Rounded at the smaller distance with a radial step at each corner
+		auto amts = std::vector<float>{0.5, 0.25, 0.5, 0.25};
+		auto mixed = square.Offset(amts.data(), amts.size());
+		EXPECT(mixed.curves().size() == 12u);
+		EXPECT(closed(mixed));
+		EXPECT(planar::Contains(mixed, P2D(0., 1.45)));
+		EXPECT(planar::Contains(mixed, P2D(-1.2, 0.)));
+		EXPECT(!planar::Contains(mixed, P2D(-1.3, 0.)));
+		EXPECT(!planar::Contains(mixed, P2D(1.2, 1.45)));
+	},
+	CASE("Test Offset Cache") {
+		using P2D = planar::Point2d;
+
+		auto square = Square(P2D(0., 0.), 1.);
+		auto moved = Square(P2D(0., 1e-3), 1.);
+		EXPECT(planar::ContentHash(square) == planar::ContentHash(Square(P2D(0., 0.), 1.)));
+		EXPECT(planar::ContentHash(square) != planar::ContentHash(moved));
+		EXPECT(planar::ContentHash(std::vector<planar::Loop>{square, moved}) !=
+			planar::ContentHash(std::vector<planar::Loop>{moved, square}));
+
+		planar::LoopCache cache(1 << 20);
+		auto first = planar::Offset(cache, square, 0.5);
+		auto second = planar::Offset(cache, square, 0.5);
+		EXPECT(cache.misses() == 1u);
+		EXPECT(cache.hits() == 1u);
+		EXPECT(second.curves().size() == first.curves().size());
+		EXPECT(planar::ContentHash(second) == planar::ContentHash(square.Offset(0.5)));
+		planar::Offset(cache, square, 0.25);
+		planar::Offset(cache, moved, 0.5);
+		EXPECT(cache.size() == 3u);
+
+		auto region = std::vector<planar::Loop>{square};
+		auto other = std::vector<planar::Loop>{Square(P2D(1., 1.), 1.)};
+		auto merged = planar::Boolean(cache, region, other, planar::BooleanOp::Union);
+		planar::Boolean(cache, region, other, planar::BooleanOp::Union);
+		planar::Boolean(cache, region, other, planar::BooleanOp::Intersection);
+		EXPECT(merged.size() == 1u);
+		EXPECT(cache.hits() == 2u);
+		EXPECT(cache.size() == 5u);
+
+		// Least recently used entries go first once over budget
+		auto budget = cache.bytes() - 1;
+		planar::LoopCache small(budget);
+		for(auto amt : {0.5f, 0.25f, 0.125f}) {
+			planar::Offset(small, square, amt);
+		}
+		planar::Offset(small, square, 0.5f);
+		EXPECT(small.bytes() <= budget);
+		EXPECT(small.hits() == 1u);
+		planar::Offset(small, moved, 0.5f);
+		planar::Offset(small, moved, 0.25f);
+		planar::Offset(small, moved, 0.125f);
+		EXPECT(small.evictions() > 0u);
+		EXPECT(small.bytes() <= budget);
+		EXPECT(small.Find(planar::CacheKey{planar::ContentHash(moved), 0.125f, planar::kCacheLoopOffset}) != nullptr);
+	},
+	CASE("Test Rectangle Clipping") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+		using Box2d = planar::Box2d;
+
+		auto quarter = planar::Clip(Square(P2D(0., 0.), 1.), Box2d{P2D(0., 0.), P2D(2., 2.)});
+		EXPECT(quarter.size() == 1u);
+		EXPECT(quarter[0].curves().size() == 4u);
+		EXPECT(planar::Contains(quarter, P2D(0.5, 0.5)));
+		EXPECT(!planar::Contains(quarter, P2D(-0.5, 0.5)));
+
+		// Whole loops inside are kept, the window inside a loop is returned
+		EXPECT(planar::Clip(Square(P2D(0., 0.), 1.), Box2d{P2D(-2., -2.), P2D(2., 2.)})[0].curves().size() == 4u);
+		EXPECT(planar::Clip(Square(P2D(10., 0.), 1.), Box2d{P2D(-2., -2.), P2D(2., 2.)}).empty());
+		auto window = planar::Clip(Square(P2D(0., 0.), 5.), Box2d{P2D(0., 0.), P2D(1., 1.)});
+		EXPECT(window.size() == 1u);
+		EXPECT(planar::Contains(window, P2D(0.5, 0.5)));
+
+		// The prongs of a U come out as separate loops
+		auto u = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(0., 0.), P2D(3., 0.)},
+			LineSegment{P2D(3., 0.), P2D(3., 3.)},
+			LineSegment{P2D(3., 3.), P2D(2., 3.)},
+			LineSegment{P2D(2., 3.), P2D(2., 1.)},
+			LineSegment{P2D(2., 1.), P2D(1., 1.)},
+			LineSegment{P2D(1., 1.), P2D(1., 3.)},
+			LineSegment{P2D(1., 3.), P2D(0., 3.)},
+			LineSegment{P2D(0., 3.), P2D(0., 0.)}
+		});
+		auto prongs = planar::Clip(u, Box2d{P2D(-1., 2.), P2D(4., 4.)});
+		EXPECT(prongs.size() == 2u);
+		EXPECT(planar::Contains(prongs, P2D(0.5, 2.5)));
+		EXPECT(planar::Contains(prongs, P2D(2.5, 2.5)));
+		EXPECT(!planar::Contains(prongs, P2D(1.5, 2.5)));
+		EXPECT(!planar::Contains(prongs, P2D(0.5, 1.5)));
+
+		auto half_disk = planar::Clip(
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), 1.}}),
+			Box2d{P2D(0., -2.), P2D(2., 2.)});
+		EXPECT(half_disk.size() == 1u);
+		EXPECT(half_disk[0].curves().size() == 2u);
+		EXPECT(planar::Contains(half_disk, P2D(0.5, 0.)));
+		EXPECT(!planar::Contains(half_disk, P2D(-0.5, 0.)));
+		EXPECT(!planar::Contains(half_disk, P2D(0.9, 0.9)));
+
+		// Right half of a square ring
+		auto hole = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(1., 1.), P2D(1., -1.)},
+			LineSegment{P2D(1., -1.), P2D(-1., -1.)},
+			LineSegment{P2D(-1., -1.), P2D(-1., 1.)},
+			LineSegment{P2D(-1., 1.), P2D(1., 1.)}
+		});
+		auto ring = std::vector<planar::Loop>{Square(P2D(0., 0.), 2.), hole};
+		auto half_ring = planar::Clip(ring, Box2d{P2D(0., -3.), P2D(3., 3.)});
+		EXPECT(half_ring.size() == 1u);
+		EXPECT(planar::Contains(half_ring, P2D(1.5, 0.)));
+		EXPECT(planar::Contains(half_ring, P2D(0.5, 1.5)));
+		EXPECT(!planar::Contains(half_ring, P2D(0.5, 0.)));
+		EXPECT(!planar::Contains(half_ring, P2D(-1.5, 0.)));
+	},
+	CASE("Test Spatial Tiling") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+
+		// Deterministic scatter of segments, split whole and tile by tile
+		auto curves = std::vector<planar::Curve>{};
+		auto seed = 12345u;
+		auto next = [&]() {
+			seed = seed * 1664525u + 1013904223u;
+			return float(seed >> 8) / float(1 << 24);
+		};
+		for(int i=0; i < 300; ++i) {
+			auto a = P2D(next() * 100.f, next() * 100.f);
+			auto b = a + P2D(next() * 20.f - 10.f, next() * 20.f - 10.f);
+			curves.push_back(LineSegment{a, b});
+		}
+		auto grid = planar::TileGrid(curves, 10.f, 1e-3f);
+		EXPECT(grid.size() > 50u);
+		for(size_t t=0; t < grid.size(); ++t) {
+			EXPECT(grid.TileAt((grid.Core(t).min + grid.Core(t).max) * 0.5f) == t);
+		}
+		auto whole = planar::SplitAtIntersections(curves, 1e-3f);
+		auto tiled = planar::SplitAtIntersections(grid, curves, 1e-3f, 4);
+		EXPECT(whole.size() == tiled.size());
+		auto same = true;
+		for(size_t i=0; i < whole.size(); ++i) {
+			same = same && whole[i].size() == tiled[i].size();
+		}
+		EXPECT(same);
+	},
+	CASE("Test Region Hierarchy") {
+		using P2D = planar::Point2d;
+
+		// Outer, hole, island in the hole, and a second outer; mixed
+		// orientations and out of order
+		auto loops = std::vector<planar::Loop>{
+			Square(P2D(0., 0.), 1.),
+			Square(P2D(0., 0.), 10.),
+			Square(P2D(0., 0.), 4.),
+			planar::Reverse(Square(P2D(30., 0.), 5.))
+		};
+		auto region = planar::Region(loops);
+		EXPECT(region.size() == 4u);
+		EXPECT(region.parent(1) == -1);
+		EXPECT(region.parent(2) == 1);
+		EXPECT(region.parent(0) == 2);
+		EXPECT(region.parent(3) == -1);
+		EXPECT(region.depth(0) == 2u);
+		EXPECT(region.hole(2));
+		EXPECT(region.ChildCount(1) == 1u);
+		EXPECT(region.Children(1)[0] == 2u);
+		EXPECT(planar::SignedArea(region.loops()[1]) > 0.f);
+		EXPECT(planar::SignedArea(region.loops()[2]) < 0.f);
+		EXPECT(planar::SignedArea(region.loops()[0]) > 0.f);
+		EXPECT(planar::SignedArea(region.loops()[3]) > 0.f);
+		EXPECT(std::abs(planar::SignedArea(region.loops()[2]) + 64.f) < 1e-3f);
+		EXPECT(planar::Contains(region.loops(), P2D(0., 0.)));
+		EXPECT(!planar::Contains(region.loops(), P2D(2., 2.)));
+
+		// The hole shrinks while the outers and the island grow
+		auto grown = region.Offset(0.5f, 2);
+		EXPECT(grown.size() == 4u);
+		EXPECT(planar::Contains(grown.loops(), P2D(1.25, 0.)));
+		EXPECT(planar::Contains(grown.loops(), P2D(3.75, 0.)));
+		EXPECT(!planar::Contains(grown.loops(), P2D(2.5, 0.)));
+		EXPECT(planar::Contains(grown.loops(), P2D(10.25, 0.)));
+
+		// Shrunk past its size the hole goes, taking the island with it
+		auto closed = region.Offset(4.5f, 2);
+		EXPECT(closed.size() == 2u);
+		EXPECT(closed.parent(0) == -1);
+		EXPECT(closed.parent(1) == -1);
+
+		// Offsets are trimmed against each other: outers merge, and a hole
+		// growing through its shrinking outer opens it up or wipes it out
+		auto pair = planar::Region(std::vector<planar::Loop>{Square(P2D(0., 0.), 2.), Square(P2D(5., 0.), 2.)});
+		auto merged = pair.Offset(1.f);
+		EXPECT(merged.size() == 1u);
+		EXPECT(planar::Contains(merged.loops(), P2D(2.5, 0.)));
+		auto notched = planar::Region(std::vector<planar::Loop>{Square(P2D(0., 0.), 10.), Square(P2D(7., 0.), 2.)});
+		auto opened = notched.Offset(-1.5f);
+		EXPECT(opened.size() == 1u);
+		EXPECT(!opened.hole(0));
+		EXPECT(planar::Contains(opened.loops(), P2D(0., 0.)));
+		EXPECT(!planar::Contains(opened.loops(), P2D(7., 0.)));
+		EXPECT(!planar::Contains(opened.loops(), P2D(9., 0.)));
+		auto ring = planar::Region(std::vector<planar::Loop>{Square(P2D(0., 0.), 10.), Square(P2D(0., 0.), 8.)});
+		EXPECT(ring.Offset(-1.5f).size() == 0u);
+
+		// Many holes in one outer
+		auto sheet = std::vector<planar::Loop>{Square(P2D(0., 0.), 100.)};
+		for(int i=0; i < 40; ++i) {
+			for(int j=0; j < 40; ++j) {
+				sheet.push_back(planar::Reverse(Square(P2D(-97.5f + 5.f * i, -97.5f + 5.f * j), 1.)));
+			}
+		}
+		auto holes = planar::Region(sheet);
+		EXPECT(holes.ChildCount(0) == 1600u);
+		auto all_holes = true;
+		for(size_t i=1; i < holes.size(); ++i) {
+			all_holes = all_holes && holes.parent(i) == 0 && holes.hole(i);
+		}
+		EXPECT(all_holes);
+		EXPECT(holes.Offset(-0.5f).size() == 1601u);
+		EXPECT(holes.Offset(1.5f).size() == 1u);
+
+		// A row of islands all on the sweep line at once
+		auto row = std::vector<planar::Loop>{Square(P2D(0., 0.), 50000.)};
+		for(int i=0; i < 20000; ++i) {
+			row.push_back(Square(P2D(-20000.f + 2.f * i, 0.01f * (i % 7)), 0.5));
+		}
+		auto row_start = std::chrono::steady_clock::now();
+		auto islands = planar::Region(row);
+		EXPECT(std::chrono::steady_clock::now() - row_start < std::chrono::seconds(1));
+		EXPECT(islands.ChildCount(0) == 20000u);
+
+		// Edges leaving the same vertex are ordered by where they head
+		auto wedge = planar::Region(std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{
+				planar::LineSegment{P2D(4.68115, 1.44805), P2D(-1.08653, -4.77802)},
+				planar::LineSegment{P2D(-1.08653, -4.77802), P2D(-3.59462, 3.32997)},
+				planar::LineSegment{P2D(-3.59462, 3.32997), P2D(4.68115, 1.44805)}
+			}),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), 2.25}})
+		});
+		EXPECT(wedge.parent(1) == 0);
+	},
+	CASE("Test Arc Length Parameterization") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+		using Arc = planar::Arc;
+		using Circle = planar::Circle;
+
+		// Stadium: two lines of length 4 joined by half circles of radius 1
+		auto stadium = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(0., 0.), P2D(4., 0.)},
+			Arc{Circle{P2D(4., 1.), 1.}, LineSegment{P2D(4., 0.), P2D(4., 2.)}},
+			LineSegment{P2D(4., 2.), P2D(0., 2.)},
+			Arc{Circle{P2D(0., 1.), 1.}, LineSegment{P2D(0., 2.), P2D(0., 0.)}}
+		});
+		auto pi = float(M_PI);
+		EXPECT(std::abs(stadium.Length() - (8.f + 2.f * pi)) < 1e-4f);
+		EXPECT(stadium.CumulativeLengths().size() == 5u);
+		EXPECT((stadium.PointAt(1.5f) - P2D(1.5, 0.)).norm() < 1e-5f);
+		EXPECT((stadium.PointAt(4.f + pi * 0.5f) - P2D(5., 1.)).norm() < 1e-4f);
+		EXPECT((stadium.TangentAt(4.f + pi * 0.5f) - P2D(0., 1.)).norm() < 1e-4f);
+		EXPECT((stadium.TangentAt(5.f + pi) - P2D(-1., 0.)).norm() < 1e-4f);
+		// Wraps in both directions
+		EXPECT((stadium.PointAt(stadium.Length() + 1.f) - P2D(1., 0.)).norm() < 1e-4f);
+		EXPECT((stadium.PointAt(-0.5f) - P2D(-std::sin(0.5f), 1.f - std::cos(0.5f))).norm() < 1e-4f);
+
+		// Copies share the table; the batched walk matches single queries
+		auto copy = stadium;
+		EXPECT(&copy.CumulativeLengths() == &stadium.CumulativeLengths());
+		// Vectors of loops move rather than copy when they grow
+		EXPECT(std::is_nothrow_move_constructible<planar::Loop>::value);
+		EXPECT(std::is_nothrow_move_assignable<planar::Loop>::value);
+		// A moved-from loop is empty and keeps nothing cached about its
+		// old curves
+		auto source = stadium;
+		source.Metrics();
+		auto moved = std::move(source);
+		EXPECT(std::abs(moved.Length() - stadium.Length()) < 1e-5f);
+		EXPECT(source.curves().empty());
+		EXPECT(source.Length() == 0.f);
+		EXPECT(source.CumulativeLengths().size() == 1u);
+		EXPECT(source.Metrics().area == 0.f);
+		source = stadium;
+		source.Length();
+		moved = std::move(source);
+		EXPECT(source.CumulativeLengths().size() == 1u);
+		EXPECT(source.Metrics().area == 0.f);
+		auto s = std::vector<float>{};
+		for(int i=0; i < 100; ++i) {
+			s.push_back(float(i) * 0.37f);
+		}
+		auto pts = stadium.PointsAt(s);
+		auto same = true;
+		for(size_t i=0; i < s.size(); ++i) {
+			same = same && (pts[i] - stadium.PointAt(s[i])).norm() < 1e-4f;
+		}
+		EXPECT(same);
+
+		// CW circle starts at its rightmost point and runs down
+		auto circle = planar::Loop(std::vector<planar::Curve>{Circle{P2D(0., 0.), -2.}});
+		EXPECT(std::abs(circle.Length() - 4.f * pi) < 1e-4f);
+		EXPECT((circle.PointAt(pi) - P2D(0., -2.)).norm() < 1e-4f);
+		EXPECT((circle.TangentAt(0.f) - P2D(0., -1.)).norm() < 1e-4f);
+	},
+	CASE("Test Loop Metrics") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+		using Arc = planar::Arc;
+		using Circle = planar::Circle;
+
+		auto square = Square(P2D(100., 50.), 2.);
+		const auto &metrics = square.Metrics();
+		EXPECT(std::abs(metrics.area - 16.f) < 1e-3f);
+		EXPECT(std::abs(metrics.perimeter - 16.f) < 1e-4f);
+		EXPECT(metrics.orientation == 1);
+		EXPECT(metrics.bounds.min[0] == 98.f);
+		EXPECT(metrics.bounds.max[1] == 52.f);
+		EXPECT(&square.Metrics() == &metrics);
+		EXPECT(planar::Reverse(square).Metrics().orientation == -1);
+
+		// Half disk: arc over a diameter, more segments than one block
+		auto pi = float(M_PI);
+		auto curves = std::vector<planar::Curve>{
+			Arc{Circle{P2D(0., 0.), 1.}, LineSegment{P2D(1., 0.), P2D(-1., 0.)}}
+		};
+		for(int i=0; i < 100; ++i) {
+			auto x0 = -1.f + 0.02f * float(i);
+			curves.push_back(LineSegment{P2D(x0, 0.), P2D(x0 + 0.02f, 0.)});
+		}
+		auto half_disk = planar::Loop(curves);
+		EXPECT(std::abs(half_disk.Metrics().area - pi * 0.5f) < 1e-4f);
+		EXPECT(std::abs(half_disk.Metrics().perimeter - (pi + 2.f)) < 1e-4f);
+		EXPECT(std::abs(half_disk.Metrics().bounds.max[1] - 1.f) < 1e-5f);
+		EXPECT(half_disk.Metrics().bounds.min[1] == 0.f);
+
+		auto hole = planar::Loop(std::vector<planar::Curve>{Circle{P2D(0., 0.), -2.}});
+		EXPECT(std::abs(planar::SignedArea(hole) + 4.f * pi) < 1e-4f);
+		EXPECT(planar::Bounds(hole).min[0] == -2.f);
+
+		// Assignment brings the other loop's metrics
+		square = hole;
+		EXPECT(square.Metrics().orientation == -1);
+	},
+	CASE("Test Transforms and Instances") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+		using Arc = planar::Arc;
+		using Circle = planar::Circle;
+
+		// Square with one side bulged out by a half circle
+		auto part = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(0., 0.), P2D(2., 0.)},
+			Arc{Circle{P2D(2., 1.), 1.}, LineSegment{P2D(2., 0.), P2D(2., 2.)}},
+			LineSegment{P2D(2., 2.), P2D(0., 2.)},
+			LineSegment{P2D(0., 2.), P2D(0., 0.)}
+		});
+		auto area = part.Metrics().area;
+		auto pi = float(M_PI);
+
+		auto turn = planar::Rotation(pi * 0.5f, P2D(1., 1.));
+		EXPECT((planar::Transform(turn, P2D(0., 0.)) - P2D(2., 0.)).norm() < 1e-5f);
+		auto inverse = planar::Compose(planar::Inverse(turn), turn);
+		EXPECT(std::abs(inverse.xx - 1.f) < 1e-6f && std::abs(inverse.tx) < 1e-6f);
+
+		// Reflection reverses travel, so arcs change radius sign
+		auto mirror = planar::Reflection(P2D(0., 0.), P2D(0., 1.));
+		auto mirrored = planar::Transform(mirror, part);
+		EXPECT(std::abs(mirrored.Metrics().area + area) < 1e-4f);
+		auto arc = *(Arc*)Target(mirrored.curves()[1]);
+		EXPECT(arc.circle.radius == -1.f);
+		EXPECT((arc.circle.center - P2D(-2., 1.)).norm() < 1e-6f);
+		auto scaled = planar::Transform(planar::Scaling(2.f), part);
+		EXPECT(std::abs(scaled.Metrics().area - 4.f * area) < 1e-3f);
+
+		// The batched kernel matches curve by curve transforms
+		auto placements = std::vector<planar::Transform2d>{turn, mirror, planar::Translation(P2D(5., 0.))};
+		auto placed = planar::Transform(placements, part);
+		EXPECT(placed.size() == 3u);
+		auto matches = true;
+		for(size_t i=0; i < placed.size(); ++i) {
+			auto expected = planar::Transform(placements[i], part);
+			matches = matches && std::abs(placed[i].Metrics().area - expected.Metrics().area) < 1e-4f;
+			matches = matches && (placed[i].Metrics().bounds.min - expected.Metrics().bounds.min).norm() < 1e-5f;
+		}
+		EXPECT(matches);
+
+		// Instances share the geometry
+		auto shared = std::make_shared<const planar::Loop>(part);
+		auto a = planar::LoopInstance(shared, planar::IdentityTransform());
+		auto b = planar::LoopInstance(shared, planar::Translation(P2D(1., 1.)));
+		auto c = planar::LoopInstance(shared, planar::Translation(P2D(10., 0.)));
+		auto brute = size_t(0);
+		auto placed_a = a.Materialize();
+		auto placed_b = b.Materialize();
+		for(const auto &curve_a : placed_a.curves()) {
+			for(const auto &curve_b : placed_b.curves()) {
+				brute += Intersect(curve_a, curve_b).size();
+			}
+		}
+		EXPECT(brute > 0u);
+		EXPECT(planar::Intersect(a, b).size() == brute);
+		EXPECT(planar::Intersect(a, c).empty());
+		EXPECT((b.Bounds().max - P2D(4., 3.)).norm() < 1e-5f);
+
+		auto m = planar::LoopInstance(shared, mirror);
+		auto grown = m.Offset(0.25f).Materialize();
+		auto expected = mirrored.Offset(0.25f);
+		EXPECT(std::abs(grown.Metrics().area - expected.Metrics().area) < 1e-3f);
+
+		auto offsets = planar::Offset(std::vector<planar::LoopInstance>{a, b, c, m}, 0.5f);
+		EXPECT(offsets[0].shared_loop() == offsets[1].shared_loop());
+		EXPECT(offsets[0].shared_loop() == offsets[2].shared_loop());
+		EXPECT(offsets[0].shared_loop() != offsets[3].shared_loop());
+		EXPECT(std::abs(offsets[2].Materialize().Metrics().area - part.Offset(0.5f).Metrics().area) < 1e-3f);
+
+		// A stretched placement is offset in place: the 4 x 2 rectangle
+		// grows by 0.5 all round with rounded corners
+		EXPECT(planar::IsSimilarity(planar::Compose(planar::Rotation(0.3f), planar::Scaling(2.f))));
+		EXPECT(planar::IsSimilarity(mirror));
+		auto stretch = planar::Transform2d{2.f, 0.f, 0.f, 1.f, 0.f, 0.f};
+		EXPECT(!planar::IsSimilarity(stretch));
+		auto box = planar::LoopInstance(std::make_shared<const planar::Loop>(Square(P2D(0., 0.), 1.)), stretch);
+		auto rounded = 15.f - (4.f - float(M_PI)) * 0.25f;
+		EXPECT(std::abs(box.Offset(0.5f).Materialize().Metrics().area - rounded) < 1e-3f);
+		auto boxes = planar::Offset(std::vector<planar::LoopInstance>{box, a}, 0.5f);
+		EXPECT(std::abs(boxes[0].Materialize().Metrics().area - rounded) < 1e-3f);
+	},
+	CASE("Test Async Jobs") {
+		using P2D = planar::Point2d;
+
+		planar::Executor executor(2);
+		auto reports = std::make_shared<std::atomic<int>>(0);
+		auto job = planar::OffsetAsync(executor, std::vector<planar::Loop>{Square(P2D(0., 0.), 1.)}, 0.5f, 1,
+			[reports](float) { ++*reports; });
+		auto grown = job.get();
+		EXPECT(grown.size() == 1u);
+		EXPECT(planar::Contains(grown, P2D(1.25, 0.)));
+		EXPECT(job.progress() == 1.f);
+		EXPECT(*reports > 0);
+
+		// A job cancelled while queued never runs
+		planar::Executor single(1);
+		auto release = std::make_shared<std::atomic<bool>>(false);
+		auto blocker = single.Submit([release](planar::JobControl &) {
+			while(!*release) {
+				std::this_thread::yield();
+			}
+			return 1;
+		});
+		auto queued = planar::OffsetAsync(single, std::vector<planar::Loop>{Square(P2D(0., 0.), 1.)}, 0.5f);
+		queued.Cancel();
+		*release = true;
+		EXPECT(blocker.get() == 1);
+		EXPECT(queued.get().empty());
+		EXPECT(queued.cancelled());
+
+		// A running job stops at its next check
+		auto spinning = executor.Submit([](planar::JobControl &control) {
+			auto steps = 0;
+			while(!control.cancelled()) {
+				std::this_thread::yield();
+				++steps;
+			}
+			return steps >= 0;
+		});
+		EXPECT(!spinning.wait_for(std::chrono::milliseconds(10)));
+		spinning.Cancel();
+		EXPECT(spinning.get());
+
+		// Building the engine of a dense loop checks for cancellation too
+		auto dense = std::vector<planar::Curve>{};
+		auto dense_pt = [](int i) {
+			auto angle = 2. * M_PI * double(i % 20000) / 20000.;
+			return P2D(float(100. * std::cos(angle)), float(100. * std::sin(angle)));
+		};
+		for(int i=0; i < 20000; ++i) {
+			dense.push_back(planar::LineSegment{dense_pt(i), dense_pt(i + 1)});
+		}
+		auto started = std::make_shared<std::atomic<bool>>(false);
+		auto building = planar::OffsetAsync(executor, std::vector<planar::Loop>{planar::Loop(dense)}, -3.f, 1,
+			[started](float) { *started = true; });
+		while(!*started && !building.ready()) {
+			std::this_thread::yield();
+		}
+		auto cancelled_at = std::chrono::steady_clock::now();
+		building.Cancel();
+		EXPECT(building.get().empty());
+		EXPECT(std::chrono::steady_clock::now() - cancelled_at < std::chrono::milliseconds(250));
+
+		auto split = planar::SplitAtIntersectionsAsync(planar::DefaultExecutor(), Square(P2D(0., 0.), 1.).curves(), 1e-5f);
+		EXPECT(split.get().size() == 4u);
+	},
+	CASE("Test Tessellation") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+
+		// Total area of the triangles, and whether all run CCW
+		auto triangle_area = [](const planar::TriangleBuffer &buffer, bool &ccw) {
+			const auto &xy = buffer.vertices.xy;
+			auto total = 0.;
+			ccw = true;
+			for(size_t t=0; t < buffer.indices.size(); t += 3) {
+				auto a = buffer.indices[t];
+				auto b = buffer.indices[t + 1];
+				auto c = buffer.indices[t + 2];
+				auto area = 0.5 * ((double(xy[2 * b]) - xy[2 * a]) * (double(xy[2 * c + 1]) - xy[2 * a + 1]) -
+					(double(xy[2 * b + 1]) - xy[2 * a + 1]) * (double(xy[2 * c]) - xy[2 * a]));
+				ccw = ccw && area > 0.;
+				total += area;
+			}
+			return total;
+		};
+
+		planar::TriangleBuffer buffer;
+		auto ccw = false;
+		planar::Tessellate(Square(P2D(0., 0.), 1.), 0.01f, buffer);
+		EXPECT(buffer.triangle_count() == 2u);
+		EXPECT(std::abs(triangle_area(buffer, ccw) - 4.) < 1e-5);
+		EXPECT(ccw);
+
+		// A hole, given either way round through a Region
+		auto frame = std::vector<planar::Loop>{Square(P2D(0., 0.), 4.), Square(P2D(0., 0.), 2.)};
+		planar::Tessellate(planar::Region(frame), 0.01f, buffer);
+		EXPECT(std::abs(triangle_area(buffer, ccw) - 48.) < 1e-4);
+		EXPECT(ccw);
+		EXPECT(buffer.triangle_count() == 8u);
+
+		// Comb: a split or merge vertex between every pair of teeth
+		auto comb = std::vector<planar::Curve>{LineSegment{P2D(0., 0.), P2D(40., 0.)}};
+		for(int i=9; i >= 0; --i) {
+			auto x = float(i) * 4.f;
+			comb.push_back(LineSegment{P2D(x + 4.f, i == 9 ? 0.f : 2.f), P2D(x + 4.f, 10.)});
+			comb.push_back(LineSegment{P2D(x + 4.f, 10.), P2D(x + 2.f, 10.)});
+			comb.push_back(LineSegment{P2D(x + 2.f, 10.), P2D(x + 2.f, 2.)});
+			comb.push_back(LineSegment{P2D(x + 2.f, 2.), P2D(x, 2.)});
+		}
+		comb.push_back(LineSegment{P2D(0., 2.), P2D(0., 0.)});
+		auto comb_loop = planar::Loop(comb);
+		planar::Tessellate(comb_loop, 0.01f, buffer);
+		EXPECT(std::abs(triangle_area(buffer, ccw) - comb_loop.Metrics().area) < 1e-3);
+		EXPECT(ccw);
+
+		// Disk with a circular hole; flattened chords stay within tolerance
+		auto washer = std::vector<planar::Loop>{
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), 10.}}),
+			planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(3., 0.), -2.}})
+		};
+		planar::Tessellate(washer, 0.001f, buffer);
+		auto pi = M_PI;
+		EXPECT(std::abs(triangle_area(buffer, ccw) - pi * 96.) < 0.5);
+		EXPECT(ccw);
+		EXPECT(buffer.triangle_count() == buffer.vertices.vertex_count());
+
+		// Star with many reflex vertices: n - 2 triangles
+		auto star = std::vector<planar::Curve>{};
+		auto n = 2000;
+		auto pt = [&](int i) {
+			auto angle = 2. * pi * double(i % n) / double(n);
+			auto r = i % 2 == 0 ? 10. : 4. + double(i % 7);
+			return P2D(float(r * std::cos(angle)), float(r * std::sin(angle)));
+		};
+		for(int i=0; i < n; ++i) {
+			star.push_back(LineSegment{pt(i), pt(i + 1)});
+		}
+		auto star_loop = planar::Loop(star);
+		planar::Tessellate(star_loop, 0.01f, buffer);
+		EXPECT(buffer.triangle_count() == size_t(n - 2));
+		EXPECT(std::abs(triangle_area(buffer, ccw) - star_loop.Metrics().area) < 1e-2);
+		EXPECT(ccw);
+	},
+	CASE("Test Scanline Rasterizer") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+
+		auto total = [](const std::vector<float> &coverage) {
+			auto sum = 0.;
+			for(auto value : coverage) {
+				sum += value;
+			}
+			return sum;
+		};
+		auto pi = M_PI;
+		// One world unit per pixel, y flipped
+		auto grid = planar::PixelGrid{64, 48, P2D(0., 48.), 1.f};
+		auto coverage = std::vector<float>(64 * 48);
+		auto at = [&](uint32_t column, uint32_t row) { return coverage[row * 64 + column]; };
+
+		// Pixel-aligned square is exactly filled
+		planar::Rasterize(Square(P2D(10., 10.), 4.), grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - 64.) < 1e-4);
+		EXPECT(at(10, 38) == 1.f);
+		EXPECT(at(5, 38) == 0.f);
+		EXPECT(at(14, 38) == 0.f);
+
+		// Straddling pixels, and turned
+		planar::Rasterize(Square(P2D(20.5, 20.25), 3.), grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - 36.) < 1e-4);
+		EXPECT(std::abs(at(17, 27) - 0.5f) < 1e-5);
+		EXPECT(std::abs(at(17, 30) - 0.375f) < 1e-5);
+		auto diamond = std::vector<planar::Curve>{
+			LineSegment{P2D(30., 20.), P2D(40., 30.)},
+			LineSegment{P2D(40., 30.), P2D(30., 40.)},
+			LineSegment{P2D(30., 40.), P2D(20., 30.)},
+			LineSegment{P2D(20., 30.), P2D(30., 20.)}
+		};
+		planar::Rasterize(planar::Loop(diamond), grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - 200.) < 1e-3);
+		EXPECT(std::abs(at(20, 18) - 0.5f) < 1e-5);
+
+		// Circles and arcs are exact, not flattened
+		auto disk = planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(31.3, 23.7), 17.2}});
+		planar::Rasterize(disk, grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - pi * 17.2 * 17.2) < 1e-2);
+		auto half_disk = std::vector<planar::Curve>{
+			planar::ArcWithDirectionAndAngle(P2D(30.6, 20.2), 12.5, P2D(0., 1.), float(pi)),
+			LineSegment{P2D(18.1, 20.2), P2D(43.1, 20.2)}
+		};
+		planar::Rasterize(planar::Loop(half_disk), grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - 0.5 * pi * 12.5 * 12.5) < 1e-2);
+		auto washer = std::vector<planar::Loop>{disk, planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(31.3, 23.7), -6.1}})};
+		planar::Rasterize(washer, grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - pi * (17.2 * 17.2 - 6.1 * 6.1)) < 1e-2);
+		EXPECT(at(31, 24) < 1e-6f);
+		EXPECT(at(31, 10) > 1.f - 1e-6f);
+
+		// Non-zero winding saturates where loops overlap; shapes run off the image
+		auto overlap = std::vector<planar::Loop>{Square(P2D(10., 10.), 4.), Square(P2D(12., 10.), 4.), Square(P2D(0., 0.), 5.)};
+		planar::Rasterize(overlap, grid, coverage.data(), 1);
+		EXPECT(std::abs(total(coverage) - 80. - 25.) < 1e-4);
+		EXPECT(at(11, 38) == 1.f);
+		EXPECT(at(2, 46) == 1.f);
+
+		// Threads and 8-bit output agree with the single-threaded floats
+		auto large = planar::FitPixelGrid(planar::Bounds(disk), 300, 200, 10.f);
+		EXPECT(std::abs(large.pixel_size - 34.4f / 180.f) < 1e-5);
+		auto serial = std::vector<float>(300 * 200);
+		auto parallel = std::vector<float>(300 * 200);
+		auto bytes = std::vector<uint8_t>(300 * 200);
+		planar::Rasterize(washer, large, serial.data(), 1);
+		planar::Rasterize(washer, large, parallel.data(), 4);
+		planar::Rasterize(washer, large, bytes.data(), 4);
+		EXPECT(serial == parallel);
+		auto bytes_match = true;
+		for(size_t i=0; i < serial.size(); ++i) {
+			bytes_match = bytes_match && bytes[i] == uint8_t(serial[i] * 255.f + 0.5f);
+		}
+		EXPECT(bytes_match);
+		auto area = total(serial) * large.pixel_size * large.pixel_size;
+		EXPECT(std::abs(area - pi * (17.2 * 17.2 - 6.1 * 6.1)) < 1e-2);
+	},
+	CASE("Test Minkowski Sum") {
+		using P2D = planar::Point2d;
+		using LineSegment = planar::LineSegment;
+
+		auto polygon = [](const std::vector<P2D> &pts) {
+			auto curves = std::vector<planar::Curve>{};
+			for(size_t i=0; i < pts.size(); ++i) {
+				curves.push_back(LineSegment{pts[i], pts[(i + 1) % pts.size()]});
+			}
+			auto loop = planar::Loop(curves);
+			return planar::SignedArea(loop) < 0.f ? planar::Reverse(loop) : loop;
+		};
+		auto total_area = [](const std::vector<planar::Loop> &loops) {
+			auto area = 0.f;
+			for(const auto &loop : loops) {
+				area += planar::SignedArea(loop);
+			}
+			return area;
+		};
+		// Slow reference for a simple polygon: the polygon moved to one tool
+		// vertex plus the tool swept along every edge
+		auto swept = [&](const std::vector<P2D> &pts, const std::vector<P2D> &tool) {
+			auto pieces = std::vector<planar::Loop>{};
+			auto moved = std::vector<P2D>{};
+			for(const auto &pt : pts) {
+				moved.push_back(pt + tool[0]);
+				auto copy = std::vector<P2D>{};
+				for(const auto &v : tool) {
+					copy.push_back(pt + v);
+				}
+				pieces.push_back(polygon(copy));
+			}
+			pieces.push_back(polygon(moved));
+			for(size_t i=0; i < pts.size(); ++i) {
+				auto a = pts[i];
+				auto b = pts[(i + 1) % pts.size()];
+				for(size_t j=0; j < tool.size(); ++j) {
+					auto u = tool[j];
+					auto v = tool[(j + 1) % tool.size()];
+					auto cross = ((b - a) ^ (v - u))[0];
+					if(std::abs(cross) > 1e-6f) {
+						pieces.push_back(polygon(std::vector<P2D>{a + u, b + u, b + v, a + v}));
+					}
+				}
+			}
+			return planar::Union(pieces);
+		};
+
+		// Squares grow into squares; tool order and interior points don't matter
+		auto half = std::vector<P2D>{P2D(0.5, 0.5), P2D(0.5, -0.5), P2D(0., 0.), P2D(-0.5, -0.5), P2D(-0.5, 0.5)};
+		auto grown = planar::MinkowskiSum(Square(P2D(1., 2.), 1.), half);
+		EXPECT(grown.size() == 1u);
+		EXPECT(std::abs(total_area(grown) - 9.f) < 1e-4f);
+		auto bounds = planar::Bounds(grown[0]);
+		EXPECT(std::abs(bounds.min[0] + 0.5f) < 1e-5f);
+		EXPECT(std::abs(bounds.max[1] - 3.5f) < 1e-5f);
+		EXPECT(planar::Convolution(Square(P2D(1., 2.), 1.), half).size() == 8u);
+		auto moved = planar::MinkowskiSum(Square(P2D(0., 0.), 1.), std::vector<P2D>{P2D(3., 0.)});
+		EXPECT(moved.size() == 1u);
+		EXPECT(std::abs(planar::Bounds(moved[0]).min[0] - 2.f) < 1e-5f);
+
+		// Concave polygon against the swept reference; the slot is narrower
+		// than the triangle and closes
+		auto comb = std::vector<P2D>{
+			P2D(0., 0.), P2D(6., 0.), P2D(6., 4.), P2D(4., 4.), P2D(4., 1.5),
+			P2D(3.5, 1.5), P2D(3.5, 4.), P2D(1., 4.), P2D(1., 2.), P2D(0., 3.)
+		};
+		auto triangle = std::vector<P2D>{P2D(-0.4, -0.3), P2D(0.5, -0.2), P2D(0., 0.6)};
+		auto sum = planar::MinkowskiSum(polygon(comb), triangle);
+		auto reference = swept(comb, triangle);
+		EXPECT(sum.size() == 1u);
+		EXPECT(std::abs(total_area(sum) - total_area(reference)) < 1e-3f);
+		auto segment = std::vector<P2D>{P2D(-1., 0.), P2D(1., 0.)};
+		EXPECT(std::abs(total_area(planar::MinkowskiSum(polygon(comb), segment)) - total_area(swept(comb, segment))) < 1e-3f);
+
+		// Arcs stay arcs: disk plus square, and a concave arc against its
+		// fine flattening
+		auto disk = planar::Loop(std::vector<planar::Curve>{planar::Circle{P2D(0., 0.), 1.}});
+		auto rounded = planar::MinkowskiSum(disk, half);
+		EXPECT(rounded.size() == 1u);
+		EXPECT(std::abs(total_area(rounded) - float(M_PI + 4. + 1.)) < 1e-3f);
+		auto has_arc = false;
+		for(const auto &curve : rounded[0].curves()) {
+			has_arc = has_arc || TargetType(curve) != planar::Curve::CurveType::LineSegment;
+		}
+		EXPECT(has_arc);
+		auto bite = planar::Loop(std::vector<planar::Curve>{
+			LineSegment{P2D(-3., -2.), P2D(3., -2.)},
+			LineSegment{P2D(3., -2.), P2D(3., 2.)},
+			planar::ArcWithDirectionAndAngle(P2D(0., 3.), -float(std::sqrt(10.)), P2D(0., -1.), 2.f * std::atan2(3.f, 1.f)),
+			LineSegment{P2D(-3., 2.), P2D(-3., -2.)}
+		});
+		auto flat = planar::VertexBuffer{};
+		planar::Flatten(bite, 1e-5f, flat);
+		auto bite_pts = std::vector<P2D>{};
+		for(size_t i=0; i < flat.vertex_count(); ++i) {
+			bite_pts.push_back(P2D(flat.xy[2 * i], flat.xy[2 * i + 1]));
+		}
+		auto bitten = planar::MinkowskiSum(bite, triangle);
+		EXPECT(bitten.size() == 1u);
+		EXPECT(std::abs(total_area(bitten) - total_area(swept(bite_pts, triangle))) < 1e-2f);
+
+		// Square tool from cos and sin of pi / 4, with its bottom corners off
+		// by an ulp as trig can leave them. The rectangle's edges then lie
+		// within rounding of the tool's, right by the sector boundaries.
+		auto h = 0.495f * std::cos(float(M_PI) / 4.f);
+		auto h_in = std::nextafter(h, 0.f);
+		auto turned = std::vector<P2D>{P2D(h, h), P2D(-h, h), P2D(-h_in, -h), P2D(h, -h_in)};
+		auto rectangle = std::vector<P2D>{P2D(-2., -1.), P2D(2., -1.), P2D(2., 1.), P2D(-2., 1.)};
+		auto padded = planar::MinkowskiSum(polygon(rectangle), turned);
+		EXPECT(padded.size() == 1u);
+		EXPECT(std::abs(total_area(padded) - (4.f + 2.f * h) * (2.f + 2.f * h)) < 1e-3f);
+		auto bitten_turned = planar::MinkowskiSum(bite, turned);
+		EXPECT(bitten_turned.size() == 1u);
+		EXPECT(std::abs(total_area(bitten_turned) - total_area(swept(bite_pts, turned))) < 1e-2f);
+
+		// Holes shrink, then close
+		auto frame = std::vector<planar::Loop>{Square(P2D(0., 0.), 4.), planar::Reverse(Square(P2D(0., 0.), 2.))};
+		auto thick = planar::MinkowskiSum(frame, half);
+		EXPECT(thick.size() == 2u);
+		EXPECT(std::abs(total_area(thick) - 72.f) < 1e-3f);
+		auto big = std::vector<P2D>{P2D(2.5, 2.5), P2D(-2.5, 2.5), P2D(-2.5, -2.5), P2D(2.5, -2.5)};
+		auto solid = planar::MinkowskiSum(frame, big);
+		EXPECT(solid.size() == 1u);
+		EXPECT(std::abs(total_area(solid) - 169.f) < 1e-3f);
+		auto flat_tool = std::vector<P2D>{P2D(2.5, 0.5), P2D(-2.5, 0.5), P2D(-2.5, -0.5), P2D(2.5, -0.5)};
+		auto bridged = planar::MinkowskiSum(frame, flat_tool);
+		EXPECT(bridged.size() == 1u);
+		EXPECT(std::abs(total_area(bridged) - 117.f) < 1e-3f);
+	}
 };
 // clang-format on
 
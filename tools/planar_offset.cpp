@@ -0,0 +1,279 @@
+#include "loop.hpp"
+#include "offset.hpp"
+#include "io.hpp"
+#include "queue.hpp"
+#include "parallel.hpp"
+#include "cache.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams loops from a text file (see io.hpp) through
+//   parse -> offset (worker threads) -> serialize and write
+// with bounded queues between the stages. At most --capacity loops are in
+// flight at any time, so memory stays flat however large the input is.
+
+struct Options{
+	float amt = 0.f;
+	bool trim = false;
+	unsigned threads = 0;
+	size_t capacity = 4096;
+	size_t batch_size = 64;
+	size_t cache_mb = 0;
+	bool quiet = false;
+	std::string input;
+	std::string output;
+};
+
+struct Batch{
+	uint64_t index;
+	std::vector<planar::Loop> loops;
+};
+
+// Counts batches handed out by the reader but not yet written. The
+// reorder buffer in the writer is only bounded if this is.
+class InFlight{
+  public:
+	InFlight(size_t limit) : limit_(limit) {}
+
+	void Acquire() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		released_.wait(lock, [this]() { return count_ < limit_; });
+		++count_;
+	}
+
+	void Release() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		--count_;
+		released_.notify_one();
+	}
+
+  private:
+	size_t limit_;
+	size_t count_ = 0;
+	std::mutex mutex_;
+	std::condition_variable released_;
+};
+
+void Usage() {
+	std::cerr <<
+		"usage: planar-offset --amt D [options] [input [output]]\n"
+		"  --amt D         offset distance, positive grows CCW loops\n"
+		"  --trim          trim self-intersections (may split loops)\n"
+		"  --threads N     offset worker threads (default: all cores)\n"
+		"  --capacity N    max loops in flight between stages (default 4096)\n"
+		"  --batch N       loops per queue item (default 64)\n"
+		"  --cache MB      reuse results for repeated loops, up to MB of memory\n"
+		"  --quiet         don't report stats\n"
+		"Reads stdin and writes stdout when no files are given.\n";
+}
+
+bool ParseOptions(int argc, char *argv[], Options &options) {
+	auto has_amt = false;
+	auto files = std::vector<std::string>{};
+	for(int i=1; i < argc; ++i) {
+		auto arg = std::string(argv[i]);
+		auto needs_value = arg == "--amt" || arg == "--threads" || arg == "--capacity" || arg == "--batch" || arg == "--cache";
+		if(needs_value && i + 1 >= argc) {
+			return false;
+		}
+		if(arg == "--amt") {
+			options.amt = std::strtof(argv[++i], nullptr);
+			has_amt = true;
+		}
+		else if(arg == "--threads") {
+			options.threads = unsigned(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if(arg == "--capacity") {
+			options.capacity = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if(arg == "--batch") {
+			options.batch_size = std::max<size_t>(std::strtoul(argv[++i], nullptr, 10), 1);
+		}
+		else if(arg == "--cache") {
+			options.cache_mb = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if(arg == "--trim") {
+			options.trim = true;
+		}
+		else if(arg == "--quiet") {
+			options.quiet = true;
+		}
+		else if(arg.size() > 1 && arg[0] == '-') {
+			return false;
+		}
+		else {
+			files.push_back(arg);
+		}
+	}
+	if(!has_amt || files.size() > 2) {
+		return false;
+	}
+	if(files.size() > 0) {
+		options.input = files[0];
+	}
+	if(files.size() > 1) {
+		options.output = files[1];
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	auto options = Options{};
+	if(!ParseOptions(argc, argv, options)) {
+		Usage();
+		return 1;
+	}
+
+	auto input_file = std::ifstream{};
+	auto output_file = std::ofstream{};
+	if(!options.input.empty()) {
+		input_file.open(options.input, std::ios::binary);
+		if(!input_file) {
+			std::cerr << "planar-offset: can't open " << options.input << "\n";
+			return 1;
+		}
+	}
+	if(!options.output.empty()) {
+		output_file.open(options.output, std::ios::binary);
+		if(!output_file) {
+			std::cerr << "planar-offset: can't open " << options.output << "\n";
+			return 1;
+		}
+	}
+	std::istream &input = options.input.empty() ? std::cin : input_file;
+	std::ostream &output = options.output.empty() ? std::cout : output_file;
+	std::ios::sync_with_stdio(false);
+
+	auto workers = planar::ThreadCount(options.threads);
+	auto max_batches = std::max<size_t>(options.capacity / options.batch_size, 2);
+	planar::BoundedQueue<Batch> parsed(max_batches);
+	planar::BoundedQueue<Batch> offset(max_batches);
+	InFlight in_flight(max_batches);
+	auto loops_in = uint64_t(0);
+	auto loops_out = uint64_t(0);
+	auto bad_lines = uint64_t(0);
+	planar::LoopCache cache(options.cache_mb << 20);
+	auto start_time = std::chrono::steady_clock::now();
+
+	auto reader = std::thread([&]() {
+		auto batch = Batch{0, {}};
+		auto line = std::string{};
+		auto loop = planar::Loop(std::vector<planar::Curve>{});
+		auto flush = [&]() {
+			in_flight.Acquire();
+			parsed.Push(std::move(batch));
+			batch = Batch{batch.index + 1, {}};
+		};
+		while(std::getline(input, line)) {
+			if(planar::ParseLoop(line, loop)) {
+				batch.loops.push_back(loop);
+				++loops_in;
+				if(batch.loops.size() >= options.batch_size) {
+					flush();
+				}
+			}
+			else if(!line.empty() && line[0] != '#') {
+				++bad_lines;
+			}
+		}
+		if(!batch.loops.empty()) {
+			flush();
+		}
+		parsed.Close();
+	});
+
+	auto offsetters = std::vector<std::thread>{};
+	for(unsigned i=0; i < workers; ++i) {
+		offsetters.emplace_back([&]() {
+			auto batch = Batch{0, {}};
+			while(parsed.Pop(batch)) {
+				auto result = Batch{batch.index, {}};
+				result.loops.reserve(batch.loops.size());
+				for(auto &loop : batch.loops) {
+					if(options.trim) {
+						auto compute = [&]() {
+							return planar::OffsetEngine(loop).Offset(options.amt);
+						};
+						if(options.cache_mb > 0) {
+							auto key = planar::CacheKey{planar::ContentHash(loop), options.amt, planar::kCacheUserOp};
+							auto trimmed = cache.FindOrCompute(key, compute);
+							result.loops.insert(result.loops.end(), trimmed->begin(), trimmed->end());
+						}
+						else {
+							auto trimmed = compute();
+							result.loops.insert(result.loops.end(), trimmed.begin(), trimmed.end());
+						}
+					}
+					else if(options.cache_mb > 0) {
+						result.loops.push_back(planar::Offset(cache, loop, options.amt));
+					}
+					else {
+						result.loops.push_back(loop.Offset(options.amt));
+					}
+				}
+				offset.Push(std::move(result));
+			}
+		});
+	}
+
+	// Batches finish out of order; hold them until their turn
+	auto writer = std::thread([&]() {
+		auto pending = std::map<uint64_t, Batch>{};
+		auto next = uint64_t(0);
+		auto batch = Batch{0, {}};
+		auto text = std::string{};
+		while(offset.Pop(batch)) {
+			pending.emplace(batch.index, std::move(batch));
+			for(auto it=pending.find(next); it != pending.end(); it=pending.find(next)) {
+				text.clear();
+				for(const auto &loop : it->second.loops) {
+					planar::WriteLoop(loop, text);
+				}
+				output.write(text.data(), std::streamsize(text.size()));
+				loops_out += it->second.loops.size();
+				pending.erase(it);
+				in_flight.Release();
+				++next;
+			}
+		}
+		output.flush();
+	});
+
+	reader.join();
+	for(auto &thread : offsetters) {
+		thread.join();
+	}
+	offset.Close();
+	writer.join();
+
+	if(!options.quiet) {
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+		std::cerr <<
+			"planar-offset: " << loops_in << " loops in, " << loops_out << " loops out, " <<
+			bad_lines << " bad lines\n" <<
+			"  " << seconds << " s, " << (seconds > 0.0 ? double(loops_in) / seconds : 0.0) << " loops/s, " <<
+			workers << " offset threads\n" <<
+			"  parse -> offset queue: max depth " << parsed.max_depth() << "/" << parsed.capacity() <<
+			", mean " << parsed.mean_depth() << " batches of " << options.batch_size << "\n" <<
+			"  offset -> write queue: max depth " << offset.max_depth() << "/" << offset.capacity() <<
+			", mean " << offset.mean_depth() << "\n";
+		if(options.cache_mb > 0) {
+			std::cerr <<
+				"  cache: " << cache.hits() << " hits, " << cache.misses() << " misses, " <<
+				cache.evictions() << " evictions, " << (cache.bytes() >> 10) << " KB\n";
+		}
+	}
+	return 0;
+}
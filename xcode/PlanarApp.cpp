@@ -6,6 +6,7 @@
 #include "vsr/space/vsr_cga2D.h"
 #include "primitives.hpp"
 #include "loop.hpp"
+#include "flatten.hpp"
 #include <cmath>
 
 using namespace ci;
@@ -45,87 +46,15 @@ gl::GlslProgRef LoadShader(const std::string& name, bool has_geometry_shader=tru
 	return shader;
 }
 
-gl::BatchRef ToBatch(const planar::LineSegment &segment, glm::vec4 color = glm::vec4(0.f, 0.f, 0.f, 1.f)) {
-	auto position = std::vector<glm::vec3>{
-		glm::vec3(segment.pts[0][0], segment.pts[0][1], 0.f),
-		glm::vec3(segment.pts[1][0], segment.pts[1][1], 0.f)
-	};
-	auto mesh = gl::VboMesh::create(position.size(), GL_LINES, {gl::VboMesh::Layout().attrib(geom::POSITION, 3)});
-	mesh->bufferAttrib(geom::POSITION, position);
-	
-	auto shader = LoadShader("pass", false);
-	shader->uniform("color", color);
-	return gl::Batch::create(mesh, shader);
-}
-
-
-gl::BatchRef ToBatch(const planar::Circle &circle, glm::vec4 color = glm::vec4(0.f, 0.f, 0.f, 1.f)) {
+gl::BatchRef ToBatch(const planar::VertexBuffer &buffer, size_t loop, gl::GlslProgRef shader) {
 	auto position = std::vector<glm::vec3>{};
-	auto size = 40;
-	position.reserve(size);
-	
-	auto dtheta = 2.f * M_PI / float(size + 1);
-	for(int i=0; i < size; ++i) {
-		auto x = circle.radius * std::cos(dtheta * float(i)) + circle.center[0];
-		auto y = circle.radius * std::sin(dtheta * float(i)) + circle.center[1];
-		position.push_back(glm::vec3(x, y, 0.f));
+	position.reserve(buffer.offsets[loop + 1] - buffer.offsets[loop]);
+	for(auto i=buffer.offsets[loop]; i < buffer.offsets[loop + 1]; ++i) {
+		position.push_back(glm::vec3(buffer.xy[2 * i], buffer.xy[2 * i + 1], 0.f));
 	}
 	
 	auto mesh = gl::VboMesh::create(position.size(), GL_LINE_LOOP, {gl::VboMesh::Layout().attrib(geom::POSITION, 3)});
 	mesh->bufferAttrib(geom::POSITION, position);
-	
-	auto shader = LoadShader("pass", false);
-	shader->uniform("color", color);
-	return gl::Batch::create(mesh, shader);
-}
-
-gl::BatchRef ToBatch(const planar::Arc &arc, glm::vec4 color = glm::vec4(0.f, 0.f, 0.f, 1.f)) {
-	auto radius = std::abs(arc.circle.radius);
-	auto dir0 = (arc.endpoints.pts[0] - arc.circle.center) / radius;
-	auto dir1 = (arc.endpoints.pts[1] - arc.circle.center) / radius;
-	auto ip = (dir0 <= dir1)[0];
-	auto op = (dir0 ^ dir1)[0];
-//	std::cout << "ip: " << ip << "\n";
-//	std::cout << "op: " << op << "\n";
-	
-	// TODO: reorganize this to not calc asin if not needed
-	auto theta_range = std::asin(op);
-	//std::cout << "theta_range: " << theta_range << " " << (theta_range * 180.f / M_PI) << "\n";
-	if(ip < 0.f) {
-		theta_range = M_PI - theta_range;
-	}
-	else if(op < 0.f) {
-		theta_range += 2.f * M_PI;
-	}
-	
-	if(arc.circle.radius < 0.f) {
-		theta_range = theta_range - 2.f * M_PI;
-	}
-	
-	
-	//std::cout << "theta_range: " << theta_range << "\n";
-	
-	auto theta_start = std::atan2(dir0[1], dir0[0]);
-	auto n = int(std::abs(theta_range) / (M_PI / 40.f)) + 1;
-	auto dtheta = theta_range / float(n);
-	
-	
-	auto position = std::vector<glm::vec3>{};
-	position.reserve(n);
-	position.push_back(glm::vec3(arc.endpoints.pts[0][0], arc.endpoints.pts[0][1], 0.f));
-	for(int i=1; i < n; ++i) {
-		auto x = radius * std::cos(theta_start + dtheta * float(i)) + arc.circle.center[0];
-		auto y = radius * std::sin(theta_start + dtheta * float(i)) + arc.circle.center[1];
-		position.push_back(glm::vec3(x, y, 0.f));
-	}
-	position.push_back(glm::vec3(arc.endpoints.pts[1][0], arc.endpoints.pts[1][1], 0.f));
-	
-	
-	auto mesh = gl::VboMesh::create(position.size(), GL_LINE_STRIP, {gl::VboMesh::Layout().attrib(geom::POSITION, 3)});
-	mesh->bufferAttrib(geom::POSITION, position);
-	
-	auto shader = LoadShader("pass", false);
-	shader->uniform("color", color);
 	return gl::Batch::create(mesh, shader);
 }
 
@@ -137,13 +66,14 @@ void PlanarApp::setup()
 	camUi = CameraUi(&camera);
 	ci::app::getWindow()->setTitle("Planar");
 
+	auto buffer = VertexBuffer{};
 	auto ToBatches = [&](const Loop &loop, glm::vec4 color) {
-		for(const auto &curve : loop.curves()) {
-			switch(TargetType(curve)) {
-				case Curve::CurveType::LineSegment: batches.push_back(ToBatch(*(LineSegment*)Target(curve), color)); break;
-				case Curve::CurveType::Circle: batches.push_back(ToBatch(*(Circle*)Target(curve), color)); break;
-				case Curve::CurveType::Arc: batches.push_back(ToBatch(*(Arc*)Target(curve), color)); break;
-			}
+		auto shader = LoadShader("pass", false);
+		shader->uniform("color", color);
+		buffer.clear();
+		Flatten(loop, 1e-3f, buffer);
+		for(size_t i=0; i < buffer.loop_count(); ++i) {
+			batches.push_back(ToBatch(buffer, i, shader));
 		}
 	};
 